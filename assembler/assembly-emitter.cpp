@@ -17,8 +17,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <tuple>
 
 #include "bytecode_instruction-inl.h"
 #include "file_items.h"
@@ -1352,6 +1355,77 @@ void AsmEmitter::FillMap(PandaFileToPandaAsmMaps *maps, const AsmEmitter::AsmEnt
     }
 }
 
+/* static */
+bool AsmEmitter::ReadHotnessProfile(const std::string &filename, HotnessProfile *profile)
+{
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        SetLastError("Unable to open hotness profile " + filename);
+        return false;
+    }
+    // Counters are printed as "<class descriptor>.<method name>:<counter>", other lines are headers
+    std::string line;
+    while (std::getline(file, line)) {
+        auto begin = line.find_first_not_of(' ');
+        auto colon = line.rfind(':');
+        if (begin == std::string::npos || colon == std::string::npos || line.find(";.", begin) > colon) {
+            continue;
+        }
+        auto value = static_cast<uint32_t>(std::strtoul(line.c_str() + colon + 1, nullptr, 0));
+        auto &hotness = (*profile)[line.substr(begin, colon - begin)];
+        hotness = std::max(hotness, value);
+    }
+    return true;
+}
+
+static std::string GetItemString(panda_file::StringItem *item)
+{
+    // Data of the string item is null-terminated
+    const auto &data = item->GetData();
+    return data.substr(0, data.size() - 1);
+}
+
+/* static */
+void AsmEmitter::ReorderItemsByHotness(ItemContainer *items, const Program &program,
+                                       const AsmEmitter::AsmEntityCollections &entities, const HotnessProfile &profile)
+{
+    std::vector<std::tuple<uint32_t, std::string_view, const Function *, MethodItem *>> hot_methods;
+    for (const auto &[name, func] : program.function_table) {
+        if (func.metadata->IsForeign()) {
+            continue;
+        }
+        auto *method = static_cast<MethodItem *>(Find(entities.method_items, name));
+        auto it = profile.find(GetItemString(method->GetClassItem()->GetNameItem()) + "." +
+                               GetItemString(method->GetNameItem()));
+        if (it != profile.end() && it->second != 0) {
+            hot_methods.emplace_back(it->second, name, &func, method);
+        }
+    }
+    // Hotter methods go first, the name makes the layout deterministic
+    std::sort(hot_methods.begin(), hot_methods.end(), [](const auto &lhs, const auto &rhs) {
+        return std::get<0>(lhs) != std::get<0>(rhs) ? std::get<0>(lhs) > std::get<0>(rhs)
+                                                    : std::get<1>(lhs) < std::get<1>(rhs);
+    });
+
+    std::vector<panda_file::BaseItem *> hot_items;
+    for (const auto &hot_method : hot_methods) {
+        const Function *func = std::get<2>(hot_method);
+        MethodItem *method = std::get<3>(hot_method);
+        // Methods are laid out inside of their class item
+        hot_items.push_back(method->GetClassItem());
+        hot_items.push_back(method->GetNameItem());
+        if (method->GetCode() != nullptr) {
+            hot_items.push_back(method->GetCode());
+        }
+        for (const auto &insn : func->ins) {
+            if (insn.opcode != Opcode::INVALID && insn.HasFlag(InstFlags::STRING_ID)) {
+                hot_items.push_back(Find(entities.string_items, std::string_view(insn.ids[0])));
+            }
+        }
+    }
+    items->ReorderItems(hot_items);
+}
+
 /* static */
 void AsmEmitter::EmitDebugInfo(ItemContainer *items, const Program &program, const std::vector<uint8_t> *bytes,
                                const MethodItem *method, const Function &func, const std::string &name,
@@ -1430,7 +1504,8 @@ bool AsmEmitter::EmitFunctions(ItemContainer *items, const Program &program,
 }
 
 /* static */
-bool AsmEmitter::Emit(ItemContainer *items, const Program &program, PandaFileToPandaAsmMaps *maps, bool emit_debug_info)
+bool AsmEmitter::Emit(ItemContainer *items, const Program &program, PandaFileToPandaAsmMaps *maps, bool emit_debug_info,
+                      const HotnessProfile *profile)
 {
     auto primitive_types = CreatePrimitiveTypes(items);
 
@@ -1462,6 +1537,10 @@ bool AsmEmitter::Emit(ItemContainer *items, const Program &program, PandaFileToP
         return false;
     }
 
+    if (profile != nullptr) {
+        ReorderItemsByHotness(items, program, entities, *profile);
+    }
+
     items->ComputeLayout();
 
     if (maps != nullptr) {
@@ -1476,10 +1555,10 @@ bool AsmEmitter::Emit(ItemContainer *items, const Program &program, PandaFileToP
 }
 
 bool AsmEmitter::Emit(Writer *writer, const Program &program, std::map<std::string, size_t> *stat,
-                      PandaFileToPandaAsmMaps *maps, bool debug_info)
+                      PandaFileToPandaAsmMaps *maps, bool debug_info, const HotnessProfile *profile)
 {
     auto items = ItemContainer {};
-    if (!Emit(&items, program, maps, debug_info)) {
+    if (!Emit(&items, program, maps, debug_info, profile)) {
         return false;
     }
 
@@ -1491,20 +1570,21 @@ bool AsmEmitter::Emit(Writer *writer, const Program &program, std::map<std::stri
 }
 
 bool AsmEmitter::Emit(const std::string &filename, const Program &program, std::map<std::string, size_t> *stat,
-                      PandaFileToPandaAsmMaps *maps, bool debug_info)
+                      PandaFileToPandaAsmMaps *maps, bool debug_info, const HotnessProfile *profile)
 {
     auto writer = FileWriter(filename);
     if (!writer) {
         SetLastError("Unable to open" + filename + " for writing");
         return false;
     }
-    return Emit(&writer, program, stat, maps, debug_info);
+    return Emit(&writer, program, stat, maps, debug_info, profile);
 }
 
-std::unique_ptr<const panda_file::File> AsmEmitter::Emit(const Program &program, PandaFileToPandaAsmMaps *maps)
+std::unique_ptr<const panda_file::File> AsmEmitter::Emit(const Program &program, PandaFileToPandaAsmMaps *maps,
+                                                         const HotnessProfile *profile)
 {
     auto items = ItemContainer {};
-    if (!Emit(&items, program, maps)) {
+    if (!Emit(&items, program, maps, true, profile)) {
         return nullptr;
     }
 
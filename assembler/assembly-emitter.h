@@ -49,17 +49,32 @@ public:
         std::unordered_map<std::string, panda_file::LiteralArrayItem *> literalarray_items;
     };
 
+    // Hotness counters of methods from a dprof profile, methods are named "<class descriptor>.<method name>"
+    using HotnessProfile = std::unordered_map<std::string, uint32_t>;
+
+    /**
+     * \brief Read hotness counters printed by the dprof converter in the text format
+     * @return false if the file cannot be read
+     */
+    static bool ReadHotnessProfile(const std::string &filename, HotnessProfile *profile);
+
+    /**
+     * Items of the methods from the hotness profile (their classes, code and strings) are placed first in the file,
+     * hotter methods go first. So the methods executed at runtime touch fewer pages of the file.
+     */
     static bool Emit(panda_file::ItemContainer *items, const Program &program, PandaFileToPandaAsmMaps *maps = nullptr,
-                     bool emit_debug_info = true);
+                     bool emit_debug_info = true, const HotnessProfile *profile = nullptr);
 
     static bool Emit(panda_file::Writer *writer, const Program &program, std::map<std::string, size_t> *stat = nullptr,
-                     PandaFileToPandaAsmMaps *maps = nullptr, bool debug_info = true);
+                     PandaFileToPandaAsmMaps *maps = nullptr, bool debug_info = true,
+                     const HotnessProfile *profile = nullptr);
 
     static bool Emit(const std::string &filename, const Program &program, std::map<std::string, size_t> *stat = nullptr,
-                     PandaFileToPandaAsmMaps *maps = nullptr, bool debug_info = true);
+                     PandaFileToPandaAsmMaps *maps = nullptr, bool debug_info = true,
+                     const HotnessProfile *profile = nullptr);
 
-    static std::unique_ptr<const panda_file::File> Emit(const Program &program,
-                                                        PandaFileToPandaAsmMaps *maps = nullptr);
+    static std::unique_ptr<const panda_file::File> Emit(const Program &program, PandaFileToPandaAsmMaps *maps = nullptr,
+                                                        const HotnessProfile *profile = nullptr);
 
     static std::string GetLastError()
     {
@@ -128,6 +143,8 @@ private:
     static bool MakeFunctionDebugInfoAndAnnotations(panda_file::ItemContainer *items, const Program &program,
                                                     const AsmEntityCollections &entities, bool emit_debug_info);
     static void FillMap(PandaFileToPandaAsmMaps *maps, const AsmEntityCollections &entities);
+    static void ReorderItemsByHotness(panda_file::ItemContainer *items, const Program &program,
+                                      const AsmEntityCollections &entities, const HotnessProfile &profile);
     static void EmitDebugInfo(panda_file::ItemContainer *items, const Program &program,
                               const std::vector<uint8_t> *bytes, const panda_file::MethodItem *method,
                               const Function &func, const std::string &name, bool emit_debug_info);
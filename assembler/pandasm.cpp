@@ -17,17 +17,22 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "assembly-emitter.h"
 #include "assembly-parser.h"
+#include "class_data_accessor-inl.h"
+#include "code_data_accessor-inl.h"
 #include "error.h"
 #include "lexer.h"
+#include "method_data_accessor-inl.h"
 #include "utils/expected.h"
 #include "utils/logger.h"
 #include "utils/pandargs.h"
+#include "utils/utf.h"
 
 namespace panda::pandasm {
 
@@ -133,17 +138,92 @@ bool DumpProgramInJson(panda::pandasm::Program &program, const panda::PandArg<st
     return true;
 }
 
+// Counts pages and cache lines of the file touched by the hot methods: their class data, names and code
+std::pair<size_t, size_t> GetHotMethodsLocality(const panda_file::File &pf,
+                                                const panda::pandasm::AsmEmitter::HotnessProfile &profile)
+{
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    std::set<size_t> pages;
+    std::set<size_t> cache_lines;
+    auto touch = [&pages, &cache_lines](size_t offset, size_t size) {
+        for (size_t page = offset / PAGE_SIZE; page <= (offset + size - 1) / PAGE_SIZE; page++) {
+            pages.insert(page);
+        }
+        for (size_t line = offset / CACHE_LINE_SIZE; line <= (offset + size - 1) / CACHE_LINE_SIZE; line++) {
+            cache_lines.insert(line);
+        }
+    };
+
+    for (const auto &[name, hotness] : profile) {
+        auto pos = name.find(";.");
+        if (pos == std::string::npos || hotness == 0) {
+            continue;
+        }
+        auto class_id = pf.GetClassId(utf::CStringAsMutf8(name.substr(0, pos + 1).c_str()));
+        if (!class_id.IsValid() || pf.IsExternal(class_id)) {
+            continue;
+        }
+        panda_file::ClassDataAccessor cda(pf, class_id);
+        touch(class_id.GetOffset(), cda.GetSize());
+        std::string method_name = name.substr(pos + 2);
+        cda.EnumerateMethods([&pf, &method_name, &touch](panda_file::MethodDataAccessor &mda) {
+            auto name_data = pf.GetStringData(mda.GetNameId());
+            if (method_name != utf::Mutf8AsCString(name_data.data)) {
+                return;
+            }
+            size_t name_end = pf.GetIdFromPointer(name_data.data).GetOffset() + method_name.size() + 1;
+            touch(mda.GetNameId().GetOffset(), name_end - mda.GetNameId().GetOffset());
+            auto code_id = mda.GetCodeId();
+            if (code_id) {
+                panda_file::CodeDataAccessor code_accessor(pf, code_id.value());
+                touch(code_id->GetOffset(), code_accessor.GetSize());
+            }
+        });
+    }
+    return {pages.size(), cache_lines.size()};
+}
+
+bool PrintLayoutStat(panda::pandasm::Program &program, const panda::pandasm::AsmEmitter::HotnessProfile &profile)
+{
+    auto default_pf = panda::pandasm::AsmEmitter::Emit(program);
+    auto hot_first_pf = panda::pandasm::AsmEmitter::Emit(program, nullptr, &profile);
+    if (default_pf == nullptr || hot_first_pf == nullptr) {
+        std::cerr << "Failed to emit binary data: " << panda::pandasm::AsmEmitter::GetLastError() << std::endl;
+        return false;
+    }
+
+    auto [default_pages, default_lines] = GetHotMethodsLocality(*default_pf, profile);
+    auto [hot_first_pages, hot_first_lines] = GetHotMethodsLocality(*hot_first_pf, profile);
+    std::cout << "Panda file layout statistic for " << profile.size() << " hot methods:" << std::endl;
+    std::cout << "default layout: " << default_pages << " pages, " << default_lines << " cache lines" << std::endl;
+    std::cout << "profile-guided layout: " << hot_first_pages << " pages, " << hot_first_lines << " cache lines"
+              << std::endl;
+    return true;
+}
+
 bool EmitProgramInBinary(panda::pandasm::Program &program, panda::PandArgParser &pa_parser,
                          const panda::PandArg<std::string> &output_file, panda::PandArg<bool> &optimize,
-                         const panda::PandArg<bool> &size_stat)
+                         const panda::PandArg<bool> &size_stat, const panda::PandArg<std::string> &layout_profile,
+                         const panda::PandArg<bool> &layout_stat)
 {
     auto emit_debug_info = !optimize.GetValue();
     std::map<std::string, size_t> stat;
     std::map<std::string, size_t> *statp = size_stat.GetValue() ? &stat : nullptr;
     panda::pandasm::AsmEmitter::PandaFileToPandaAsmMaps maps {};
     panda::pandasm::AsmEmitter::PandaFileToPandaAsmMaps *mapsp = optimize.GetValue() ? &maps : nullptr;
+    panda::pandasm::AsmEmitter::HotnessProfile profile;
+    panda::pandasm::AsmEmitter::HotnessProfile *profilep = nullptr;
+    if (!layout_profile.GetValue().empty()) {
+        if (!panda::pandasm::AsmEmitter::ReadHotnessProfile(layout_profile.GetValue(), &profile)) {
+            std::cerr << panda::pandasm::AsmEmitter::GetLastError() << std::endl;
+            return false;
+        }
+        profilep = &profile;
+    }
 
-    if (!panda::pandasm::AsmEmitter::Emit(output_file.GetValue(), program, statp, mapsp, emit_debug_info)) {
+    if (!panda::pandasm::AsmEmitter::Emit(output_file.GetValue(), program, statp, mapsp, emit_debug_info,
+                                          profilep)) {
         std::cerr << "Failed to emit binary data: " << panda::pandasm::AsmEmitter::GetLastError() << std::endl;
         return false;
     }
@@ -160,6 +240,10 @@ bool EmitProgramInBinary(panda::pandasm::Program &program, panda::PandArgParser
         std::cout << "total: " << total_size << std::endl;
     }
 
+    if (layout_stat.GetValue() && !PrintLayoutStat(program, profile)) {
+        return false;
+    }
+
     pa_parser.DisableTail();
 
     return true;
@@ -167,13 +251,14 @@ bool EmitProgramInBinary(panda::pandasm::Program &program, panda::PandArgParser
 
 bool BuildFiles(panda::pandasm::Program &program, panda::PandArgParser &pa_parser,
                 const panda::PandArg<std::string> &output_file, panda::PandArg<bool> &optimize,
-                panda::PandArg<bool> &size_stat, panda::PandArg<std::string> &scopes_file)
+                panda::PandArg<bool> &size_stat, panda::PandArg<std::string> &scopes_file,
+                const panda::PandArg<std::string> &layout_profile, const panda::PandArg<bool> &layout_stat)
 {
     if (!DumpProgramInJson(program, scopes_file)) {
         return false;
     }
 
-    if (!EmitProgramInBinary(program, pa_parser, output_file, optimize, size_stat)) {
+    if (!EmitProgramInBinary(program, pa_parser, output_file, optimize, size_stat, layout_profile, layout_stat)) {
         return false;
     }
 
@@ -191,6 +276,11 @@ int main(int argc, char *argv[])
     panda::PandArg<bool> help("help", false, "Print this message and exit");
     panda::PandArg<bool> size_stat("size-stat", false, "Print panda file size statistic");
     panda::PandArg<bool> optimize("optimize", false, "Run the bytecode optimization");
+    panda::PandArg<std::string> layout_profile(
+        "layout-profile", "",
+        "(--layout-profile FILENAME) Place hot methods first using hotness counters printed by dprof converter");
+    panda::PandArg<bool> layout_stat("layout-stat", false,
+                                     "Print pages touched by hot methods with default and profile-guided layout");
     // tail arguments
     panda::PandArg<std::string> input_file("INPUT_FILE", "", "Path to the source assembly code");
     panda::PandArg<std::string> output_file("OUTPUT_FILE", "", "Path to the generated binary code");
@@ -201,6 +291,8 @@ int main(int argc, char *argv[])
     pa_parser.Add(&scopes_file);
     pa_parser.Add(&size_stat);
     pa_parser.Add(&optimize);
+    pa_parser.Add(&layout_profile);
+    pa_parser.Add(&layout_stat);
     pa_parser.PushBackTail(&input_file);
     pa_parser.PushBackTail(&output_file);
     pa_parser.EnableTail();
@@ -238,7 +330,8 @@ int main(int argc, char *argv[])
         panda::pandasm::PrintErrors(w, "WARNING");
     }
 
-    if (!panda::pandasm::BuildFiles(program, pa_parser, output_file, optimize, size_stat, scopes_file)) {
+    if (!panda::pandasm::BuildFiles(program, pa_parser, output_file, optimize, size_stat, scopes_file, layout_profile,
+                                    layout_stat)) {
         return 1;
     }
 
@@ -868,4 +868,57 @@ TEST(emittertests, get_GLOBAL_lang_for_JS_func)
     ASSERT_EQ(cda.GetSourceLang(), panda_file::SourceLang::ECMASCRIPT);
 }
 
+TEST(emittertests, hotness_profile_layout)
+{
+    Parser p;
+    auto source = R"(
+        .record Cold {}
+        .record Hot {}
+
+        .function void Cold.foo() {
+            lda.str "cold string"
+            return.void
+        }
+
+        .function void Hot.bar() {
+            lda.str "hot string"
+            return.void
+        }
+    )";
+
+    auto res = p.Parse(source);
+    ASSERT_EQ(p.ShowError().err, Error::ErrorType::ERR_NONE);
+
+    AsmEmitter::HotnessProfile profile {{"LHot;.bar", 100}};
+    AsmEmitter::PandaFileToPandaAsmMaps maps;
+    auto pf = AsmEmitter::Emit(res.Value(), &maps, &profile);
+    ASSERT_NE(pf, nullptr);
+
+    std::string descriptor;
+    auto hot_class_id = pf->GetClassId(GetTypeDescriptor("Hot", &descriptor));
+    auto cold_class_id = pf->GetClassId(GetTypeDescriptor("Cold", &descriptor));
+    ASSERT_TRUE(hot_class_id.IsValid());
+    ASSERT_TRUE(cold_class_id.IsValid());
+    EXPECT_LT(hot_class_id.GetOffset(), cold_class_id.GetOffset());
+
+    auto get_code_offset = [&pf](panda_file::File::EntityId class_id) {
+        uint32_t offset = 0;
+        panda_file::ClassDataAccessor cda(*pf, class_id);
+        cda.EnumerateMethods([&offset](panda_file::MethodDataAccessor &mda) { offset = mda.GetCodeId()->GetOffset(); });
+        return offset;
+    };
+    EXPECT_LT(get_code_offset(hot_class_id), get_code_offset(cold_class_id));
+
+    uint32_t hot_string_offset = 0;
+    uint32_t cold_string_offset = 0;
+    for (const auto &[offset, str] : maps.strings) {
+        if (str == "hot string") {
+            hot_string_offset = offset;
+        } else if (str == "cold string") {
+            cold_string_offset = offset;
+        }
+    }
+    EXPECT_LT(hot_string_offset, cold_string_offset);
+}
+
 }  // namespace panda::test
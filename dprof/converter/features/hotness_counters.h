@@ -23,6 +23,7 @@
 #include "serializer/serializer.h"
 
 #include <list>
+#include <set>
 
 namespace panda::dprof {
 static const char HCOUNTERS_FEATURE_NAME[] = "hotness_counters.v1";
@@ -72,6 +73,8 @@ public:
             ShowText();
         } else if (format == "json") {
             ShowJson();
+        } else if (format == "classes") {
+            ShowClasses();
         } else {
             LOG(ERROR, DPROF) << "Unknown format: " << format << std::endl;
             return false;
@@ -124,6 +127,24 @@ private:
         out_ << "}" << std::endl;
     }
 
+    // Prints descriptors of classes with hot methods, the list can be passed to the runtime option preload-classes
+    void ShowClasses()
+    {
+        std::set<std::string> classes;
+        for (auto &hcounters_info : hcounters_info_list_) {
+            for (auto &method_info : hcounters_info.methods_list) {
+                // Method name is the class descriptor followed by '.' and the method name
+                auto pos = method_info.name.find(";.");
+                if (pos != std::string::npos) {
+                    classes.insert(method_info.name.substr(0, pos + 1));
+                }
+            }
+        }
+        for (auto &class_descriptor : classes) {
+            out_ << class_descriptor << std::endl;
+        }
+    }
+
     std::list<HCountersInfo> hcounters_info_list_;
     std::ostream &out_;
 
@@ -19,7 +19,6 @@
 #include "utils/logger.h"
 #include "utils/type_helpers.h"
 
-#include <numeric>
 namespace panda {
 
 void BaseMemStats::RecordAllocateRaw(size_t size, SpaceType type_mem)
@@ -31,15 +30,14 @@ void BaseMemStats::RecordAllocateRaw(size_t size, SpaceType type_mem)
 void BaseMemStats::RecordAllocate(size_t size, SpaceType type_mem)
 {
     auto index = helpers::ToUnderlying(type_mem);
-    allocated_[index].fetch_add(size, std::memory_order_acq_rel);
+    allocated_.Add(index, size);
 }
 
 void BaseMemStats::RecordMoved(size_t size, SpaceType type_mem)
 {
     auto index = helpers::ToUnderlying(type_mem);
-    uint64_t old_value = allocated_[index].fetch_sub(size, std::memory_order_acq_rel);
-    (void)old_value;
-    ASSERT(old_value >= size);
+    ASSERT(allocated_.Get(index) >= size);
+    allocated_.Sub(index, size);
 }
 
 void BaseMemStats::RecordFreeRaw(size_t size, SpaceType type_mem)
@@ -51,17 +49,17 @@ void BaseMemStats::RecordFreeRaw(size_t size, SpaceType type_mem)
 void BaseMemStats::RecordFree(size_t size, SpaceType type_mem)
 {
     auto index = helpers::ToUnderlying(type_mem);
-    freed_[index].fetch_add(size, std::memory_order_acq_rel);
+    freed_.Add(index, size);
 }
 
 uint64_t BaseMemStats::GetAllocated(SpaceType type_mem) const
 {
-    return allocated_[helpers::ToUnderlying(type_mem)].load(std::memory_order_acquire);
+    return allocated_.Get(helpers::ToUnderlying(type_mem));
 }
 
 uint64_t BaseMemStats::GetFreed(SpaceType type_mem) const
 {
-    return freed_[helpers::ToUnderlying(type_mem)].load(std::memory_order_acquire);
+    return freed_.Get(helpers::ToUnderlying(type_mem));
 }
 
 uint64_t BaseMemStats::GetAllocatedHeap() const
@@ -70,7 +68,7 @@ uint64_t BaseMemStats::GetAllocatedHeap() const
     for (size_t index = 0; index < SPACE_TYPE_SIZE; index++) {
         SpaceType type = ToSpaceType(index);
         if (IsHeapSpace(type)) {
-            result += allocated_[index].load(std::memory_order_acquire);
+            result += allocated_.Get(index);
         }
     }
     return result;
@@ -82,7 +80,7 @@ uint64_t BaseMemStats::GetFreedHeap() const
     for (size_t index = 0; index < SPACE_TYPE_SIZE; index++) {
         SpaceType type = ToSpaceType(index);
         if (IsHeapSpace(type)) {
-            result += freed_[index].load(std::memory_order_acquire);
+            result += freed_.Get(index);
         }
     }
     return result;
@@ -96,16 +94,22 @@ uint64_t BaseMemStats::GetFootprintHeap() const
 uint64_t BaseMemStats::GetFootprint(SpaceType type_mem) const
 {
     auto index = helpers::ToUnderlying(type_mem);
-    LOG_IF(allocated_[index].load(std::memory_order_acquire) < freed_[index].load(std::memory_order_acquire), FATAL, GC)
-        << "Allocated < Freed (mem type = " << std::dec << static_cast<size_t>(index)
-        << "): " << allocated_[index].load(std::memory_order_acquire) << " < "
-        << freed_[index].load(std::memory_order_acquire);
-    return allocated_[index].load(std::memory_order_acquire) - freed_[index].load(std::memory_order_acquire);
+    uint64_t allocated = allocated_.Get(index);
+    uint64_t freed = freed_.Get(index);
+    LOG_IF(allocated < freed, FATAL, GC) << "Allocated < Freed (mem type = " << std::dec << static_cast<size_t>(index)
+                                         << "): " << allocated << " < " << freed;
+    return allocated - freed;
 }
 
 uint64_t BaseMemStats::GetTotalFootprint() const
 {
-    return std::accumulate(begin(allocated_), end(allocated_), 0UL) - std::accumulate(begin(freed_), end(freed_), 0UL);
+    uint64_t allocated = 0;
+    uint64_t freed = 0;
+    for (size_t index = 0; index < SPACE_TYPE_SIZE; index++) {
+        allocated += allocated_.Get(index);
+        freed += freed_.Get(index);
+    }
+    return allocated - freed;
 }
 
 }  // namespace panda
@@ -19,6 +19,7 @@
 #include "os/mutex.h"
 #include <cstdio>
 #include "macros.h"
+#include "mem/sharded_counters.h"
 #include "space.h"
 
 #include <array>
@@ -53,8 +54,9 @@ protected:
     void RecordFree(size_t size, SpaceType type_mem);
 
 private:
-    std::array<std::atomic_uint64_t, SPACE_TYPE_SIZE> allocated_ {0};
-    std::array<std::atomic_uint64_t, SPACE_TYPE_SIZE> freed_ {0};
+    // Counters are updated on every allocation, so they are sharded between threads
+    ShardedCounters<SPACE_TYPE_SIZE> allocated_;
+    ShardedCounters<SPACE_TYPE_SIZE> freed_;
 };
 
 }  // namespace panda
@@ -183,6 +183,9 @@ constexpr uint64_t SIZE_1G = 1_GB;
 
 constexpr uint64_t PANDA_MAX_HEAP_SIZE = 4_GB;
 constexpr size_t PANDA_POOL_ALIGNMENT_IN_BYTES = 256_KB;
+// Object space is aligned to this value when it is backed by transparent huge pages
+constexpr size_t PANDA_HUGE_PAGE_ALIGNMENT_IN_BYTES = 2_MB;
+static_assert(PANDA_HUGE_PAGE_ALIGNMENT_IN_BYTES % PANDA_POOL_ALIGNMENT_IN_BYTES == 0);
 
 constexpr size_t PANDA_DEFAULT_POOL_SIZE = 1_MB;
 constexpr size_t PANDA_DEFAULT_ARENA_SIZE = 1_MB;
@@ -231,6 +234,10 @@ using ObjectVisitor = std::function<void(ObjectHeader *)>;
  * from_object is object from which we found to_object by reference.
  */
 using ObjectVisitorEx = std::function<void(ObjectHeader *from_object, ObjectHeader *to_object)>;
+/**
+ * new_address is an address where object will be moved to.
+ */
+using ObjectForwardVisitor = std::function<void(ObjectHeader *object, ObjectHeader *new_address)>;
 using ObjectChecker = std::function<bool(const ObjectHeader *)>;
 using GCRootVisitor = std::function<void(const mem::GCRoot &)>;
 using MemRangeChecker = std::function<bool(mem::MemRange &)>;
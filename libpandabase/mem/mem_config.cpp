@@ -22,5 +22,8 @@ size_t MemConfig::heap_pool_size = 0;
 size_t MemConfig::internal_pool_size = 0;
 size_t MemConfig::code_pool_size = 0;
 size_t MemConfig::compiler_pool_size = 0;
+bool MemConfig::object_pool_use_huge_pages = false;
+size_t MemConfig::max_free_pools_size = 0;
+uint64_t MemConfig::free_pool_idle_time_ms = 0;
 
 }  // namespace panda::mem
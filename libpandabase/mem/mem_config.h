@@ -21,6 +21,7 @@
 #include "utils/asan_interface.h"
 
 #include <cstddef>
+#include <cstdint>
 
 namespace panda::mem {
 
@@ -29,13 +30,17 @@ namespace panda::mem {
  */
 class MemConfig {
 public:
-    static void Initialize(size_t object_pool_size, size_t internal_size, size_t compiler_size, size_t code_size)
+    static void Initialize(size_t object_pool_size, size_t internal_size, size_t compiler_size, size_t code_size,
+                           bool use_huge_pages = false, size_t max_free_size = 0, uint64_t pool_idle_time_ms = 0)
     {
         ASSERT(!is_initialized);
         heap_pool_size = object_pool_size;
         internal_pool_size = internal_size;
         compiler_pool_size = compiler_size;
         code_pool_size = code_size;
+        object_pool_use_huge_pages = use_huge_pages;
+        max_free_pools_size = max_free_size;
+        free_pool_idle_time_ms = pool_idle_time_ms;
         is_initialized = true;
     }
 
@@ -45,6 +50,9 @@ public:
         heap_pool_size = 0;
         internal_pool_size = 0;
         code_pool_size = 0;
+        object_pool_use_huge_pages = false;
+        max_free_pools_size = 0;
+        free_pool_idle_time_ms = 0;
     }
 
     static size_t GetObjectPoolSize()
@@ -71,6 +79,24 @@ public:
         return compiler_pool_size;
     }
 
+    static bool IsObjectPoolUseHugePages()
+    {
+        ASSERT(is_initialized);
+        return object_pool_use_huge_pages;
+    }
+
+    static size_t GetMaxFreePoolsSize()
+    {
+        ASSERT(is_initialized);
+        return max_free_pools_size;
+    }
+
+    static uint64_t GetFreePoolIdleTimeMs()
+    {
+        ASSERT(is_initialized);
+        return free_pool_idle_time_ms;
+    }
+
     MemConfig() = delete;
 
     ~MemConfig() = delete;
@@ -80,10 +106,14 @@ public:
 
 private:
     static bool is_initialized;
-    static size_t heap_pool_size;      // Pool size used for object storage
-    static size_t internal_pool_size;  // Pool size used for internal storage
-    static size_t code_pool_size;      // Pool size used for compiled code storage
-    static size_t compiler_pool_size;  // Pool size used for internal compiler storage
+    static size_t heap_pool_size;            // Pool size used for object storage
+    static size_t internal_pool_size;        // Pool size used for internal storage
+    static size_t code_pool_size;            // Pool size used for compiled code storage
+    static size_t compiler_pool_size;        // Pool size used for internal compiler storage
+    static bool object_pool_use_huge_pages;  // Back object pools by transparent huge pages
+    static size_t max_free_pools_size;       // Size of freed object pools which are kept committed
+    static uint64_t free_pool_idle_time_ms;  // Idle time after which a freed object pool is returned to os,
+                                             // zero means that freed pools are returned to os immediately
 };
 
 }  // namespace panda::mem
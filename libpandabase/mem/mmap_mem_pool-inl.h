@@ -23,6 +23,9 @@
 #include "mem/arena.h"
 #include "mem/mem_config.h"
 #include "utils/asan_interface.h"
+#include "utils/time.h"
+
+#include <algorithm>
 
 namespace panda {
 
@@ -49,14 +52,17 @@ inline Pool MmapPoolMap::PopFreePool(size_t size)
         mmap_pool->SetSize(size);
         // CODECHECK-NOLINTNEXTLINE(CPP_RULE_ID_SMARTPOINTER_INSTEADOF_ORIGINPOINTER)
         auto new_mmap_pool = new MmapPool(new_pool, free_pools_.end());
+        new_mmap_pool->SetFreeTimeMs(mmap_pool->GetFreeTimeMs());
+        new_mmap_pool->SetCommitted(mmap_pool->IsCommitted());
         pool_map_.insert(std::pair<void *, MmapPool *>(new_pool.GetMem(), new_mmap_pool));
         auto new_free_pools_iter = free_pools_.insert(std::pair<size_t, MmapPool *>(new_pool.GetSize(), new_mmap_pool));
         new_mmap_pool->SetFreePoolsIter(new_free_pools_iter);
     }
+    mmap_pool->SetCommitted(false);
     return pool;
 }
 
-inline void MmapPoolMap::PushFreePool(Pool pool)
+inline void MmapPoolMap::PushFreePool(Pool pool, uint64_t free_time_ms, bool committed)
 {
     auto mmap_pool_element = pool_map_.find(pool.GetMem());
     if (UNLIKELY(mmap_pool_element == pool_map_.end())) {
@@ -65,12 +71,17 @@ inline void MmapPoolMap::PushFreePool(Pool pool)
 
     auto mmap_pool = mmap_pool_element->second;
     ASSERT(mmap_pool->IsUsed(free_pools_.end()));
+    mmap_pool->SetFreeTimeMs(free_time_ms);
+    mmap_pool->SetCommitted(committed);
 
     auto prev_pool = mmap_pool_element != pool_map_.begin() ? prev(mmap_pool_element, 1)->second : nullptr;
     if (prev_pool != nullptr && !prev_pool->IsUsed(free_pools_.end())) {
         ASSERT(ToUintPtr(prev_pool->GetMem()) + prev_pool->GetSize() == ToUintPtr(mmap_pool->GetMem()));
         free_pools_.erase(prev_pool->GetFreePoolsIter());
         prev_pool->SetSize(prev_pool->GetSize() + mmap_pool->GetSize());
+        // The merged pool is as idle as its most recently freed part
+        prev_pool->SetFreeTimeMs(std::max(prev_pool->GetFreeTimeMs(), mmap_pool->GetFreeTimeMs()));
+        prev_pool->SetCommitted(prev_pool->IsCommitted() || mmap_pool->IsCommitted());
         delete mmap_pool;
         pool_map_.erase(mmap_pool_element--);
         mmap_pool = prev_pool;
@@ -81,6 +92,8 @@ inline void MmapPoolMap::PushFreePool(Pool pool)
         ASSERT(ToUintPtr(mmap_pool->GetMem()) + mmap_pool->GetSize() == ToUintPtr(next_pool->GetMem()));
         free_pools_.erase(next_pool->GetFreePoolsIter());
         mmap_pool->SetSize(next_pool->GetSize() + mmap_pool->GetSize());
+        mmap_pool->SetFreeTimeMs(std::max(next_pool->GetFreeTimeMs(), mmap_pool->GetFreeTimeMs()));
+        mmap_pool->SetCommitted(next_pool->IsCommitted() || mmap_pool->IsCommitted());
         delete next_pool;
         pool_map_.erase(++mmap_pool_element);
     }
@@ -105,6 +118,36 @@ inline size_t MmapPoolMap::GetAllSize() const
     return bytes;
 }
 
+inline size_t MmapPoolMap::GetCommittedSize() const
+{
+    size_t bytes = 0;
+    for (const auto &pool : free_pools_) {
+        if (pool.second->IsCommitted()) {
+            bytes += pool.first;
+        }
+    }
+    return bytes;
+}
+
+inline size_t MmapPoolMap::ReleaseIdlePools(uint64_t current_time_ms, uint64_t idle_time_ms, size_t keep_size)
+{
+    size_t committed_bytes = GetCommittedSize();
+    size_t released_bytes = 0;
+    // Start from the biggest pools to return memory with the minimal number of system calls
+    for (auto it = free_pools_.rbegin(); it != free_pools_.rend() && committed_bytes > keep_size; ++it) {
+        auto mmap_pool = it->second;
+        if (!mmap_pool->IsCommitted() || (mmap_pool->GetFreeTimeMs() + idle_time_ms > current_time_ms)) {
+            continue;
+        }
+        uintptr_t pool_start = ToUintPtr(mmap_pool->GetMem());
+        os::mem::ReleasePages(pool_start, pool_start + mmap_pool->GetSize());
+        mmap_pool->SetCommitted(false);
+        committed_bytes -= mmap_pool->GetSize();
+        released_bytes += mmap_pool->GetSize();
+    }
+    return released_bytes;
+}
+
 inline MmapMemPool::MmapMemPool() : MemPool("MmapMemPool")
 {
     ASSERT(static_cast<uint64_t>(mem::MemConfig::GetObjectPoolSize()) <= PANDA_MAX_HEAP_SIZE);
@@ -118,8 +161,11 @@ inline MmapMemPool::MmapMemPool() : MemPool("MmapMemPool")
     ASSERT((ToUintPtr(mem) == PANDA_32BITS_HEAP_START_ADDRESS) || (object_space_size == 0));
     ASSERT(ToUintPtr(mem) + object_space_size <= PANDA_32BITS_HEAP_END_OBJECTS_ADDRESS);
 #else
-    // We should get aligned to PANDA_POOL_ALIGNMENT_IN_BYTES size
-    void *mem = panda::os::mem::MapRWAnonymousWithAlignmentRaw(object_space_size, PANDA_POOL_ALIGNMENT_IN_BYTES);
+    // We should get aligned to PANDA_POOL_ALIGNMENT_IN_BYTES size,
+    // huge pages can be used only for the memory aligned to PANDA_HUGE_PAGE_ALIGNMENT_IN_BYTES
+    size_t object_space_alignment = mem::MemConfig::IsObjectPoolUseHugePages() ? PANDA_HUGE_PAGE_ALIGNMENT_IN_BYTES
+                                                                                : PANDA_POOL_ALIGNMENT_IN_BYTES;
+    void *mem = panda::os::mem::MapRWAnonymousWithAlignmentRaw(object_space_size, object_space_alignment);
 #endif
     LOG_IF(((mem == nullptr) && (object_space_size != 0)), FATAL, MEMORYPOOL)
         << "MmapMemPool: couldn't mmap " << object_space_size << " bytes of memory for the system";
@@ -130,6 +176,9 @@ inline MmapMemPool::MmapMemPool() : MemPool("MmapMemPool")
     code_space_max_size_ = mem::MemConfig::GetCodePoolSize();
     compiler_space_max_size_ = mem::MemConfig::GetCompilerPoolSize();
     internal_space_max_size_ = mem::MemConfig::GetInternalPoolSize();
+    use_huge_pages_ = mem::MemConfig::IsObjectPoolUseHugePages();
+    max_free_pools_size_ = mem::MemConfig::GetMaxFreePoolsSize();
+    pool_idle_time_ms_ = mem::MemConfig::GetFreePoolIdleTimeMs();
     LOG_MMAP_MEM_POOL(DEBUG) << "Successfully initialized MMapMemPool. Object memory start from addr "
                              << ToVoidPtr(min_object_memory_addr_) << " Preallocated size is equal to "
                              << object_space_size;
@@ -336,6 +385,9 @@ inline Pool MmapMemPool::AllocPoolUnsafe(size_t size, SpaceType space_type, Allo
         AddToNonObjectPoolsMap(std::make_tuple(pool, AllocatorInfo(allocator_type, allocator_addr), space_type));
     }
     os::mem::TagAnonymousMemory(pool.GetMem(), pool.GetSize(), SpaceTypeToString(space_type));
+    if (use_huge_pages_ && space_type == SpaceType::SPACE_TYPE_OBJECT) {
+        os::mem::AdviseHugePages(pool.GetMem(), pool.GetSize());
+    }
     ASSERT(AlignUp(ToUintPtr(pool.GetMem()), PANDA_POOL_ALIGNMENT_IN_BYTES) == ToUintPtr(pool.GetMem()));
     return pool;
 }
@@ -346,12 +398,18 @@ inline void MmapMemPool::FreePoolUnsafe(void *mem, size_t size)
     ASAN_POISON_MEMORY_REGION(mem, size);
     SpaceType pool_space_type = GetSpaceTypeForAddrImpl(mem);
     bool remove_from_pool_map = false;
+    // Freed object pools are returned to os lazily, if the idle time is set
+    bool release_lazily = pool_idle_time_ms_ != 0;
     switch (pool_space_type) {
         case SpaceType::SPACE_TYPE_HUMONGOUS_OBJECT:
         case SpaceType::SPACE_TYPE_NON_MOVABLE_OBJECT:
         case SpaceType::SPACE_TYPE_OBJECT:
             remove_from_pool_map = true;
-            common_space_pools_.PushFreePool(Pool(size, mem));
+            if (release_lazily) {
+                common_space_pools_.PushFreePool(Pool(size, mem), time::GetCurrentTimeInMillis(), true);
+            } else {
+                common_space_pools_.PushFreePool(Pool(size, mem));
+            }
             break;
         case SpaceType::SPACE_TYPE_COMPILER:
             compiler_space_current_size_ -= size;
@@ -373,7 +431,11 @@ inline void MmapMemPool::FreePoolUnsafe(void *mem, size_t size)
     os::mem::TagAnonymousMemory(mem, size, nullptr);
     if (remove_from_pool_map) {
         pool_map_.RemovePoolFromMap(ToVoidPtr(ToUintPtr(mem) - GetMinObjectAddress()), size);
-        os::mem::ReleasePages(ToUintPtr(mem), ToUintPtr(mem) + size);
+        if (release_lazily) {
+            os::mem::ReleasePagesLazily(ToUintPtr(mem), ToUintPtr(mem) + size);
+        } else {
+            os::mem::ReleasePages(ToUintPtr(mem), ToUintPtr(mem) + size);
+        }
     } else {
         RemoveFromNonObjectPoolsMap(mem);
     }
@@ -475,6 +537,33 @@ inline size_t MmapMemPool::GetObjectSpaceFreeBytes()
     return unused_bytes + freed_bytes;
 }
 
+inline size_t MmapMemPool::ReleaseIdleFreePools()
+{
+    if (pool_idle_time_ms_ == 0) {
+        // Freed pools have been already returned to os
+        return 0;
+    }
+    os::memory::LockHolder lk(lock_);
+    return ReleaseIdleFreePoolsUnsafe(time::GetCurrentTimeInMillis());
+}
+
+inline bool MmapMemPool::HasFreePoolsToRelease()
+{
+    if (pool_idle_time_ms_ == 0) {
+        return false;
+    }
+    os::memory::LockHolder lk(lock_);
+    return common_space_pools_.GetCommittedSize() > max_free_pools_size_;
+}
+
+inline size_t MmapMemPool::ReleaseIdleFreePoolsUnsafe(uint64_t current_time_ms)
+{
+    size_t released_bytes = common_space_pools_.ReleaseIdlePools(current_time_ms, pool_idle_time_ms_,
+                                                                 max_free_pools_size_);
+    LOG_MMAP_MEM_POOL(DEBUG) << "Released " << std::dec << released_bytes << " bytes of idle free pools";
+    return released_bytes;
+}
+
 #undef LOG_MMAP_MEM_POOL
 
 }  // namespace panda
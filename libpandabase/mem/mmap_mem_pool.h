@@ -76,10 +76,34 @@ public:
         free_pools_iter_ = free_pools_iter;
     }
 
+    uint64_t GetFreeTimeMs() const
+    {
+        return free_time_ms_;
+    }
+
+    void SetFreeTimeMs(uint64_t free_time_ms)
+    {
+        free_time_ms_ = free_time_ms;
+    }
+
+    // A free pool is committed if its pages were released lazily and may still be resident.
+    bool IsCommitted() const
+    {
+        return committed_;
+    }
+
+    void SetCommitted(bool committed)
+    {
+        committed_ = committed;
+    }
+
 private:
     Pool pool_;
     // Record the iterator of the pool in the multimap
     FreePoolsIter free_pools_iter_;
+    // The last time when the pool (or a part of it) was freed
+    uint64_t free_time_ms_ {0};
+    bool committed_ {false};
 };
 
 class MmapPoolMap {
@@ -99,8 +123,8 @@ public:
     // Find a free pool with enough size in the map. Split the pool, if the pool size is larger than required size.
     Pool PopFreePool(size_t size);
 
-    // Push the unused pool to the map.
-    void PushFreePool(Pool pool);
+    // Push the unused pool to the map. If the pool pages were released lazily, it should be marked as committed.
+    void PushFreePool(Pool pool, uint64_t free_time_ms = 0, bool committed = false);
 
     // Add a new pool to the map. This pool will be marked as used.
     void AddNewPool(Pool pool);
@@ -108,6 +132,13 @@ public:
     // Get the total size of all free pools.
     size_t GetAllSize() const;
 
+    // Get the total size of free pools which may still be resident.
+    size_t GetCommittedSize() const;
+
+    // Return pages of committed free pools, freed at least idle_time_ms ago, to os
+    // until the committed size becomes not greater than keep_size. Returns the size of released memory.
+    size_t ReleaseIdlePools(uint64_t current_time_ms, uint64_t idle_time_ms, size_t keep_size);
+
 private:
     std::map<void *, MmapPool *> pool_map_;
     std::multimap<size_t, MmapPool *> free_pools_;
@@ -159,6 +190,27 @@ public:
 
     size_t GetObjectSpaceFreeBytes();
 
+    /**
+     * Return pages of the object pools, which were freed long ago and haven't been reused, to os.
+     * Freed pools are kept resident up to max free size, see MemConfig.
+     * @return size of memory returned to os
+     */
+    size_t ReleaseIdleFreePools();
+
+    /**
+     * @return true if more than max free size of freed object pools are still resident,
+     * so some of them should be returned to os by ReleaseIdleFreePools once they become idle
+     */
+    bool HasFreePoolsToRelease();
+
+    /**
+     * @return idle time after which a freed object pool can be returned to os, zero if freed pools are returned at once
+     */
+    uint64_t GetFreePoolIdleTimeMs() const
+    {
+        return pool_idle_time_ms_;
+    }
+
 private:
     template <class ArenaT = Arena>
     ArenaT *AllocArenaImpl(size_t size, SpaceType space_type, AllocatorType allocator_type, void *allocator_addr);
@@ -186,6 +238,8 @@ private:
     void RemoveFromNonObjectPoolsMap(void *pool_addr);
     std::tuple<Pool, AllocatorInfo, SpaceType> FindAddrInNonObjectPoolsMap(void *addr);
 
+    size_t ReleaseIdleFreePoolsUnsafe(uint64_t current_time_ms);
+
     MmapMemPool();
 
     // A super class for raw memory allocation for spaces.
@@ -253,6 +307,10 @@ private:
     size_t compiler_space_max_size_ {0};
     size_t internal_space_max_size_ {0};
 
+    bool use_huge_pages_ {false};     /// < Back SPACE_TYPE_OBJECT pools by transparent huge pages
+    size_t max_free_pools_size_ {0};  /// < Size of freed object pools which are kept committed
+    uint64_t pool_idle_time_ms_ {0};  /// < Idle time before a freed object pool is returned to os, 0 - return eagerly
+
     // Map for non object pools allocated via mmap
     std::map<void *, std::tuple<Pool, AllocatorInfo, SpaceType>> non_object_mmaped_pools_;
     // AllocRawMem is called both from alloc and externally
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_LIBPANDABASE_MEM_SHARDED_COUNTERS_H_
+#define PANDA_LIBPANDABASE_MEM_SHARDED_COUNTERS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "macros.h"
+
+namespace panda {
+
+/**
+ * Set of counters which are frequently updated by many threads and rarely read.
+ * Counters are split into shards, each thread updates only the shard chosen at its first update,
+ * so cache lines with counters don't bounce between cores. A value is aggregated over all shards on read.
+ * Shard values can wrap around (e.g. a thread decrements a counter incremented by another thread),
+ * but the sum of all shards is still correct in the unsigned arithmetic.
+ * @tparam COUNTERS_NUM - number of counters
+ */
+template <size_t COUNTERS_NUM>
+class ShardedCounters {
+public:
+    ShardedCounters() = default;
+    ~ShardedCounters() = default;
+    NO_COPY_SEMANTIC(ShardedCounters);
+    NO_MOVE_SEMANTIC(ShardedCounters);
+
+    void Add(size_t index, uint64_t value)
+    {
+        GetShard().counters[index].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Sub(size_t index, uint64_t value)
+    {
+        GetShard().counters[index].fetch_sub(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t Get(size_t index) const
+    {
+        uint64_t result = 0;
+        for (const auto &shard : shards_) {
+            result += shard.counters[index].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t SHARDS_COUNT = 16;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t COUNTERS_SIZE = COUNTERS_NUM * sizeof(std::atomic_uint64_t);
+    static constexpr size_t PADDING_SIZE = (CACHE_LINE_SIZE - COUNTERS_SIZE % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+
+    // Shards are padded instead of being aligned, because objects with counters can be created
+    // by allocators which don't support over-aligned types
+    struct Shard {
+        std::array<std::atomic_uint64_t, COUNTERS_NUM> counters {};
+        std::array<uint8_t, PADDING_SIZE> padding {};
+    };
+
+    static size_t GetCurrentThreadShardIndex()
+    {
+        static std::atomic_size_t next_shard_index {0};
+        thread_local size_t shard_index = next_shard_index.fetch_add(1, std::memory_order_relaxed) % SHARDS_COUNT;
+        return shard_index;
+    }
+
+    Shard &GetShard()
+    {
+        return shards_[GetCurrentThreadShardIndex()];
+    }
+
+    std::array<Shard, SHARDS_COUNT> shards_ {};
+};
+
+}  // namespace panda
+
+#endif  // PANDA_LIBPANDABASE_MEM_SHARDED_COUNTERS_H_
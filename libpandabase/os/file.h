@@ -52,7 +52,8 @@ private:
     NO_MOVE_SEMANTIC(FileHolder);
 };
 
-enum class Mode : uint32_t { READONLY, WRITEONLY, READWRITE, READWRITECREATE };
+// WRITEONLYEXCLUSIVE creates a new file which only its owner may write, it fails if the file exists
+enum class Mode : uint32_t { READONLY, WRITEONLY, READWRITE, READWRITECREATE, WRITEONLYEXCLUSIVE };
 
 File Open(std::string_view filename, Mode mode);
 
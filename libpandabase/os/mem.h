@@ -35,6 +35,7 @@
 #include <memory>
 #include <optional>
 #include <type_traits>
+#include <vector>
 
 namespace panda::os::mem {
 
@@ -369,6 +370,64 @@ inline void ReleasePages([[maybe_unused]] uintptr_t pages_start, [[maybe_unused]
 #endif
 }
 
+/**
+ * Release pages [pages_start, pages_end] to os lazily.
+ * The os reclaims such pages only under memory pressure, so reusing them soon is cheap.
+ * Falls back to ReleasePages if the system doesn't support lazy freeing.
+ * @param pages_start - address of pages beginning, should be multiple of PAGE_SIZE
+ * @param pages_end - address of pages ending, should be multiple of PAGE_SIZE
+ * @return
+ */
+inline void ReleasePagesLazily([[maybe_unused]] uintptr_t pages_start, [[maybe_unused]] uintptr_t pages_end)
+{
+    ASSERT(pages_start % os::mem::GetPageSize() == 0);
+    ASSERT(pages_end % os::mem::GetPageSize() == 0);
+    ASSERT(pages_end >= pages_start);
+#if defined(PANDA_TARGET_UNIX) && defined(MADV_FREE)
+    if (madvise(ToVoidPtr(pages_start), pages_end - pages_start, MADV_FREE) == 0) {
+        return;
+    }
+#endif
+    ReleasePages(pages_start, pages_end);
+}
+
+/**
+ * Ask os to back memory [mem, mem + size) with transparent huge pages.
+ * It is only a hint, nothing happens if the system doesn't support it.
+ * @param mem - pointer to the memory, should be multiple of PAGE_SIZE
+ * @param size - size of memory, should be multiple of PAGE_SIZE
+ * @return
+ */
+inline void AdviseHugePages([[maybe_unused]] void *mem, [[maybe_unused]] size_t size)
+{
+    ASSERT(ToUintPtr(mem) % os::mem::GetPageSize() == 0);
+    ASSERT(size % os::mem::GetPageSize() == 0);
+#if defined(PANDA_TARGET_UNIX) && defined(MADV_HUGEPAGE)
+    madvise(mem, size, MADV_HUGEPAGE);
+#else
+    // Transparent huge pages are not supported, do nothing
+#endif
+}
+
+enum class AccessPattern { NORMAL, RANDOM, SEQUENTIAL, WILL_NEED };
+
+/**
+ * Advise os how memory [mem, mem + size) is going to be accessed, the range is extended to whole pages.
+ * It is only a hint, nothing happens if the system doesn't support it.
+ * @param mem - pointer to the memory
+ * @param size - size of memory
+ * @param pattern - expected access pattern, WILL_NEED starts reading the pages ahead
+ */
+void AdviseAccess(const void *mem, size_t size, AccessPattern pattern);
+
+/**
+ * Get pages of memory [mem, mem + size) which are resident in memory.
+ * @param mem - pointer to the memory
+ * @param size - size of memory
+ * @return addresses of the resident pages, empty if the system doesn't support it
+ */
+std::vector<uintptr_t> GetResidentPages(const void *mem, size_t size);
+
 /**
  * Tag anonymous memory with a debug name.
  * @param mem - pointer to the memory
@@ -38,6 +38,9 @@ static int GetFlags(Mode mode)
         case Mode::READWRITECREATE:
             return O_RDWR | O_CREAT;  // NOLINT(hicpp-signed-bitwise)
 
+        case Mode::WRITEONLYEXCLUSIVE:
+            return O_WRONLY | O_CREAT | O_EXCL;  // NOLINT(hicpp-signed-bitwise)
+
         default:
             break;
     }
@@ -50,8 +53,10 @@ File Open(std::string_view filename, Mode mode)
 {
     // NOLINTNEXTLINE(hicpp-signed-bitwise)
     const auto PERM = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH;
+    // NOLINTNEXTLINE(hicpp-signed-bitwise)
+    const auto EXCLUSIVE_PERM = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    return File(open(filename.data(), GetFlags(mode), PERM));
+    return File(open(filename.data(), GetFlags(mode), mode == Mode::WRITEONLYEXCLUSIVE ? EXCLUSIVE_PERM : PERM));
 }
 
 }  // namespace panda::os::file
@@ -250,6 +250,45 @@ std::optional<Error> TagAnonymousMemory([[maybe_unused]] const void *mem, [[mayb
     return {};
 }
 
+void AdviseAccess(const void *mem, size_t size, AccessPattern pattern)
+{
+    int advice = MADV_NORMAL;
+    switch (pattern) {
+        case AccessPattern::RANDOM:
+            advice = MADV_RANDOM;
+            break;
+        case AccessPattern::SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case AccessPattern::WILL_NEED:
+            advice = MADV_WILLNEED;
+            break;
+        default:
+            break;
+    }
+    uintptr_t start = RoundDown(ToUintPtr(mem), GetPageSize());
+    uintptr_t end = RoundUp(ToUintPtr(mem) + size, GetPageSize());
+    madvise(ToVoidPtr(start), end - start, advice);
+}
+
+std::vector<uintptr_t> GetResidentPages(const void *mem, size_t size)
+{
+    uintptr_t start = RoundDown(ToUintPtr(mem), GetPageSize());
+    uintptr_t end = RoundUp(ToUintPtr(mem) + size, GetPageSize());
+    std::vector<unsigned char> residency((end - start) / GetPageSize());
+    std::vector<uintptr_t> pages;
+    if (mincore(ToVoidPtr(start), end - start, residency.data()) != 0) {
+        return pages;
+    }
+    for (size_t i = 0; i < residency.size(); i++) {
+        // The least significant bit is set for a resident page
+        if ((residency[i] & 1U) != 0) {
+            pages.push_back(start + i * GetPageSize());
+        }
+    }
+    return pages;
+}
+
 size_t GetNativeBytesFromMallinfo()
 {
     size_t mallinfo_bytes;
@@ -41,6 +41,9 @@ static int GetFlags(Mode mode)
         case Mode::READWRITECREATE:
             return _O_RDWR | _O_CREAT | _O_BINARY;  // NOLINT(hicpp-signed-bitwise)
 
+        case Mode::WRITEONLYEXCLUSIVE:
+            return _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY;  // NOLINT(hicpp-signed-bitwise)
+
         default:
             break;
     }
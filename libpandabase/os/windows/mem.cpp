@@ -287,6 +287,17 @@ std::optional<Error> TagAnonymousMemory([[maybe_unused]] const void *mem, [[mayb
     return {};
 }
 
+void AdviseAccess([[maybe_unused]] const void *mem, [[maybe_unused]] size_t size,
+                  [[maybe_unused]] AccessPattern pattern)
+{
+    // On Windows system we can do nothing
+}
+
+std::vector<uintptr_t> GetResidentPages([[maybe_unused]] const void *mem, [[maybe_unused]] size_t size)
+{
+    return {};
+}
+
 size_t GetNativeBytesFromMallinfo()
 {
     return DEFAULT_NATIVE_BYTES_FROM_MALLINFO;
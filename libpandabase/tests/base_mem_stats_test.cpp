@@ -19,6 +19,9 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 namespace panda {
 
 class BaseMemStatsTest : public testing::Test {
@@ -76,4 +79,28 @@ TEST_F(BaseMemStatsTest, AllocationsOverAllocator)
     ASSERT_EQ(sizeof(buff1), stats.GetFootprint(SpaceType::SPACE_TYPE_CODE));
 }
 
+TEST_F(BaseMemStatsTest, MultithreadedStatistic)
+{
+    static constexpr size_t THREADS_NUM = 8;
+    static constexpr size_t ITERATIONS = 10000;
+    BaseMemStats stats;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < THREADS_NUM; i++) {
+        threads.emplace_back([&stats]() {
+            for (size_t j = 0; j < ITERATIONS; j++) {
+                stats.RecordAllocateRaw(2U, SpaceType::SPACE_TYPE_INTERNAL);
+                stats.RecordFreeRaw(1U, SpaceType::SPACE_TYPE_INTERNAL);
+            }
+        });
+    }
+    // Free memory in the main thread, so some shards go below zero
+    stats.RecordFreeRaw(THREADS_NUM * ITERATIONS, SpaceType::SPACE_TYPE_INTERNAL);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(2U * THREADS_NUM * ITERATIONS, stats.GetAllocated(SpaceType::SPACE_TYPE_INTERNAL));
+    ASSERT_EQ(2U * THREADS_NUM * ITERATIONS, stats.GetFreed(SpaceType::SPACE_TYPE_INTERNAL));
+    ASSERT_EQ(0U, stats.GetFootprint(SpaceType::SPACE_TYPE_INTERNAL));
+}
+
 }  // namespace panda
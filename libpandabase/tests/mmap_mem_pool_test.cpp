@@ -14,6 +14,7 @@
  */
 #include "mem/mem.h"
 #include "mem/mmap_mem_pool-inl.h"
+#include "utils/time.h"
 
 #include "gtest/gtest.h"
 
@@ -44,6 +45,27 @@ protected:
         return instance_;
     }
 
+    MmapMemPool *CreateMMapMemPoolWithLazyRelease(size_t object_pool_size, size_t max_free_size,
+                                                  uint64_t pool_idle_time_ms)
+    {
+        ASSERT(instance_ == nullptr);
+        mem::MemConfig::Initialize(object_pool_size, 0, 0, 0, false, max_free_size, pool_idle_time_ms);
+        instance_ = new MmapMemPool();
+        return instance_;
+    }
+
+    static size_t ReleaseIdleFreePools(MmapMemPool *mem_pool, uint64_t current_time_ms)
+    {
+        os::memory::LockHolder lk(mem_pool->lock_);
+        return mem_pool->ReleaseIdleFreePoolsUnsafe(current_time_ms);
+    }
+
+    static size_t GetCommittedFreePoolsSize(MmapMemPool *mem_pool)
+    {
+        os::memory::LockHolder lk(mem_pool->lock_);
+        return mem_pool->common_space_pools_.GetCommittedSize();
+    }
+
 private:
     void SetupMemConfig(size_t object_pool_size, size_t internal_size, size_t compiler_size, size_t code_size) const
     {
@@ -164,4 +186,33 @@ TEST_F(MMapMemPoolTest, PoolReturnTest)
     ASSERT_TRUE(pool7.GetMem() != nullptr);
 }
 
+TEST_F(MMapMemPoolTest, PoolLazyReleaseTest)
+{
+    static constexpr uint64_t IDLE_TIME_MS = 1000;
+    MmapMemPool *memPool = CreateMMapMemPoolWithLazyRelease(8_MB, 2_MB, IDLE_TIME_MS);
+    auto pool1 = memPool->AllocPool(4_MB, SpaceType::SPACE_TYPE_OBJECT, AllocatorType::HUMONGOUS_ALLOCATOR);
+    ASSERT_TRUE(pool1.GetMem() != nullptr);
+    auto pool2 = memPool->AllocPool(2_MB, SpaceType::SPACE_TYPE_OBJECT, AllocatorType::HUMONGOUS_ALLOCATOR);
+    ASSERT_TRUE(pool2.GetMem() != nullptr);
+    auto pool3 = memPool->AllocPool(2_MB, SpaceType::SPACE_TYPE_OBJECT, AllocatorType::HUMONGOUS_ALLOCATOR);
+    ASSERT_TRUE(pool3.GetMem() != nullptr);
+    uint64_t free_time = time::GetCurrentTimeInMillis();
+    memPool->FreePool(pool1.GetMem(), pool1.GetSize());
+    memPool->FreePool(pool3.GetMem(), pool3.GetSize());
+    ASSERT_EQ(GetCommittedFreePoolsSize(memPool), 6_MB);
+    ASSERT_TRUE(memPool->HasFreePoolsToRelease());
+    // Freed pools are not idle enough yet
+    ASSERT_EQ(ReleaseIdleFreePools(memPool, free_time), 0U);
+    // The biggest pool is released first, then we have no more than max free size of committed pools
+    ASSERT_EQ(ReleaseIdleFreePools(memPool, free_time + 2 * IDLE_TIME_MS), 4_MB);
+    ASSERT_EQ(GetCommittedFreePoolsSize(memPool), 2_MB);
+    ASSERT_FALSE(memPool->HasFreePoolsToRelease());
+    ASSERT_EQ(ReleaseIdleFreePools(memPool, free_time + 2 * IDLE_TIME_MS), 0U);
+    // Reused pools are not counted as free ones
+    auto pool4 = memPool->AllocPool(2_MB, SpaceType::SPACE_TYPE_OBJECT, AllocatorType::HUMONGOUS_ALLOCATOR);
+    ASSERT_TRUE(pool4.GetMem() != nullptr);
+    ASSERT_EQ(GetCommittedFreePoolsSize(memPool), 0U);
+    ASSERT_EQ(memPool->GetObjectSpaceFreeBytes(), 4_MB);
+}
+
 }  // namespace panda
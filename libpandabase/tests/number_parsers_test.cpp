@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/number_parsers.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace panda::number_parsers::test {
+
+static std::vector<uint8_t> ToUtf8(const std::string &str)
+{
+    return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+static std::vector<uint16_t> ToUtf16(const std::string &str)
+{
+    return std::vector<uint16_t>(str.begin(), str.end());
+}
+
+static std::vector<std::string> GetIntegerCorpus()
+{
+    std::vector<std::string> corpus = {"",
+                                       "0",
+                                       "-0",
+                                       "+7",
+                                       "  \t\n42",
+                                       "12abc",
+                                       "1234567",
+                                       "12345678",
+                                       "123456789",
+                                       "1234567812345678",
+                                       "00000000000000000000000123",
+                                       "2147483647",
+                                       "2147483648",
+                                       "-2147483649",
+                                       "9223372036854775807",
+                                       "9223372036854775808",
+                                       "-9223372036854775808",
+                                       "-9223372036854775809",
+                                       "18446744073709551615",
+                                       "18446744073709551616",
+                                       "-18446744073709551615",
+                                       "99999999999999999999",
+                                       "123456789012345678901234567890",
+                                       "1234:5678",
+                                       "12345678/9",
+                                       "- 1",
+                                       "--1",
+                                       "abc"};
+    std::mt19937_64 gen(0);
+    for (size_t i = 0; i < 1000U; i++) {
+        corpus.push_back(std::to_string(static_cast<int64_t>(gen()) >> (i % 64U)));
+    }
+    return corpus;
+}
+
+static std::vector<std::string> GetFloatingCorpus()
+{
+    std::vector<std::string> corpus = {"",
+                                       "0",
+                                       "-0",
+                                       "0.0",
+                                       ".5",
+                                       "5.",
+                                       ".",
+                                       "-.",
+                                       "1e",
+                                       "1e+",
+                                       "1.5e-3x",
+                                       "1E22",
+                                       "1e23",
+                                       "3.14159",
+                                       "  -2.5e+10",
+                                       "0x1p4",
+                                       "-0X1.8",
+                                       "inf",
+                                       "-Inf",
+                                       "nan",
+                                       "infinity",
+                                       "1e400",
+                                       "-1e-400",
+                                       "0e999999",
+                                       "4.9e-324",
+                                       "1.7976931348623157e308",
+                                       "9007199254740993",
+                                       "0.1",
+                                       "16777217",
+                                       "0.000000000000000000000000000001",
+                                       "123456789012345678901",
+                                       "1.00000000000000011102230246251565404236316680908203125",
+                                       // More than 19 significant digits in the integer and the fraction parts
+                                       "737889778.25975658873",
+                                       "26028.358218538924256654",
+                                       "0.000012345678901234567890123",
+                                       "1234567890.1234567890",
+                                       // Boundaries of normal, subnormal and infinite numbers
+                                       "2.2250738585072011e-308",
+                                       "2.2250738585072012e-308",
+                                       "2.4703282292062327e-324",
+                                       "2.4703282292062328e-324",
+                                       "1e-342",
+                                       "1e-343",
+                                       "1.7976931348623158e308",
+                                       "1.4e-45",
+                                       "7.0e-46",
+                                       "1.1754943e-38",
+                                       "3.4028235e38",
+                                       "3.4028236e38",
+                                       // Halfway between two doubles and just above it
+                                       "9007199254740993.000000000000000000000000000000",
+                                       "9007199254740993.000000000000000000000000000001",
+                                       "9223372036854775808e-10",
+                                       "123456789012345678901234567890e-300"};
+    std::mt19937_64 gen(0);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::array<char, 64U> buffer {};
+    for (size_t i = 0; i < 1000U; i++) {
+        double value = dist(gen);
+        for (const char *format : {"%.17g", "%.6g", "%.3f", "%.9e"}) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+            std::snprintf(buffer.data(), buffer.size(), format, value);
+            corpus.emplace_back(buffer.data());
+        }
+        double bits_value;
+        uint64_t bits = gen();
+        std::memcpy(&bits_value, &bits, sizeof(bits));
+        if (std::isfinite(bits_value)) {
+            // Shortest, long and truncated mantissas
+            for (const char *format : {"%.17g", "%.30e", "%.15g"}) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+                std::snprintf(buffer.data(), buffer.size(), format, bits_value);
+                corpus.emplace_back(buffer.data());
+            }
+        }
+        float float_value;
+        auto float_bits = static_cast<uint32_t>(gen());
+        std::memcpy(&float_value, &float_bits, sizeof(float_bits));
+        if (std::isfinite(float_value)) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+            std::snprintf(buffer.data(), buffer.size(), "%.9g", static_cast<double>(float_value));
+            corpus.emplace_back(buffer.data());
+        }
+    }
+    return corpus;
+}
+
+template <class F>
+static void ExpectSameFloating(F expected, F actual, const std::string &str)
+{
+    if (std::isnan(expected)) {
+        EXPECT_TRUE(std::isnan(actual)) << str;
+    } else {
+        // Compare bits to distinguish signed zeros
+        EXPECT_EQ(std::memcmp(&expected, &actual, sizeof(F)), 0) << str << " " << expected << " " << actual;
+    }
+}
+
+TEST(NumberParsers, EightDigits)
+{
+    EXPECT_TRUE(IsEightDigits(LoadEightChars(ToUtf8("01234567").data())));
+    EXPECT_EQ(ParseEightDigits(LoadEightChars(ToUtf8("01234567").data())), 1234567U);
+    EXPECT_EQ(ParseEightDigits(LoadEightChars(ToUtf8("99999999").data())), 99999999U);
+    for (char c : {'/', ':', 'a', ' ', '\0'}) {
+        for (size_t i = 0; i < SWAR_DIGITS; i++) {
+            std::string str = "12345678";
+            str[i] = c;
+            EXPECT_FALSE(IsEightDigits(LoadEightChars(ToUtf8(str).data()))) << str;
+        }
+    }
+}
+
+TEST(NumberParsers, Integers)
+{
+    for (const auto &str : GetIntegerCorpus()) {
+        auto utf8 = ToUtf8(str);
+        auto utf16 = ToUtf16(str);
+        long long expected_signed = std::strtoll(str.c_str(), nullptr, DECIMAL_BASE);
+        unsigned long long expected_unsigned = std::strtoull(str.c_str(), nullptr, DECIMAL_BASE);
+        EXPECT_EQ(ParseInt64(utf8.data(), utf8.size()), expected_signed) << str;
+        EXPECT_EQ(ParseInt64(utf16.data(), utf16.size()), expected_signed) << str;
+        EXPECT_EQ(ParseUint64(utf8.data(), utf8.size()), expected_unsigned) << str;
+        EXPECT_EQ(ParseUint64(utf16.data(), utf16.size()), expected_unsigned) << str;
+    }
+}
+
+TEST(NumberParsers, Floating)
+{
+    for (const auto &str : GetFloatingCorpus()) {
+        auto utf8 = ToUtf8(str);
+        auto utf16 = ToUtf16(str);
+        ExpectSameFloating(std::strtod(str.c_str(), nullptr), ParseDouble(utf8.data(), utf8.size()), str);
+        ExpectSameFloating(std::strtod(str.c_str(), nullptr), ParseDouble(utf16.data(), utf16.size()), str);
+        ExpectSameFloating(std::strtof(str.c_str(), nullptr), ParseFloat(utf8.data(), utf8.size()), str);
+        ExpectSameFloating(std::strtof(str.c_str(), nullptr), ParseFloat(utf16.data(), utf16.size()), str);
+    }
+}
+
+TEST(NumberParsers, NonAsciiEndsNumber)
+{
+    std::vector<uint16_t> utf16 = {'1', '2', 0x0663U, '4'};
+    EXPECT_EQ(ParseInt64(utf16.data(), utf16.size()), 12);
+    EXPECT_EQ(ParseDouble(utf16.data(), utf16.size()), 12.0);
+    // Characters which are equal to digits in the lowest byte are not digits
+    utf16 = {'1', '2', '3', '4', '5', '6', '7', 0x0138U, '9'};
+    EXPECT_EQ(ParseUint64(utf16.data(), utf16.size()), 1234567U);
+    utf16 = {'i', 'n', 'f', 0x0100U};
+    EXPECT_TRUE(std::isinf(ParseFloat(utf16.data(), utf16.size())));
+    // The whole string is parsed by the slow path even if it does not fit into the stack buffer
+    std::string str = "0." + std::string(FALLBACK_BUFFER_SIZE, '0') + "12345678901234567890123";
+    auto utf8 = ToUtf8(str);
+    ExpectSameFloating(std::strtod(str.c_str(), nullptr), ParseDouble(utf8.data(), utf8.size()), str);
+}
+
+// Compare with the conversion through a copy of the string which was used before
+TEST(NumberParsers, Throughput)
+{
+    constexpr size_t ITERATIONS = 100;
+    auto measure = [](const std::string &name, const std::vector<std::string> &corpus, auto parse) {
+        std::vector<std::vector<uint8_t>> strings;
+        for (const auto &str : corpus) {
+            strings.push_back(ToUtf8(str));
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t non_zero = 0;
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            for (const auto &str : strings) {
+                non_zero += parse(str) != 0 ? 1U : 0U;
+            }
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        EXPECT_GT(non_zero, 0U);
+        RecordProperty(name + "_ns_per_string",
+                       std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() /
+                                      static_cast<int64_t>(ITERATIONS * strings.size())));
+    };
+
+    auto integers = GetIntegerCorpus();
+    measure("int64", integers, [](const std::vector<uint8_t> &str) { return ParseInt64(str.data(), str.size()); });
+    measure("int64_strtoll", integers, [](const std::vector<uint8_t> &str) {
+        return std::strtoll(std::string(str.begin(), str.end()).c_str(), nullptr, DECIMAL_BASE);
+    });
+    auto floating = GetFloatingCorpus();
+    measure("double", floating, [](const std::vector<uint8_t> &str) { return ParseDouble(str.data(), str.size()); });
+    measure("double_strtod", floating, [](const std::vector<uint8_t> &str) {
+        return std::strtod(std::string(str.begin(), str.end()).c_str(), nullptr);
+    });
+}
+
+}  // namespace panda::number_parsers::test
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/string_kernels.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace panda::string_kernels::test {
+
+// Lengths cover empty data, tails shorter than a vector and several vectors with a tail
+static constexpr size_t MAX_LENGTH = 67;
+
+TEST(StringKernels, IsAsciiOnly)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        std::vector<uint8_t> data8(length, 'a');
+        std::vector<uint16_t> data16(length, 'a');
+        EXPECT_TRUE(IsAsciiOnly(data8.data(), length));
+        EXPECT_TRUE(IsAsciiOnly(data16.data(), length));
+        for (size_t i = 0; i < length; i++) {
+            for (uint16_t c : {0x0U, 0x80U, 0xffU, 0x100U, 0xff7fU}) {
+                data8[i] = static_cast<uint8_t>(c);
+                data16[i] = c;
+                if (c <= UINT8_MAX) {
+                    EXPECT_FALSE(IsAsciiOnly(data8.data(), length)) << length << " " << i << " " << c;
+                }
+                EXPECT_FALSE(IsAsciiOnly(data16.data(), length)) << length << " " << i << " " << c;
+            }
+            data8[i] = ASCII_MAX;
+            data16[i] = ASCII_MAX;
+            EXPECT_TRUE(IsAsciiOnly(data8.data(), length));
+            EXPECT_TRUE(IsAsciiOnly(data16.data(), length));
+        }
+    }
+}
+
+TEST(StringKernels, FindMismatch)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        std::vector<uint8_t> lhs8(length, 'a');
+        std::vector<uint8_t> rhs8(length, 'a');
+        std::vector<uint16_t> lhs16(length, 'a');
+        std::vector<uint16_t> rhs16(length, 'a');
+        EXPECT_EQ(FindMismatch(lhs8.data(), rhs8.data(), length), length);
+        EXPECT_EQ(FindMismatch(lhs16.data(), rhs16.data(), length), length);
+        EXPECT_EQ(FindMismatch(lhs8.data(), rhs16.data(), length), length);
+        EXPECT_EQ(FindMismatch(lhs16.data(), rhs8.data(), length), length);
+        // Mismatches after the first one must not change the result
+        for (size_t i = length; i-- > 0;) {
+            rhs8[i] = 'b';
+            rhs16[i] = 'a' + 0x100U;
+            EXPECT_EQ(FindMismatch(lhs8.data(), rhs8.data(), length), i);
+            EXPECT_EQ(FindMismatch(lhs16.data(), rhs16.data(), length), i);
+            EXPECT_EQ(FindMismatch(lhs8.data(), rhs16.data(), length), i);
+            EXPECT_EQ(FindMismatch(lhs16.data(), rhs8.data(), length), i);
+        }
+    }
+}
+
+TEST(StringKernels, FindChar)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        std::vector<uint8_t> data8(length, 'a');
+        std::vector<uint16_t> data16(length, 'a');
+        EXPECT_EQ(FindChar(data8.data(), length, 'b'), length);
+        EXPECT_EQ(FindChar(data16.data(), length, 'b'), length);
+        EXPECT_EQ(FindChar(data8.data(), length, 'a' + 0x100U), length);
+        EXPECT_EQ(FindChar(data16.data(), length, 'a' + 0x100U), length);
+        for (size_t i = length; i-- > 0;) {
+            data8[i] = 'b';
+            data16[i] = 'b';
+            EXPECT_EQ(FindChar(data8.data(), length, 'b'), i);
+            EXPECT_EQ(FindChar(data16.data(), length, 'b'), i);
+        }
+    }
+}
+
+TEST(StringKernels, WidenAndNarrow)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        std::vector<uint8_t> data8(length);
+        for (size_t i = 0; i < length; i++) {
+            data8[i] = static_cast<uint8_t>(i * 7U + 1U);
+        }
+        std::vector<uint16_t> data16(length + 1U, 0xffffU);
+        Widen(data8.data(), data16.data(), length);
+        for (size_t i = 0; i < length; i++) {
+            EXPECT_EQ(data16[i], data8[i]);
+        }
+        EXPECT_EQ(data16[length], 0xffffU);
+
+        std::vector<uint8_t> narrowed(length + 1U, 0xffU);
+        Narrow(data16.data(), narrowed.data(), length);
+        for (size_t i = 0; i < length; i++) {
+            EXPECT_EQ(narrowed[i], data8[i]);
+        }
+        EXPECT_EQ(narrowed[length], 0xffU);
+    }
+}
+
+TEST(StringKernels, HashCode)
+{
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        std::vector<uint8_t> data8(length);
+        std::vector<uint16_t> data16(length);
+        uint32_t expected8 = 0;
+        uint32_t expected16 = 0;
+        for (size_t i = 0; i < length; i++) {
+            data8[i] = static_cast<uint8_t>(i * 37U + 1U);
+            data16[i] = static_cast<uint16_t>(i * 7919U + 0xff00U);
+            expected8 = expected8 * 31U + data8[i];
+            expected16 = expected16 * 31U + data16[i];
+        }
+        EXPECT_EQ(HashCode(0U, data8.data(), length), expected8) << length;
+        EXPECT_EQ(HashCode(0U, data16.data(), length), expected16) << length;
+        // The hash is continued from the given value
+        size_t half = length / 2U;
+        EXPECT_EQ(HashCode(HashCode(0U, data16.data(), half), data16.data() + half, length - half), expected16);
+    }
+}
+
+}  // namespace panda::string_kernels::test
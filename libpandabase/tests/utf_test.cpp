@@ -15,8 +15,10 @@
 
 #include "utils/utf.h"
 
+#include <chrono>
 #include <cstdint>
 
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -399,4 +401,99 @@ TEST(Utf, CompareUtf8ToUtf8)
     }
 }
 
+// Text in different scripts, the vectorized paths of the conversions are taken on long runs of ASCII
+static std::vector<std::pair<std::string, std::vector<uint16_t>>> GetCorpora()
+{
+    constexpr size_t REPEATS = 64;
+    std::vector<std::pair<std::string, std::vector<uint16_t>>> corpora;
+    auto add = [&corpora](const char *name, const std::vector<uint16_t> &piece) {
+        std::vector<uint16_t> text;
+        for (size_t i = 0; i < REPEATS; i++) {
+            text.insert(text.end(), piece.begin(), piece.end());
+        }
+        corpora.emplace_back(name, text);
+    };
+    std::string descriptor = "Lpanda/runtime/ClassDescriptor$Inner;";
+    add("descriptors", std::vector<uint16_t>(descriptor.begin(), descriptor.end()));
+    // "Hello, мир! " and "Привет, world "
+    add("latin_cyrillic", {0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x43c, 0x438, 0x440, 0x21, 0x20, 0x41f, 0x440,
+                           0x438, 0x432, 0x435, 0x442, 0x2c, 0x20, 0x77, 0x6f, 0x72, 0x6c, 0x64, 0x20});
+    // CJK with ASCII digits
+    add("cjk", {0x4f60, 0x597d, 0x4e16, 0x754c, 0x31, 0x32, 0x33, 0x65e5, 0x672c, 0x8a9e});
+    // Surrogate pairs and U+0000
+    add("supplementary", {0x61, 0xd83d, 0xde00, 0x62, 0x0, 0x63, 0xd83c, 0xdf0d, 0x20});
+    return corpora;
+}
+
+TEST(Utf, ConvertCorpora)
+{
+    for (const auto &[name, utf16] : GetCorpora()) {
+        size_t mutf8_size = Utf16ToMUtf8Size(utf16.data(), utf16.size());
+        std::vector<uint8_t> mutf8(mutf8_size);
+        size_t written = ConvertRegionUtf16ToMUtf8(utf16.data(), mutf8.data(), utf16.size(), mutf8_size - 1, 0);
+        ASSERT_EQ(written, mutf8_size - 1) << name;
+        mutf8[written] = '\0';
+
+        // Reference decoding of one code point at a time
+        std::vector<uint16_t> expected;
+        for (size_t pos = 0; pos < written;) {
+            auto [pair, nbytes] = ConvertMUtf8ToUtf16Pair(&mutf8[pos], written - pos);
+            auto [p_hi, p_lo] = SplitUtf16Pair(pair);
+            if (p_hi != 0) {
+                expected.push_back(p_hi);
+            }
+            expected.push_back(p_lo);
+            pos += nbytes;
+        }
+        EXPECT_EQ(expected, utf16) << name;
+
+        EXPECT_EQ(MUtf8ToUtf16Size(mutf8.data()), utf16.size()) << name;
+        EXPECT_EQ(MUtf8ToUtf16Size(mutf8.data(), written), utf16.size()) << name;
+        EXPECT_EQ(IsMUtf8OnlySingleBytes(mutf8.data()), written == utf16.size()) << name;
+
+        std::vector<uint16_t> decoded(utf16.size());
+        ConvertMUtf8ToUtf16(mutf8.data(), written, decoded.data());
+        EXPECT_EQ(decoded, utf16) << name;
+
+        // Region conversions stop at the end of the output and skip the start of the input
+        for (size_t utf16_len : {size_t(1), utf16.size() / 2U, utf16.size()}) {
+            std::vector<uint16_t> region(utf16.size(), 0xffffU);
+            size_t converted = ConvertRegionMUtf8ToUtf16(mutf8.data(), region.data(), written, utf16_len, 0);
+            ASSERT_LE(converted, utf16_len) << name;
+            EXPECT_TRUE(std::equal(region.begin(), region.begin() + converted, utf16.begin())) << name;
+        }
+        // The first half of the descriptors corpus is skipped by bytes
+        if (written == utf16.size()) {
+            size_t start = written / 2U;
+            std::vector<uint16_t> region(utf16.size() - start);
+            EXPECT_EQ(ConvertRegionMUtf8ToUtf16(mutf8.data(), region.data(), written, region.size(), start),
+                      region.size());
+            EXPECT_TRUE(std::equal(region.begin(), region.end(), utf16.begin() + start)) << name;
+        }
+    }
+}
+
+TEST(Utf, ConvertCorporaThroughput)
+{
+    constexpr size_t ITERATIONS = 1000;
+    for (const auto &[name, utf16] : GetCorpora()) {
+        size_t mutf8_size = Utf16ToMUtf8Size(utf16.data(), utf16.size());
+        std::vector<uint8_t> mutf8(mutf8_size);
+        std::vector<uint16_t> decoded(utf16.size());
+
+        auto start = std::chrono::steady_clock::now();
+        size_t checksum = 0;
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            checksum += ConvertRegionUtf16ToMUtf8(utf16.data(), mutf8.data(), utf16.size(), mutf8_size - 1, 0);
+            ConvertMUtf8ToUtf16(mutf8.data(), mutf8_size - 1, decoded.data());
+            checksum += MUtf8ToUtf16Size(mutf8.data(), mutf8_size - 1);
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        EXPECT_EQ(checksum, ITERATIONS * (mutf8_size - 1 + utf16.size()));
+        RecordProperty(name + "_ns_per_char",
+                       std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() /
+                                      static_cast<int64_t>(ITERATIONS * utf16.size())));
+    }
+}
+
 }  // namespace panda::utf::test
@@ -0,0 +1,522 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_LIBPANDABASE_UTILS_NUMBER_PARSERS_H_
+#define PANDA_LIBPANDABASE_UTILS_NUMBER_PARSERS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+/**
+ * Parsers of decimal numbers from characters of strings, both compressed (uint8_t) and UTF-16 (uint16_t) ones.
+ * The results are the same as of strtoll, strtoull, strtof and strtod in the "C" locale applied to the string,
+ * i.e. leading whitespace is skipped, parsing stops at the first unexpected character and integers saturate.
+ * Characters which are not ASCII end the number, no copy of the string is needed.
+ * Eight digits of compressed strings are checked and converted at once with SWAR on little-endian targets.
+ * Floating point numbers with at most 19 significant digits and a small exponent are converted with
+ * the exact fast path (mantissa and power of ten are exact, so one rounding gives the correctly rounded result),
+ * other decimal numbers with the Eisel-Lemire algorithm. Mantissas longer than 19 digits are truncated, then
+ * the number is between the truncated mantissa and the next one, and the result is known if both round the same.
+ * Hexadecimal numbers, infinities, NaNs, huge exponents and the rare cases which Eisel-Lemire cannot round
+ * are passed to strtod.
+ */
+namespace panda::number_parsers {
+
+static constexpr uint32_t DECIMAL_BASE = 10U;
+// Any number of 19 decimal digits fits into uint64_t
+static constexpr size_t MAX_UINT64_DIGITS = 19U;
+static constexpr size_t SWAR_DIGITS = 8U;
+static constexpr uint32_t SWAR_MULTIPLIER = 100000000U;
+static constexpr size_t FALLBACK_BUFFER_SIZE = 64U;
+// Numbers with greater exponents are left to strtod, a long mantissa may still bring them into the range
+static constexpr uint64_t MAX_DECIMAL_EXPONENT = 100000U;
+
+template <class T>
+inline bool IsDigit(T c)
+{
+    return static_cast<uint32_t>(c) - static_cast<uint32_t>('0') < DECIMAL_BASE;
+}
+
+template <class T>
+inline uint32_t DigitValue(T c)
+{
+    return static_cast<uint32_t>(c) - static_cast<uint32_t>('0');
+}
+
+template <class T>
+inline bool IsSpace(T c)
+{
+    return c == ' ' || (static_cast<uint32_t>(c) - static_cast<uint32_t>('\t') <= static_cast<uint32_t>('\r' - '\t'));
+}
+
+template <class T>
+inline size_t SkipSpaces(const T *data, size_t length)
+{
+    size_t i = 0;
+    while (i < length && IsSpace(data[i])) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * \brief Consume an optional sign at *pos, return true for '-'
+ */
+template <class T>
+inline bool ParseSign(const T *data, size_t length, size_t *pos)
+{
+    if (*pos < length && (data[*pos] == '-' || data[*pos] == '+')) {
+        return data[(*pos)++] == '-';
+    }
+    return false;
+}
+
+template <class T>
+inline constexpr bool CanUseSwar()
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return std::is_same_v<T, uint8_t>;
+#else
+    return false;
+#endif
+}
+
+inline uint64_t LoadEightChars(const uint8_t *data)
+{
+    uint64_t chunk;
+    std::memcpy(&chunk, data, sizeof(chunk));
+    return chunk;
+}
+
+/**
+ * \brief Check that all eight characters of the chunk are decimal digits
+ */
+inline bool IsEightDigits(uint64_t chunk)
+{
+    constexpr uint64_t HIGH_NIBBLES = 0xF0F0F0F0F0F0F0F0ULL;
+    constexpr uint64_t ZEROS = 0x3030303030303030ULL;
+    // Characters greater than '9' get carried to the high nibble
+    constexpr uint64_t CARRY = 0x0606060606060606ULL;
+    return (chunk & HIGH_NIBBLES) == ZEROS && ((chunk + CARRY) & HIGH_NIBBLES) == ZEROS;
+}
+
+/**
+ * \brief Convert eight digits of the chunk, the first digit is in the lowest byte
+ */
+inline uint32_t ParseEightDigits(uint64_t chunk)
+{
+    constexpr uint64_t ZEROS = 0x3030303030303030ULL;
+    constexpr uint64_t PAIRS_MASK = 0x000000FF000000FFULL;
+    constexpr uint64_t MUL1 = 100U + (1000000ULL << 32U);
+    constexpr uint64_t MUL2 = 1U + (10000ULL << 32U);
+    constexpr uint32_t BYTE_BITS = 8U;
+    constexpr uint32_t HALF_BITS = 16U;
+    constexpr uint32_t WORD_BITS = 32U;
+    chunk -= ZEROS;
+    // Each byte pair holds a two-digit number, then the pairs are combined with the multiplications
+    chunk = (chunk * DECIMAL_BASE) + (chunk >> BYTE_BITS);
+    chunk = (((chunk & PAIRS_MASK) * MUL1) + (((chunk >> HALF_BITS) & PAIRS_MASK) * MUL2)) >> WORD_BITS;
+    return static_cast<uint32_t>(chunk);
+}
+
+/**
+ * \brief Parse decimal digits starting at *pos like strtoull does, *overflow is set if the value is too large
+ */
+template <class T>
+inline uint64_t ParseDigits(const T *data, size_t length, size_t *pos, bool *overflow)
+{
+    size_t i = *pos;
+    while (i < length && data[i] == '0') {
+        i++;
+    }
+    size_t start = i;
+    uint64_t value = 0;
+    if constexpr (CanUseSwar<T>()) {
+        while (i + SWAR_DIGITS <= length && i - start + SWAR_DIGITS <= MAX_UINT64_DIGITS) {
+            uint64_t chunk = LoadEightChars(data + i);
+            if (!IsEightDigits(chunk)) {
+                break;
+            }
+            value = value * SWAR_MULTIPLIER + ParseEightDigits(chunk);
+            i += SWAR_DIGITS;
+        }
+    }
+    for (; i < length && IsDigit(data[i]); i++) {
+        if (i - start < MAX_UINT64_DIGITS) {
+            value = value * DECIMAL_BASE + DigitValue(data[i]);
+        } else if (__builtin_mul_overflow(value, DECIMAL_BASE, &value) ||
+                   __builtin_add_overflow(value, DigitValue(data[i]), &value)) {
+            *overflow = true;
+        }
+    }
+    *pos = i;
+    return value;
+}
+
+/**
+ * \brief Same as strtoll(str, nullptr, 10) for the string of the given characters
+ */
+template <class T>
+inline int64_t ParseInt64(const T *data, size_t length)
+{
+    size_t pos = SkipSpaces(data, length);
+    bool negative = ParseSign(data, length, &pos);
+    bool overflow = false;
+    uint64_t value = ParseDigits(data, length, &pos, &overflow);
+    constexpr auto MAX_VALUE = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if (negative) {
+        if (overflow || value > MAX_VALUE + 1U) {
+            return std::numeric_limits<int64_t>::min();
+        }
+        return static_cast<int64_t>(0U - value);
+    }
+    if (overflow || value > MAX_VALUE) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return static_cast<int64_t>(value);
+}
+
+/**
+ * \brief Same as strtoull(str, nullptr, 10) for the string of the given characters
+ */
+template <class T>
+inline uint64_t ParseUint64(const T *data, size_t length)
+{
+    size_t pos = SkipSpaces(data, length);
+    bool negative = ParseSign(data, length, &pos);
+    bool overflow = false;
+    uint64_t value = ParseDigits(data, length, &pos, &overflow);
+    if (overflow) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return negative ? 0U - value : value;
+}
+
+/**
+ * \brief Call strtof or strtod for the characters copied to a zero terminated buffer
+ */
+template <class F, class T>
+inline F ParseFloatingSlow(const T *data, size_t length)
+{
+    std::array<char, FALLBACK_BUFFER_SIZE> buffer {};
+    std::string long_buffer;
+    char *str = buffer.data();
+    if (length >= buffer.size()) {
+        long_buffer.resize(length);
+        str = long_buffer.data();
+    }
+    size_t i = 0;
+    constexpr uint32_t ASCII_MAX = 0x7f;
+    for (; i < length && data[i] != 0 && data[i] <= ASCII_MAX; i++) {
+        str[i] = static_cast<char>(data[i]);
+    }
+    str[i] = '\0';
+    if constexpr (std::is_same_v<F, float>) {
+        return std::strtof(str, nullptr);
+    } else {
+        return std::strtod(str, nullptr);
+    }
+}
+
+template <class F>
+struct FastPathTraits;
+
+template <>
+struct FastPathTraits<double> {
+    static constexpr uint64_t MAX_MANTISSA = 1ULL << 53U;
+    static constexpr int32_t MAX_EXPONENT = 22;
+};
+
+template <>
+struct FastPathTraits<float> {
+    static constexpr uint64_t MAX_MANTISSA = 1ULL << 24U;
+    static constexpr int32_t MAX_EXPONENT = 10;
+};
+
+template <class F>
+inline F ExactPowerOfTen(int32_t exponent)
+{
+    // Powers of ten up to 1e22 are exact in double
+    static constexpr std::array<double, FastPathTraits<double>::MAX_EXPONENT + 1> POWERS = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    return static_cast<F>(POWERS[exponent]);
+}
+
+/**
+ * \brief Parse decimal digits of the mantissa starting at *pos, digits after the point decrease *exponent
+ * *significant_digits counts the digits accumulated in *mantissa since the first non-zero one, it is shared by
+ * the integer and the fraction parts of the number. Digits after the first 19 significant ones are dropped,
+ * *truncated is set if any of them is not zero
+ */
+template <class T>
+inline void ParseMantissa(const T *data, size_t length, size_t *pos, uint64_t *mantissa, size_t *significant_digits,
+                          int64_t *exponent, bool *truncated, bool fraction)
+{
+    size_t i = *pos;
+    size_t digits = *significant_digits;
+    if constexpr (CanUseSwar<T>()) {
+        while (i + SWAR_DIGITS <= length) {
+            uint64_t chunk = LoadEightChars(data + i);
+            if (!IsEightDigits(chunk) || (*mantissa != 0 && digits + SWAR_DIGITS > MAX_UINT64_DIGITS)) {
+                break;
+            }
+            *mantissa = *mantissa * SWAR_MULTIPLIER + ParseEightDigits(chunk);
+            // Leading zeros are not significant
+            digits = *mantissa == 0 ? 0 : digits + SWAR_DIGITS;
+            *exponent -= fraction ? static_cast<int64_t>(SWAR_DIGITS) : 0;
+            i += SWAR_DIGITS;
+        }
+    }
+    for (; i < length && IsDigit(data[i]); i++) {
+        if (*mantissa != 0 && digits == MAX_UINT64_DIGITS) {
+            // A dropped digit of the integer part scales the mantissa
+            *exponent += fraction ? 0 : 1;
+            *truncated = *truncated || data[i] != '0';
+            continue;
+        }
+        *mantissa = *mantissa * DECIMAL_BASE + DigitValue(data[i]);
+        digits = *mantissa == 0 ? 0 : digits + 1;
+        *exponent -= fraction ? 1 : 0;
+    }
+    *pos = i;
+    *significant_digits = digits;
+}
+
+static constexpr int32_t SMALLEST_POWER_OF_FIVE = -342;
+static constexpr int32_t LARGEST_POWER_OF_FIVE = 308;
+static constexpr size_t POWERS_OF_FIVE_COUNT = LARGEST_POWER_OF_FIVE - SMALLEST_POWER_OF_FIVE + 1;
+
+/**
+ * 128-bit approximations of 5^q for q from SMALLEST_POWER_OF_FIVE to LARGEST_POWER_OF_FIVE, two words per power,
+ * the high word first. The most significant bit of each power is set
+ */
+extern const std::array<uint64_t, 2U * POWERS_OF_FIVE_COUNT> POWERS_OF_FIVE_128;
+
+template <class F>
+struct EiselLemireTraits;
+
+template <>
+struct EiselLemireTraits<double> {
+    using Bits = uint64_t;
+    static constexpr uint32_t MANTISSA_BITS = 52U;
+    static constexpr int32_t MINIMUM_EXPONENT = -1023;
+    static constexpr int32_t INFINITE_POWER = 0x7FF;
+    // Below the smallest power any 19-digit mantissa rounds to zero, above the largest one any rounds to infinity
+    static constexpr int32_t SMALLEST_POWER_OF_TEN = -342;
+    static constexpr int32_t LARGEST_POWER_OF_TEN = 308;
+    // Only products with these powers of ten may be exactly halfway between two numbers
+    static constexpr int32_t MIN_EXPONENT_ROUND_TO_EVEN = -4;
+    static constexpr int32_t MAX_EXPONENT_ROUND_TO_EVEN = 23;
+};
+
+template <>
+struct EiselLemireTraits<float> {
+    using Bits = uint32_t;
+    static constexpr uint32_t MANTISSA_BITS = 23U;
+    static constexpr int32_t MINIMUM_EXPONENT = -127;
+    static constexpr int32_t INFINITE_POWER = 0xFF;
+    static constexpr int32_t SMALLEST_POWER_OF_TEN = -65;
+    static constexpr int32_t LARGEST_POWER_OF_TEN = 38;
+    static constexpr int32_t MIN_EXPONENT_ROUND_TO_EVEN = -17;
+    static constexpr int32_t MAX_EXPONENT_ROUND_TO_EVEN = 10;
+};
+
+/**
+ * \brief Round mantissa * 10^exponent to the nearest floating point number with the Eisel-Lemire algorithm,
+ * *bits gets the representation of the absolute value. The mantissa must not be zero
+ * \return false if the 128-bit approximation of the power of five is not enough to round the product
+ */
+template <class F>
+inline bool EiselLemire(uint64_t mantissa, int64_t exponent, typename EiselLemireTraits<F>::Bits *bits)
+{
+    using Traits = EiselLemireTraits<F>;
+    using Bits = typename Traits::Bits;
+    constexpr uint32_t WORD_BITS = 64U;
+    constexpr Bits INFINITY_BITS = static_cast<Bits>(Traits::INFINITE_POWER) << Traits::MANTISSA_BITS;
+    if (exponent < Traits::SMALLEST_POWER_OF_TEN) {
+        *bits = 0;
+        return true;
+    }
+    if (exponent > Traits::LARGEST_POWER_OF_TEN) {
+        *bits = INFINITY_BITS;
+        return true;
+    }
+    auto q = static_cast<int32_t>(exponent);
+    auto leading_zeros = static_cast<int32_t>(__builtin_clzll(mantissa));
+    mantissa <<= static_cast<uint32_t>(leading_zeros);
+
+    // The product of the mantissa and the power of five, truncated to 128 bits. Its high word must be exact in
+    // the mantissa bits and three more: the rounding bit and the possible leading zero
+    constexpr uint32_t PRECISION = Traits::MANTISSA_BITS + 3U;
+    constexpr uint64_t PRECISION_MASK = std::numeric_limits<uint64_t>::max() >> PRECISION;
+    auto index = 2U * static_cast<size_t>(q - SMALLEST_POWER_OF_FIVE);
+    __uint128_t first = static_cast<__uint128_t>(mantissa) * POWERS_OF_FIVE_128[index];
+    auto high = static_cast<uint64_t>(first >> WORD_BITS);
+    auto low = static_cast<uint64_t>(first);
+    if ((high & PRECISION_MASK) == PRECISION_MASK) {
+        // The ignored low word of the power may carry into the significant bits
+        __uint128_t second = static_cast<__uint128_t>(mantissa) * POWERS_OF_FIVE_128[index + 1U];
+        auto second_high = static_cast<uint64_t>(second >> WORD_BITS);
+        low += second_high;
+        high += second_high > low ? 1U : 0U;
+    }
+    // Powers of five from 5^-27 to 5^55 are exact in 128 bits, others may still carry into the high word
+    constexpr int32_t MIN_EXACT_POWER = -27;
+    constexpr int32_t MAX_EXACT_POWER = 55;
+    if (low == std::numeric_limits<uint64_t>::max() && (q < MIN_EXACT_POWER || q > MAX_EXACT_POWER)) {
+        return false;
+    }
+
+    auto upper_bit = static_cast<int32_t>(high >> (WORD_BITS - 1U));
+    auto shift = static_cast<uint32_t>(upper_bit) + WORD_BITS - Traits::MANTISSA_BITS - 3U;
+    uint64_t result = high >> shift;
+    // floor(log2(10^q)) + 63 is (217706 * q >> 16) + 63 for q in [-342, 308]
+    constexpr int32_t LOG2_10_MULTIPLIER = 217706;
+    constexpr uint32_t LOG2_10_SHIFT = 16U;
+    int32_t power2 = ((LOG2_10_MULTIPLIER * q) >> LOG2_10_SHIFT) + static_cast<int32_t>(WORD_BITS - 1U) + upper_bit -
+                     leading_zeros - Traits::MINIMUM_EXPONENT;
+    if (power2 <= 0) {
+        // Subnormal number or zero
+        if (-power2 + 1 >= static_cast<int32_t>(WORD_BITS)) {
+            *bits = 0;
+            return true;
+        }
+        result >>= static_cast<uint32_t>(-power2 + 1);
+        result += result & 1U;
+        result >>= 1U;
+        // Rounding up may give the smallest normal number, its exponent bit is the leading bit of the mantissa
+        *bits = static_cast<Bits>(result);
+        return true;
+    }
+    // The product is exactly halfway between two numbers, round to even instead of up
+    if (low <= 1U && q >= Traits::MIN_EXPONENT_ROUND_TO_EVEN && q <= Traits::MAX_EXPONENT_ROUND_TO_EVEN &&
+        (result & 3U) == 1U && (result << shift) == high) {
+        result &= ~uint64_t(1U);
+    }
+    result += result & 1U;
+    result >>= 1U;
+    if (result >= (uint64_t(2U) << Traits::MANTISSA_BITS)) {
+        result = uint64_t(1U) << Traits::MANTISSA_BITS;
+        power2++;
+    }
+    result &= ~(uint64_t(1U) << Traits::MANTISSA_BITS);
+    if (power2 >= Traits::INFINITE_POWER) {
+        *bits = INFINITY_BITS;
+        return true;
+    }
+    *bits = static_cast<Bits>(result | (static_cast<uint64_t>(power2) << Traits::MANTISSA_BITS));
+    return true;
+}
+
+/**
+ * \brief Same as strtof or strtod(str, nullptr) for the string of the given characters
+ */
+template <class F, class T>
+inline F ParseFloating(const T *data, size_t length)
+{
+    static_assert(std::is_same_v<F, float> || std::is_same_v<F, double>);
+    size_t start = SkipSpaces(data, length);
+    size_t pos = start;
+    bool negative = ParseSign(data, length, &pos);
+    size_t digits_start = pos;
+    // Hexadecimal numbers are left to the slow path
+    if (pos + 1 < length && data[pos] == '0' && (data[pos + 1] == 'x' || data[pos + 1] == 'X')) {
+        return ParseFloatingSlow<F>(data + start, length - start);
+    }
+
+    uint64_t mantissa = 0;
+    size_t significant_digits = 0;
+    int64_t exponent = 0;
+    bool truncated = false;
+    ParseMantissa(data, length, &pos, &mantissa, &significant_digits, &exponent, &truncated, false);
+    size_t digits_count = pos - digits_start;
+    if (pos < length && data[pos] == '.') {
+        pos++;
+        size_t fraction_start = pos;
+        ParseMantissa(data, length, &pos, &mantissa, &significant_digits, &exponent, &truncated, true);
+        digits_count += pos - fraction_start;
+    }
+    if (digits_count == 0) {
+        // Infinities, NaNs and strings without a number
+        return ParseFloatingSlow<F>(data + start, length - start);
+    }
+
+    if (pos < length && (data[pos] == 'e' || data[pos] == 'E')) {
+        size_t exponent_pos = pos + 1;
+        bool negative_exponent = ParseSign(data, length, &exponent_pos);
+        // The exponent is a part of the number only if it has digits
+        if (exponent_pos < length && IsDigit(data[exponent_pos])) {
+            bool overflow = false;
+            uint64_t value = ParseDigits(data, length, &exponent_pos, &overflow);
+            if (overflow || value > MAX_DECIMAL_EXPONENT) {
+                return mantissa == 0 ? (negative ? -F(0) : F(0)) : ParseFloatingSlow<F>(data + start, length - start);
+            }
+            exponent += negative_exponent ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+        }
+    }
+
+    if (mantissa == 0) {
+        return negative ? -F(0) : F(0);
+    }
+    if (!truncated && mantissa <= FastPathTraits<F>::MAX_MANTISSA && exponent <= FastPathTraits<F>::MAX_EXPONENT &&
+        exponent >= -FastPathTraits<F>::MAX_EXPONENT) {
+        auto value = static_cast<F>(mantissa);
+        value = exponent < 0 ? value / ExactPowerOfTen<F>(static_cast<int32_t>(-exponent))
+                             : value * ExactPowerOfTen<F>(static_cast<int32_t>(exponent));
+        return negative ? -value : value;
+    }
+
+    typename EiselLemireTraits<F>::Bits bits = 0;
+    if (!EiselLemire<F>(mantissa, exponent, &bits)) {
+        return ParseFloatingSlow<F>(data + start, length - start);
+    }
+    if (truncated) {
+        // The number is between the truncated mantissa and the next one, both must give the same result
+        typename EiselLemireTraits<F>::Bits next_bits = 0;
+        if (!EiselLemire<F>(mantissa + 1U, exponent, &next_bits) || next_bits != bits) {
+            return ParseFloatingSlow<F>(data + start, length - start);
+        }
+    }
+    F value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return negative ? -value : value;
+}
+
+template <class T>
+inline float ParseFloat(const T *data, size_t length)
+{
+    return ParseFloating<float>(data, length);
+}
+
+template <class T>
+inline double ParseDouble(const T *data, size_t length)
+{
+    return ParseFloating<double>(data, length);
+}
+
+}  // namespace panda::number_parsers
+
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+#endif  // PANDA_LIBPANDABASE_UTILS_NUMBER_PARSERS_H_
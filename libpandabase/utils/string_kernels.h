@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_LIBPANDABASE_UTILS_STRING_KERNELS_H_
+#define PANDA_LIBPANDABASE_UTILS_STRING_KERNELS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "utils/bit_utils.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PANDA_STRING_KERNELS_NEON
+#endif
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-type-reinterpret-cast)
+
+/**
+ * Kernels for the hot loops over characters of strings.
+ * They process 16 bytes at a time with SSE2 on x86-64 and with NEON on AArch64, both are baseline there,
+ * so no runtime dispatch is needed. The rest of the data and other targets are handled by the scalar code.
+ * "ASCII" means characters in [1, 0x7f], i.e. characters which are stored in one byte in compressed strings.
+ */
+namespace panda::string_kernels {
+
+static constexpr size_t VECTOR_SIZE = 16;
+static constexpr uint16_t ASCII_MAX = 0x7f;
+
+inline bool IsAscii(uint16_t c)
+{
+    return static_cast<uint16_t>(c - 1U) < ASCII_MAX;
+}
+
+inline bool IsAsciiOnly(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        // Sign bits are set for non-ASCII bytes and for results of the comparison of zero bytes
+        if (_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero))) != 0) {
+            return false;
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        uint8x16_t v = vld1q_u8(data + i);
+        if (vminvq_u8(v) == 0 || vmaxvq_u8(v) > ASCII_MAX) {
+            return false;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (!IsAscii(data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Count leading ASCII characters, they are encoded in one byte in MUTF-8
+ */
+inline size_t CountAscii(const uint16_t *data, size_t length)
+{
+    size_t i = 0;
+    constexpr size_t STEP = VECTOR_SIZE / sizeof(uint16_t);
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<int16_t>(~ASCII_MAX));
+    for (; i + STEP <= length; i += STEP) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i has_non_ascii_bits = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(v, non_ascii_bits), zero),
+                                                      _mm_set1_epi16(-1));
+        __m128i non_ascii = _mm_or_si128(has_non_ascii_bits, _mm_cmpeq_epi16(v, zero));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(non_ascii));
+        if (mask != 0) {
+            return i + static_cast<size_t>(Ctz(mask)) / sizeof(uint16_t);
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + STEP <= length; i += STEP) {
+        uint16x8_t v = vld1q_u16(data + i);
+        if (vminvq_u16(v) == 0 || vmaxvq_u16(v) > ASCII_MAX) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (!IsAscii(data[i])) {
+            return i;
+        }
+    }
+    return length;
+}
+
+inline bool IsAsciiOnly(const uint16_t *data, size_t length)
+{
+    return CountAscii(data, length) == length;
+}
+
+/**
+ * \brief Count leading bytes below 0x80, they are one-byte characters in MUTF-8
+ */
+inline size_t CountSingleBytes(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(v));
+        if (mask != 0) {
+            return i + static_cast<size_t>(Ctz(mask));
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) > ASCII_MAX) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (data[i] > ASCII_MAX) {
+            return i;
+        }
+    }
+    return length;
+}
+
+/**
+ * \brief Find the first position where the characters differ
+ * @return index of the first different characters or length if all characters are equal
+ */
+inline size_t FindMismatch(const uint8_t *lhs, const uint8_t *rhs, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    constexpr uint32_t ALL_EQUAL = 0xffffU;
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)));
+        if (mask != ALL_EQUAL) {
+            return i + static_cast<size_t>(Ctz(~mask));
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(lhs + i), vld1q_u8(rhs + i))) == 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (lhs[i] != rhs[i]) {
+            return i;
+        }
+    }
+    return length;
+}
+
+inline size_t FindMismatch(const uint16_t *lhs, const uint16_t *rhs, size_t length)
+{
+    size_t i = 0;
+    constexpr size_t STEP = VECTOR_SIZE / sizeof(uint16_t);
+#if defined(__SSE2__)
+    constexpr uint32_t ALL_EQUAL = 0xffffU;
+    for (; i + STEP <= length; i += STEP) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(l, r)));
+        if (mask != ALL_EQUAL) {
+            return i + static_cast<size_t>(Ctz(~mask)) / sizeof(uint16_t);
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + STEP <= length; i += STEP) {
+        if (vminvq_u16(vceqq_u16(vld1q_u16(lhs + i), vld1q_u16(rhs + i))) == 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (lhs[i] != rhs[i]) {
+            return i;
+        }
+    }
+    return length;
+}
+
+inline size_t FindMismatch(const uint8_t *lhs, const uint16_t *rhs, size_t length)
+{
+    size_t i = 0;
+    constexpr size_t STEP = VECTOR_SIZE / sizeof(uint16_t);
+#if defined(__SSE2__)
+    constexpr uint32_t ALL_EQUAL = 0xffffU;
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + STEP <= length; i += STEP) {
+        __m128i l = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(lhs + i)), zero);
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(l, r)));
+        if (mask != ALL_EQUAL) {
+            return i + static_cast<size_t>(Ctz(~mask)) / sizeof(uint16_t);
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + STEP <= length; i += STEP) {
+        if (vminvq_u16(vceqq_u16(vmovl_u8(vld1_u8(lhs + i)), vld1q_u16(rhs + i))) == 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (lhs[i] != rhs[i]) {
+            return i;
+        }
+    }
+    return length;
+}
+
+inline size_t FindMismatch(const uint16_t *lhs, const uint8_t *rhs, size_t length)
+{
+    return FindMismatch(rhs, lhs, length);
+}
+
+/**
+ * \brief Find the first occurrence of the character
+ * @return index of the character or length if it is not found
+ */
+inline size_t FindChar(const uint8_t *data, size_t length, uint16_t c)
+{
+    if (c > UINT8_MAX) {
+        return length;
+    }
+    // memchr is vectorized by the C library
+    const void *found = std::memchr(data, c, length);
+    return found == nullptr ? length : static_cast<size_t>(static_cast<const uint8_t *>(found) - data);
+}
+
+inline size_t FindChar(const uint16_t *data, size_t length, uint16_t c)
+{
+    size_t i = 0;
+    constexpr size_t STEP = VECTOR_SIZE / sizeof(uint16_t);
+#if defined(__SSE2__)
+    const __m128i pattern = _mm_set1_epi16(static_cast<int16_t>(c));
+    for (; i + STEP <= length; i += STEP) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(v, pattern)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(Ctz(mask)) / sizeof(uint16_t);
+        }
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    const uint16x8_t pattern = vdupq_n_u16(c);
+    for (; i + STEP <= length; i += STEP) {
+        if (vmaxvq_u16(vceqq_u16(vld1q_u16(data + i), pattern)) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < length; i++) {
+        if (data[i] == c) {
+            return i;
+        }
+    }
+    return length;
+}
+
+/**
+ * \brief Zero-extend one-byte characters to UTF-16
+ */
+inline void Widen(const uint8_t *from, uint16_t *to, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + i + VECTOR_SIZE / 2U), _mm_unpackhi_epi8(v, zero));
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        uint8x16_t v = vld1q_u8(from + i);
+        vst1q_u16(to + i, vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(to + i + VECTOR_SIZE / 2U, vmovl_high_u8(v));
+    }
+#endif
+    for (; i < length; i++) {
+        to[i] = from[i];
+    }
+}
+
+/**
+ * \brief Store low bytes of UTF-16 characters, the caller checks that high bytes are zero
+ */
+inline void Narrow(const uint16_t *from, uint8_t *to, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i low_bytes = _mm_set1_epi16(UINT8_MAX);
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        __m128i lo = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i)), low_bytes);
+        __m128i hi = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i + VECTOR_SIZE / 2U)),
+                                   low_bytes);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE) {
+        uint8x8_t lo = vmovn_u16(vld1q_u16(from + i));
+        uint8x8_t hi = vmovn_u16(vld1q_u16(from + i + VECTOR_SIZE / 2U));
+        vst1q_u8(to + i, vcombine_u8(lo, hi));
+    }
+#endif
+    for (; i < length; i++) {
+        to[i] = static_cast<uint8_t>(from[i]);
+    }
+}
+
+/**
+ * \brief Continue the Java-compatible hash h = 31 * h + c over the characters
+ * Blocks of 8 characters are folded as h * 31^8 + c0 * 31^7 + ... + c7, the sum of products doesn't depend on h,
+ * so it is computed in vector registers and only one scalar multiplication per block is on the critical path.
+ */
+template <class T>
+inline uint32_t HashCode(uint32_t hash, const T *data, size_t length)
+{
+    static_assert(sizeof(T) <= sizeof(uint16_t));
+    constexpr uint32_t MULTIPLIER = 31;
+    constexpr size_t BLOCK_SIZE = 8;
+    size_t i = 0;
+#if defined(__SSE2__) || defined(PANDA_STRING_KERNELS_NEON)
+    // Multipliers of the characters of a block, 31^7 for the first one and 1 for the last one
+    constexpr auto POWERS = [] {
+        std::array<uint32_t, BLOCK_SIZE + 1> powers {};
+        powers[BLOCK_SIZE] = 1;
+        for (size_t j = BLOCK_SIZE; j > 0; j--) {
+            powers[j - 1] = powers[j] * MULTIPLIER;
+        }
+        return powers;
+    }();
+    constexpr uint32_t BLOCK_MULTIPLIER = POWERS[0];
+#endif
+#if defined(__SSE2__)
+    // SSE2 has no 32-bit multiplication, products of 16-bit characters and 32-bit powers are built from
+    // 16-bit multiplications: c * p = c * p_lo + ((c * p_hi) << 16) modulo 2^32
+    const __m128i powers_lo = _mm_setr_epi16(
+        static_cast<int16_t>(POWERS[1]), static_cast<int16_t>(POWERS[2]), static_cast<int16_t>(POWERS[3]),
+        static_cast<int16_t>(POWERS[4]), static_cast<int16_t>(POWERS[5]), static_cast<int16_t>(POWERS[6]),
+        static_cast<int16_t>(POWERS[7]), static_cast<int16_t>(POWERS[8]));
+    const __m128i powers_hi = _mm_setr_epi16(
+        static_cast<int16_t>(POWERS[1] >> 16U), static_cast<int16_t>(POWERS[2] >> 16U),
+        static_cast<int16_t>(POWERS[3] >> 16U), static_cast<int16_t>(POWERS[4] >> 16U),
+        static_cast<int16_t>(POWERS[5] >> 16U), static_cast<int16_t>(POWERS[6] >> 16U),
+        static_cast<int16_t>(POWERS[7] >> 16U), static_cast<int16_t>(POWERS[8] >> 16U));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + BLOCK_SIZE <= length; i += BLOCK_SIZE) {
+        __m128i chars;
+        if constexpr (sizeof(T) == sizeof(uint8_t)) {
+            chars = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data + i)), zero);
+        } else {
+            chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        }
+        __m128i lo = _mm_mullo_epi16(chars, powers_lo);
+        __m128i hi = _mm_mulhi_epu16(chars, powers_lo);
+        __m128i cross = _mm_mullo_epi16(chars, powers_hi);
+        __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpacklo_epi16(zero, cross)),
+                                    _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), _mm_unpackhi_epi16(zero, cross)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1U, 0U, 3U, 2U)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2U, 3U, 0U, 1U)));
+        hash = hash * BLOCK_MULTIPLIER + static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+    }
+#elif defined(PANDA_STRING_KERNELS_NEON)
+    const uint32x4_t powers_lo = vld1q_u32(&POWERS[1]);
+    const uint32x4_t powers_hi = vld1q_u32(&POWERS[1U + BLOCK_SIZE / 2U]);
+    for (; i + BLOCK_SIZE <= length; i += BLOCK_SIZE) {
+        uint16x8_t chars;
+        if constexpr (sizeof(T) == sizeof(uint8_t)) {
+            chars = vmovl_u8(vld1_u8(data + i));
+        } else {
+            chars = vld1q_u16(data + i);
+        }
+        uint32x4_t sum = vmulq_u32(vmovl_u16(vget_low_u16(chars)), powers_lo);
+        sum = vmlaq_u32(sum, vmovl_high_u16(chars), powers_hi);
+        hash = hash * BLOCK_MULTIPLIER + vaddvq_u32(sum);
+    }
+#endif
+    for (; i < length; i++) {
+        hash = hash * MULTIPLIER + data[i];
+    }
+    return hash;
+}
+
+}  // namespace panda::string_kernels
+
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-type-reinterpret-cast)
+
+#endif  // PANDA_LIBPANDABASE_UTILS_STRING_KERNELS_H_
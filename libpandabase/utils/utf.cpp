@@ -14,7 +14,9 @@
  */
 
 #include "utf.h"
+#include "string_kernels.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 
@@ -144,13 +146,9 @@ constexpr MUtf8Char ConvertUtf16ToMUtf8(uint16_t d0, uint16_t d1)
 
 bool IsMUtf8OnlySingleBytes(const uint8_t *mutf8_in)
 {
-    while (*mutf8_in != '\0') {    // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        if (*mutf8_in >= MASK1) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            return false;
-        }
-        mutf8_in += 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    }
-    return true;
+    // strlen and the check of the bytes are both vectorized, it is faster than one scalar pass
+    size_t mutf8_len = Mutf8Size(mutf8_in);
+    return string_kernels::CountSingleBytes(mutf8_in, mutf8_len) == mutf8_len;
 }
 
 size_t ConvertRegionUtf16ToMUtf8(const uint16_t *utf16_in, uint8_t *mutf8_out, size_t utf16_len, size_t mutf8_len,
@@ -162,6 +160,17 @@ size_t ConvertRegionUtf16ToMUtf8(const uint16_t *utf16_in, uint8_t *mutf8_out, s
     }
     size_t end = start + utf16_len;
     for (size_t i = start; i < end; ++i) {
+        // ASCII characters are narrowed by vectors
+        const uint16_t *ascii_in = &utf16_in[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size_t ascii_num = string_kernels::CountAscii(ascii_in, std::min(end - i, mutf8_len - mutf8_pos));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        string_kernels::Narrow(ascii_in, &mutf8_out[mutf8_pos], ascii_num);
+        i += ascii_num;
+        mutf8_pos += ascii_num;
+        if (i == end) {
+            break;
+        }
+
         // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
         uint16_t next16Code = (i + 1) != end && IsAvailableNextUtf16Code(utf16_in[i + 1]) ? utf16_in[i + 1] : 0;
         // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
@@ -183,6 +192,16 @@ void ConvertMUtf8ToUtf16(const uint8_t *mutf8_in, size_t mutf8_len, uint16_t *ut
 {
     size_t in_pos = 0;
     while (in_pos < mutf8_len) {
+        if (*mutf8_in < MASK1) {
+            // One-byte characters are widened by vectors
+            size_t single_bytes = string_kernels::CountSingleBytes(mutf8_in, mutf8_len - in_pos);
+            string_kernels::Widen(mutf8_in, utf16_out, single_bytes);
+            mutf8_in += single_bytes;   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            utf16_out += single_bytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            in_pos += single_bytes;
+            continue;
+        }
+
         auto [pair, nbytes] = ConvertMUtf8ToUtf16Pair(mutf8_in, mutf8_len - in_pos);
         auto [p_hi, p_lo] = SplitUtf16Pair(pair);
 
@@ -202,6 +221,25 @@ size_t ConvertRegionMUtf8ToUtf16(const uint8_t *mutf8_in, uint16_t *utf16_out, s
     size_t in_pos = 0;
     size_t out_pos = 0;
     while (in_pos < mutf8_len) {
+        if (*mutf8_in < MASK1) {
+            // One-byte characters are skipped or widened by vectors
+            size_t single_bytes = string_kernels::CountSingleBytes(mutf8_in, mutf8_len - in_pos);
+            size_t skipped = std::min(single_bytes, start);
+            start -= skipped;
+            size_t copied = std::min(single_bytes - skipped, utf16_len - out_pos);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            string_kernels::Widen(mutf8_in + skipped, utf16_out, copied);
+            mutf8_in += skipped + copied;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            utf16_out += copied;           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            in_pos += skipped + copied;
+            out_pos += copied;
+            if (skipped + copied < single_bytes) {
+                // No place for the next character
+                break;
+            }
+            continue;
+        }
+
         auto [pair, nbytes] = ConvertMUtf8ToUtf16Pair(mutf8_in, mutf8_len - in_pos);
         auto [p_hi, p_lo] = SplitUtf16Pair(pair);
 
@@ -323,13 +361,7 @@ size_t Mutf8Size(const uint8_t *mutf8)
 
 size_t MUtf8ToUtf16Size(const uint8_t *mutf8)
 {
-    size_t res = 0;
-    while (*mutf8 != '\0') {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        auto [pair, nbytes] = ConvertMUtf8ToUtf16Pair(mutf8);
-        res += pair > MAX_U16 ? CONST_2 : 1;
-        mutf8 += nbytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    }
-    return res;
+    return MUtf8ToUtf16Size(mutf8, Mutf8Size(mutf8));
 }
 
 size_t MUtf8ToUtf16Size(const uint8_t *mutf8, size_t mutf8_len)
@@ -337,6 +369,13 @@ size_t MUtf8ToUtf16Size(const uint8_t *mutf8, size_t mutf8_len)
     size_t pos = 0;
     size_t res = 0;
     while (pos != mutf8_len) {
+        if (*mutf8 < MASK1) {
+            size_t single_bytes = string_kernels::CountSingleBytes(mutf8, mutf8_len - pos);
+            res += single_bytes;
+            mutf8 += single_bytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            pos += single_bytes;
+            continue;
+        }
         auto [pair, nbytes] = ConvertMUtf8ToUtf16Pair(mutf8, mutf8_len - pos);
         if (nbytes == 0) {
             nbytes = 1;
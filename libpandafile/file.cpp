@@ -13,15 +13,19 @@
  * limitations under the License.
  */
 
+#include "class_data_accessor-inl.h"
 #include "file_format_version.h"
 #include "file-inl.h"
 #include "os/file.h"
 #include "os/mem.h"
+#include "os/thread.h"
 #include "mem/mem.h"
+#include "method_data_accessor-inl.h"
 #include "panda_cache.h"
 
 #include "utils/hash.h"
 #include "utils/logger.h"
+#include "utils/math_helpers.h"
 #include "utils/utf.h"
 #include "utils/span.h"
 #include "zip_archive.h"
@@ -180,21 +184,150 @@ std::unique_ptr<const panda_file::File> OpenPandaFileFromZipFile(ZipArchiveHandl
     return panda_file::File::OpenFromMemory(std::move(ConstPtr), location);
 }
 
+static std::string &GetExtractionCacheDir()
+{
+    static std::string cache_dir;
+    return cache_dir;
+}
+
+void SetExtractionCacheDir(std::string_view cache_dir)
+{
+    GetExtractionCacheDir() = cache_dir;
+}
+
+// The archive path and entry name select the entry, CRC and size make a stale cached file unreachable
+static std::string GetExtractionCachePath(std::string_view location, std::string_view archive_name,
+                                          const EntryFileStat &entry)
+{
+    auto absolute_path = os::file::File::GetAbsolutePath(location);
+    std::string entry_path = absolute_path ? absolute_path.Value() : std::string(location);
+    entry_path.append(ARCHIVE_SPLIT).append(archive_name);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    uint32_t hash = GetHash32(reinterpret_cast<const uint8_t *>(entry_path.data()), entry_path.size());
+
+    std::stringstream ss;
+    ss << GetExtractionCacheDir() << "/" << std::hex << hash << "-" << entry.GetCrc() << "-" << std::dec
+       << entry.GetUncompressedSize() << ".abc";
+    return ss.str();
+}
+
+static std::unique_ptr<const panda_file::File> OpenExtractedPandaFile(const std::string &cache_path,
+                                                                      std::string_view location,
+                                                                      const EntryFileStat &entry,
+                                                                      panda_file::File::OpenMode open_mode)
+{
+    size_t size = entry.GetUncompressedSize();
+    os::file::File file = os::file::Open(cache_path, os::file::Mode::READONLY);
+    if (!file.IsValid()) {
+        return nullptr;
+    }
+    os::file::FileHolder fh_holder(file);
+    auto file_size = file.GetFileSize();
+    if (!file_size || file_size.Value() != size) {
+        LOG(WARNING, PANDAFILE) << "Ignore invalid extracted panda file " << cache_path;
+        return nullptr;
+    }
+    // Pages of the private mapping are shared with the page cache until they are written
+    os::mem::ConstBytePtr ptr = os::mem::MapFile(file, GetProt(open_mode), os::mem::MMAP_FLAG_PRIVATE, size).ToConst();
+    if (ptr.Get() == nullptr) {
+        PLOG(ERROR, PANDAFILE) << "Failed to map extracted panda file " << cache_path;
+        return nullptr;
+    }
+    // The name and the size of the cached file don't prove its content, so it is checked every time the file is mapped
+    if (CalculateCrc32(ptr.Get(), size) != entry.GetCrc()) {
+        LOG(WARNING, PANDAFILE) << "Ignore extracted panda file with wrong CRC " << cache_path;
+        return nullptr;
+    }
+    if (!CheckHeader(ptr, location)) {
+        return nullptr;
+    }
+    LOG(INFO, PANDAFILE) << "Panda file from " << location << " is mapped from the extraction cache " << cache_path;
+    auto pf = panda_file::File::OpenFromMemory(std::move(ptr), location);
+    if (pf != nullptr) {
+        pf->PrefetchIndexes();
+    }
+    return pf;
+}
+
+static bool ExtractPandaFile(ZipArchiveHandle &handle, const EntryFileStat &entry, const std::string &cache_path)
+{
+    size_t size = entry.GetUncompressedSize();
+    size_t size_to_mmap = AlignUp(size, panda::os::mem::GetPageSize());
+    void *mem = os::mem::MapRWAnonymousRaw(size_to_mmap, false);
+    if (mem == nullptr) {
+        LOG(ERROR, PANDAFILE) << "Can't mmap anonymous!";
+        return false;
+    }
+    os::mem::BytePtr ptr(reinterpret_cast<std::byte *>(mem), size_to_mmap, os::mem::MmapDeleter);
+    if (ExtractToMemory(handle, reinterpret_cast<uint8_t *>(ptr.Get()), size_to_mmap) != 0) {
+        LOG(ERROR, PANDAFILE) << "Can't extract!";
+        return false;
+    }
+
+    // Write to a private file and rename it, so concurrent processes and threads never see a partially written file.
+    // A file with the same name may be left only by a crashed process, it is replaced
+    std::string tmp_path = cache_path + "." + std::to_string(os::thread::GetPid()) + "-" +
+                           std::to_string(os::thread::GetCurrentThreadId()) + ".tmp";
+    std::remove(tmp_path.c_str());
+    os::file::File file = os::file::Open(tmp_path, os::file::Mode::WRITEONLYEXCLUSIVE);
+    if (!file.IsValid()) {
+        PLOG(WARNING, PANDAFILE) << "Can't create extracted panda file " << tmp_path;
+        return false;
+    }
+    bool written = file.WriteAll(ptr.Get(), size);
+    file.Close();
+    if (!written || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+        PLOG(WARNING, PANDAFILE) << "Can't write extracted panda file " << cache_path;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// NOLINTNEXTLINE(google-runtime-references)
+static std::unique_ptr<const panda_file::File> OpenPandaFileFromExtractionCache(ZipArchiveHandle &handle,
+                                                                                std::string_view location,
+                                                                                const EntryFileStat &entry,
+                                                                                std::string_view archive_name,
+                                                                                panda_file::File::OpenMode open_mode)
+{
+    std::string cache_path = GetExtractionCachePath(location, archive_name, entry);
+    auto file = OpenExtractedPandaFile(cache_path, location, entry, open_mode);
+    if (file != nullptr) {
+        return file;
+    }
+    if (!ExtractPandaFile(handle, entry, cache_path)) {
+        return nullptr;
+    }
+    return OpenExtractedPandaFile(cache_path, location, entry, open_mode);
+}
+
 // NOLINTNEXTLINE(google-runtime-references)
 std::unique_ptr<const panda_file::File> HandleArchive(ZipArchiveHandle &handle, FILE *fp, std::string_view location,
                                                       EntryFileStat &entry, std::string_view archive_filename,
                                                       panda_file::File::OpenMode open_mode)
 {
-    std::unique_ptr<const panda_file::File> file;
-    // compressed or not 4 aligned, use anonymous memory
-    if (entry.IsCompressed() || (entry.GetOffset() & 0x3U) != 0) {
-        file = OpenPandaFileFromZipFile(handle, location, entry, archive_filename);
-    } else {
+    // stored and 4 bytes aligned, map the entry directly from the archive
+    if (!entry.IsCompressed() && (entry.GetOffset() & 0x3U) == 0) {
         LOG(INFO, PANDAFILE) << "Pandafile is uncompressed and 4 bytes aligned";
-        file = panda_file::File::OpenUncompressedArchive(fileno(fp), location, entry.GetUncompressedSize(),
+        return panda_file::File::OpenUncompressedArchive(fileno(fp), location, entry.GetUncompressedSize(),
                                                          entry.GetOffset(), open_mode);
     }
-    return file;
+    // compressed or not 4 aligned, map the extracted file from the cache if it is enabled
+    if (!GetExtractionCacheDir().empty()) {
+        auto file = OpenPandaFileFromExtractionCache(handle, location, entry, archive_filename, open_mode);
+        if (file != nullptr) {
+            return file;
+        }
+        // The entry may be partially read, restart it for the extraction into anonymous memory
+        CloseCurrentFile(handle);
+        if (OpenCurrentFile(handle) != ZIPARCHIVE_OK) {
+            LOG(ERROR, PANDAFILE) << "Can't OpenCurrentFile!";
+            return nullptr;
+        }
+    }
+    // otherwise use anonymous memory
+    return OpenPandaFileFromZipFile(handle, location, entry, archive_filename);
 }
 
 // CODECHECK-NOLINTNEXTLINE(C_RULE_ID_FUNCTION_SIZE)
@@ -419,16 +552,98 @@ File::File(std::string filename, os::mem::ConstBytePtr &&base)
     : FILENAME(std::move(filename)),
       FILENAME_HASH(CalcFilenameHash(FILENAME)),
       base_(std::forward<os::mem::ConstBytePtr>(base)),
-      panda_cache_(std::make_unique<PandaCache>()),
+      panda_cache_(CreatePandaCache()),
       UNIQ_ID(GetHash32(reinterpret_cast<const uint8_t *>(GetHeader()), sizeof(Header) / 2U))
 {
 }
 
+std::unique_ptr<PandaCache> File::CreatePandaCache() const
+{
+    const Header *header = GetHeader();
+    size_t size = std::min<size_t>(header->file_size, base_.GetSize());
+    // The file is not validated yet, so the index headers are checked to lie inside of it
+    if (header->index_section_off >= size ||
+        header->num_indexes > (size - header->index_section_off) / sizeof(IndexHeader)) {
+        return std::make_unique<PandaCache>();
+    }
+    // Ids referenced from different index regions may be the same, so the sums are upper bounds
+    size_t methods_num = 0;
+    size_t fields_num = 0;
+    size_t classes_num = header->num_classes;
+    for (const auto &index_header : GetIndexHeaders()) {
+        methods_num += index_header.method_idx_size;
+        fields_num += index_header.field_idx_size;
+        classes_num += index_header.class_idx_size;
+    }
+    return std::make_unique<PandaCache>(methods_num, fields_num, classes_num);
+}
+
 File::~File()
 {
     AnonMemSet::GetInstance().Remove(FILENAME);
 }
 
+void File::AdviseAccess(os::mem::AccessPattern pattern) const
+{
+    os::mem::AdviseAccess(base_.Get(), base_.GetSize(), pattern);
+}
+
+void File::PrefetchIndexes() const
+{
+    const Header *header = GetHeader();
+    size_t size = std::min<size_t>(header->file_size, base_.GetSize());
+    // Offsets are not validated yet, a broken file must not make us touch memory out of the mapping
+    auto prefetch = [this, size](uint32_t offset, size_t length) {
+        if (offset < size && length <= size - offset) {
+            os::mem::AdviseAccess(GetBase() + offset, length, os::mem::AccessPattern::WILL_NEED);
+            return true;
+        }
+        return false;
+    };
+
+    prefetch(0, sizeof(Header));
+    prefetch(header->class_idx_off, header->num_classes * sizeof(uint32_t));
+    prefetch(header->literalarray_idx_off, header->num_literalarrays * sizeof(uint32_t));
+    if (!prefetch(header->index_section_off, header->num_indexes * sizeof(IndexHeader))) {
+        return;
+    }
+    for (const auto &index_header : GetIndexHeaders()) {
+        prefetch(index_header.class_idx_off, index_header.class_idx_size * EntityId::GetSize());
+        prefetch(index_header.method_idx_off, index_header.method_idx_size * EntityId::GetSize());
+        prefetch(index_header.field_idx_off, index_header.field_idx_size * EntityId::GetSize());
+        prefetch(index_header.proto_idx_off, index_header.proto_idx_size * EntityId::GetSize());
+    }
+}
+
+std::vector<uint32_t> File::GetResidentPages() const
+{
+    std::vector<uint32_t> offsets;
+    for (uintptr_t page : os::mem::GetResidentPages(base_.Get(), base_.GetSize())) {
+        // The first page may start before the file data if the file is mapped from an archive
+        uintptr_t base = ToUintPtr(base_.Get());
+        offsets.push_back(page > base ? page - base : 0);
+    }
+    return offsets;
+}
+
+void File::PrefetchPages(const std::vector<uint32_t> &offsets) const
+{
+    size_t page_size = os::mem::GetPageSize();
+    // Merge adjacent pages to advise the os with fewer calls
+    size_t i = 0;
+    while (i < offsets.size()) {
+        uint32_t begin = offsets[i];
+        uint32_t end = begin;
+        while (++i < offsets.size() && offsets[i] > end && offsets[i] - end <= page_size) {
+            end = offsets[i];
+        }
+        if (begin < base_.GetSize()) {
+            size_t length = std::min<size_t>(end - begin + page_size, base_.GetSize() - begin);
+            os::mem::AdviseAccess(GetBase() + begin, length, os::mem::AccessPattern::WILL_NEED);
+        }
+    }
+}
+
 inline std::string VersionToString(const std::array<uint8_t, File::VERSION_SIZE> &array)
 {
     std::stringstream ss;
@@ -503,7 +718,9 @@ std::unique_ptr<const File> File::Open(std::string_view filename, OpenMode open_
     }
 
     // CODECHECK-NOLINTNEXTLINE(CPP_RULE_ID_SMARTPOINTER_INSTEADOF_ORIGINPOINTER, CPP_RULE_ID_NO_USE_NEW_UNIQUE_PTR)
-    return std::unique_ptr<File>(new File(filename.data(), std::move(ptr)));
+    auto pf = std::unique_ptr<File>(new File(filename.data(), std::move(ptr)));
+    pf->PrefetchIndexes();
+    return pf;
 }
 
 std::unique_ptr<const File> File::OpenUncompressedArchive(int fd, const std::string_view &filename, size_t size,
@@ -533,7 +750,9 @@ std::unique_ptr<const File> File::OpenUncompressedArchive(int fd, const std::str
     }
 
     // CODECHECK-NOLINTNEXTLINE(CPP_RULE_ID_SMARTPOINTER_INSTEADOF_ORIGINPOINTER, CPP_RULE_ID_NO_USE_NEW_UNIQUE_PTR)
-    return std::unique_ptr<File>(new File(filename.data(), std::move(ptr)));
+    auto pf = std::unique_ptr<File>(new File(filename.data(), std::move(ptr)));
+    pf->PrefetchIndexes();
+    return pf;
 }
 
 bool CheckHeader(const os::mem::ConstBytePtr &ptr, const std::string_view &filename)
@@ -590,6 +809,125 @@ std::unique_ptr<const File> File::OpenFromMemory(os::mem::ConstBytePtr &&ptr, st
 }
 
 File::EntityId File::GetClassId(const uint8_t *mutf8_name) const
+{
+    if (GetHeader()->num_classes < CLASS_HASH_INDEX_MIN_CLASSES) {
+        return GetClassIdFromSortedIndex(mutf8_name);
+    }
+
+    const auto &hash_index = GetClassHashIndex();
+    uint32_t hash = GetHash32String(mutf8_name);
+    size_t mask = hash_index.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const auto &entry = hash_index[i];
+        if (entry.class_offset == 0) {
+            return EntityId();
+        }
+        if (entry.hash == hash && utf::IsEqual(mutf8_name, GetStringData(EntityId(entry.class_offset)).data)) {
+            return EntityId(entry.class_offset);
+        }
+    }
+}
+
+const std::vector<File::ClassHashIndexEntry> &File::GetClassHashIndex() const
+{
+    if (class_hash_index_ready_.load(std::memory_order_acquire)) {
+        return class_hash_index_;
+    }
+    os::memory::LockHolder lock(class_hash_index_lock_);
+    if (class_hash_index_ready_.load(std::memory_order_relaxed)) {
+        return class_hash_index_;
+    }
+    trace::ScopedTrace scoped_trace("Build class hash index for " + FILENAME);
+    auto class_idx = GetClasses();
+    // Keep the load factor not greater than 1/2, so probe sequences stay short and there is always an empty entry
+    size_t capacity = 2U * panda::helpers::math::GetPowerOfTwoValue32(class_idx.size());
+    std::vector<ClassHashIndexEntry> hash_index(capacity, {0, 0});
+    size_t mask = capacity - 1;
+    for (uint32_t class_offset : class_idx) {
+        uint32_t hash = GetHash32String(GetStringData(EntityId(class_offset)).data);
+        size_t i = hash & mask;
+        while (hash_index[i].class_offset != 0) {
+            i = (i + 1) & mask;
+        }
+        hash_index[i] = {hash, class_offset};
+    }
+    class_hash_index_ = std::move(hash_index);
+    class_hash_index_ready_.store(true, std::memory_order_release);
+    return class_hash_index_;
+}
+
+static uint32_t GetMethodOffsetHash(uint32_t method_offset)
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return GetHash32(reinterpret_cast<const uint8_t *>(&method_offset), sizeof(method_offset));
+}
+
+const File::MethodOffsets *File::GetMethodOffsets(EntityId method_id) const
+{
+    if (!method_offsets_ready_.load(std::memory_order_acquire)) {
+        BuildMethodOffsets();
+    }
+    return LookupMethodOffsets(method_id);
+}
+
+const File::MethodOffsets *File::FindMethodOffsets(EntityId method_id) const
+{
+    // Accessors used to build the table get here as well and skip the data as usual
+    if (!method_offsets_ready_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return LookupMethodOffsets(method_id);
+}
+
+const File::MethodOffsets *File::LookupMethodOffsets(EntityId method_id) const
+{
+    size_t mask = method_offsets_.size() - 1;
+    for (size_t i = GetMethodOffsetHash(method_id.GetOffset()) & mask;; i = (i + 1) & mask) {
+        const auto &entry = method_offsets_[i];
+        if (entry.method_offset == 0) {
+            return nullptr;
+        }
+        if (entry.method_offset == method_id.GetOffset()) {
+            return &entry.offsets;
+        }
+    }
+}
+
+void File::BuildMethodOffsets() const
+{
+    os::memory::LockHolder lock(method_offsets_lock_);
+    if (method_offsets_ready_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    trace::ScopedTrace scoped_trace("Build method offsets for " + FILENAME);
+    std::vector<MethodOffsetsEntry> methods;
+    for (uint32_t class_offset : GetClasses()) {
+        EntityId class_id(class_offset);
+        if (IsExternal(class_id)) {
+            continue;
+        }
+        ClassDataAccessor cda(*this, class_id);
+        cda.EnumerateMethods([&methods](MethodDataAccessor &mda) {
+            methods.push_back({mda.GetMethodId().GetOffset(), mda.GetOffsets()});
+        });
+    }
+
+    // Keep the load factor not greater than 1/2, so probe sequences stay short and there is always an empty entry
+    size_t capacity = 2U * panda::helpers::math::GetPowerOfTwoValue32(methods.size());
+    std::vector<MethodOffsetsEntry> hash_table(capacity, {0, {0, 0, 0}});
+    size_t mask = capacity - 1;
+    for (const auto &method : methods) {
+        size_t i = GetMethodOffsetHash(method.method_offset) & mask;
+        while (hash_table[i].method_offset != 0) {
+            i = (i + 1) & mask;
+        }
+        hash_table[i] = method;
+    }
+    method_offsets_ = std::move(hash_table);
+    method_offsets_ready_.store(true, std::memory_order_release);
+}
+
+File::EntityId File::GetClassIdFromSortedIndex(const uint8_t *mutf8_name) const
 {
     auto class_idx = GetClasses();
 
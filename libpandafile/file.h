@@ -17,16 +17,19 @@
 #define PANDA_LIBPANDAFILE_FILE_H_
 
 #include "os/mem.h"
+#include "os/mutex.h"
 #include "utils/span.h"
 #include "utils/utf.h"
 
 #include <cstdint>
 
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace panda {
 struct EntryFileStat;
@@ -123,11 +126,29 @@ public:
 
     enum OpenMode { READ_ONLY, READ_WRITE, WRITE_ONLY };
 
+    // Positions of the method data which are otherwise found by skipping the preceding tagged values
+    struct MethodOffsets {
+        uint32_t debug_info;   // offset of the DEBUG_INFO tagged value
+        uint32_t annotations;  // offset of the ANNOTATION tagged values
+        uint32_t size;         // size of the method data
+    };
+
     StringData GetStringData(EntityId id) const;
     EntityId GetLiteralArraysId() const;
 
     EntityId GetClassId(const uint8_t *mutf8_name) const;
 
+    /**
+     * \brief Get positions of the method data, the table of positions of all methods is built on the first call
+     * @return nullptr if the method is not defined in the file
+     */
+    const MethodOffsets *GetMethodOffsets(EntityId method_id) const;
+
+    /**
+     * \brief The same as GetMethodOffsets, but returns nullptr until the table is built
+     */
+    const MethodOffsets *FindMethodOffsets(EntityId method_id) const;
+
     const Header *GetHeader() const
     {
         return reinterpret_cast<const Header *>(GetBase());
@@ -143,6 +164,27 @@ public:
         return base_;
     }
 
+    /**
+     * \brief Advise os how the file data is going to be accessed, see os::mem::AdviseAccess
+     */
+    void AdviseAccess(os::mem::AccessPattern pattern) const;
+
+    /**
+     * \brief Start reading the header and the indexes of the file ahead, every lookup in the file goes through them
+     */
+    void PrefetchIndexes() const;
+
+    /**
+     * \brief Get offsets of the file pages resident in memory
+     */
+    std::vector<uint32_t> GetResidentPages() const;
+
+    /**
+     * \brief Start reading the file pages at the offsets ahead
+     * @param offsets - sorted offsets of the pages, e.g. recorded by GetResidentPages on a previous run
+     */
+    void PrefetchPages(const std::vector<uint32_t> &offsets) const;
+
     bool IsExternal(EntityId id) const
     {
         const Header *header = GetHeader();
@@ -314,13 +356,42 @@ public:
     NO_MOVE_SEMANTIC(File);
 
 private:
+    // Files with fewer classes are searched with the binary search over the class index
+    static constexpr size_t CLASS_HASH_INDEX_MIN_CLASSES = 16;
+
+    struct ClassHashIndexEntry {
+        uint32_t hash;
+        uint32_t class_offset;  // 0 marks an empty entry
+    };
+
     File(std::string filename, os::mem::ConstBytePtr &&base);
 
+    struct MethodOffsetsEntry {
+        uint32_t method_offset;  // 0 marks an empty entry
+        MethodOffsets offsets;
+    };
+
+    std::unique_ptr<PandaCache> CreatePandaCache() const;
+    EntityId GetClassIdFromSortedIndex(const uint8_t *mutf8_name) const;
+    const std::vector<ClassHashIndexEntry> &GetClassHashIndex() const;
+    void BuildMethodOffsets() const;
+    const MethodOffsets *LookupMethodOffsets(EntityId method_id) const;
+
     const std::string FILENAME;
     const uint32_t FILENAME_HASH;
     os::mem::ConstBytePtr base_;
     std::unique_ptr<PandaCache> panda_cache_;
     const uint64_t UNIQ_ID;
+
+    // Open addressing hash table over the class index, it is built on the first lookup
+    mutable os::memory::Mutex class_hash_index_lock_;
+    mutable std::atomic_bool class_hash_index_ready_ {false};
+    mutable std::vector<ClassHashIndexEntry> class_hash_index_;
+
+    // Open addressing hash table over the methods defined in the file, it is built on the first GetMethodOffsets
+    mutable os::memory::Mutex method_offsets_lock_;
+    mutable std::atomic_bool method_offsets_ready_ {false};
+    mutable std::vector<MethodOffsetsEntry> method_offsets_;
 };
 
 inline bool operator==(const File::StringData &string_data1, const File::StringData &string_data2)
@@ -343,6 +414,13 @@ inline bool operator!=(const File::StringData &string_data1, const File::StringD
 std::unique_ptr<const File> OpenPandaFileOrZip(std::string_view location,
                                                panda_file::File::OpenMode open_mode = panda_file::File::READ_ONLY);
 
+/*
+ * Set the directory where panda files compressed in zip archives are extracted to.
+ * Later opens of the same archive entry map the extracted file instead of inflating it again.
+ * Empty directory disables the cache.
+ */
+void SetExtractionCacheDir(std::string_view cache_dir);
+
 /*
  * OpenPandaFileFromMemory from file buffer.
  */
@@ -18,6 +18,8 @@
 #include "file_format_version.h"
 #include "macros.h"
 
+#include <algorithm>
+
 namespace panda::panda_file {
 
 class ItemDeduper {
@@ -397,6 +399,20 @@ void ItemContainer::DeduplicateItems()
     DeduplicateAnnotations();
 }
 
+void ItemContainer::ReorderItems(const std::vector<BaseItem *> &hot_items)
+{
+    std::unordered_map<BaseItem *, size_t> ranks;
+    for (auto *item : hot_items) {
+        ranks.emplace(item, ranks.size());
+    }
+    auto get_rank = [&ranks](const std::unique_ptr<BaseItem> &item) {
+        auto it = ranks.find(item.get());
+        return it != ranks.end() ? it->second : ranks.size();
+    };
+    std::stable_sort(items_.begin(), items_.end(),
+                     [&get_rank](const auto &lhs, const auto &rhs) { return get_rank(lhs) < get_rank(rhs); });
+}
+
 uint32_t ItemContainer::ComputeLayout()
 {
     uint32_t num_classes = class_map_.size();
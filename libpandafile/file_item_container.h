@@ -86,6 +86,13 @@ public:
         return ret;
     }
 
+    /**
+     * \brief Place the items first in the file in the given order, other items keep their relative order.
+     * Must be called before the code is emitted, because the indexes used by the code depend on the order of items.
+     * @param hot_items - items to place first, e.g. classes, code and strings of hot methods
+     */
+    void ReorderItems(const std::vector<BaseItem *> &hot_items);
+
     uint32_t ComputeLayout();
     bool Write(Writer *writer);
 
@@ -636,6 +636,11 @@ public:
         return name_;
     }
 
+    BaseClassItem *GetClassItem() const
+    {
+        return class_;
+    }
+
     ~BaseMethodItem() override = default;
 
     DEFAULT_MOVE_SEMANTIC(BaseMethodItem);
@@ -58,6 +58,31 @@ inline void MethodDataAccessor::SkipParamAnnotation()
     GetParamAnnotationId();
 }
 
+inline bool MethodDataAccessor::ApplyFileOffsets()
+{
+    if (is_external_) {
+        return false;
+    }
+
+    const File::MethodOffsets *offsets = panda_file_.FindMethodOffsets(method_id_);
+    if (offsets == nullptr) {
+        return false;
+    }
+
+    debug_sp_ = panda_file_.GetSpanFromId(File::EntityId(offsets->debug_info));
+    annotations_sp_ = panda_file_.GetSpanFromId(File::EntityId(offsets->annotations));
+    size_ = offsets->size;
+    return true;
+}
+
+inline File::MethodOffsets MethodDataAccessor::GetOffsets()
+{
+    ASSERT(!is_external_);
+    GetSize();
+    return {panda_file_.GetIdFromPointer(debug_sp_.data()).GetOffset(),
+            panda_file_.GetIdFromPointer(annotations_sp_.data()).GetOffset(), static_cast<uint32_t>(size_)};
+}
+
 inline std::optional<File::EntityId> MethodDataAccessor::GetCodeId()
 {
     if (is_external_) {
@@ -122,7 +147,7 @@ inline std::optional<File::EntityId> MethodDataAccessor::GetDebugInfoId()
         return {};
     }
 
-    if (debug_sp_.data() == nullptr) {
+    if (debug_sp_.data() == nullptr && !ApplyFileOffsets()) {
         SkipRuntimeParamAnnotation();
     }
 
@@ -136,7 +161,7 @@ inline void MethodDataAccessor::EnumerateAnnotations(Callback cb)
         return;
     }
 
-    if (annotations_sp_.data() == nullptr) {
+    if (annotations_sp_.data() == nullptr && !ApplyFileOffsets()) {
         SkipDebugInfo();
     }
 
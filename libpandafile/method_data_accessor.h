@@ -120,13 +120,18 @@ public:
 
     size_t GetSize()
     {
-        if (size_ == 0) {
+        if (size_ == 0 && !ApplyFileOffsets()) {
             SkipParamAnnotation();
         }
 
         return size_;
     }
 
+    /**
+     * \brief Get positions of the method data, they are stored in the table built by File::GetMethodOffsets
+     */
+    File::MethodOffsets GetOffsets();
+
     const File &GetPandaFile() const
     {
         return panda_file_;
@@ -143,6 +148,8 @@ public:
     uint32_t GetNumericalAnnotation(uint32_t field_id);
 
 private:
+    bool ApplyFileOffsets();
+
     void SkipCode();
 
     void SkipSourceLang();
@@ -20,6 +20,8 @@
 #include "os/mutex.h"
 #include "libpandabase/utils/math_helpers.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <vector>
 
@@ -49,141 +51,251 @@ public:
         Class *ptr_ {nullptr};
     };
 
-    PandaCache()
-        : METHOD_CACHE_SIZE(DEFAULT_METHOD_CACHE_SIZE),
-          FIELD_CACHE_SIZE(DEFAULT_FIELD_CACHE_SIZE),
-          CLASS_CACHE_SIZE(DEFAULT_CLASS_CACHE_SIZE)
+    struct Statistics {
+        uint64_t hits {0};
+        uint64_t misses {0};
+    };
+
+    PandaCache() : PandaCache(DEFAULT_METHOD_CACHE_SIZE, DEFAULT_FIELD_CACHE_SIZE, DEFAULT_CLASS_CACHE_SIZE) {}
+
+    /**
+     * \brief Create caches sized for the numbers of entities referenced from the file
+     * Sizes are rounded up to a power of two and clamped to [MIN_CACHE_SIZE, MAX_CACHE_SIZE]
+     */
+    PandaCache(size_t methods_num, size_t fields_num, size_t classes_num)
+        : method_cache_(GetCacheSize(methods_num), 0),
+          // lowest one or two bits are very likely same between different fields
+          field_cache_(GetCacheSize(fields_num), 2U),
+          class_cache_(GetCacheSize(classes_num), 0)
     {
-        method_cache_.resize(METHOD_CACHE_SIZE, MethodCachePair());
-        field_cache_.resize(FIELD_CACHE_SIZE, FieldCachePair());
-        class_cache_.resize(CLASS_CACHE_SIZE, ClassCachePair());
     }
 
     ~PandaCache() = default;
 
-    inline uint32_t GetMethodIndex(File::EntityId id) const
+    /**
+     * \brief Count hits and misses of the lookups, it must be called before the cache is used by other threads
+     */
+    void EnableStatistics()
     {
-        return panda::helpers::math::PowerOfTwoTableSlot(id.GetOffset(), METHOD_CACHE_SIZE);
+        statistics_enabled_ = true;
     }
 
-    inline uint32_t GetFieldIndex(File::EntityId id) const
+    bool IsStatisticsEnabled() const
     {
-        // lowest one or two bits are very likely same between different fields
-        return panda::helpers::math::PowerOfTwoTableSlot(id.GetOffset(), FIELD_CACHE_SIZE, 2U);
+        return statistics_enabled_;
     }
 
-    inline uint32_t GetClassIndex(File::EntityId id) const
+    inline Method *GetMethodFromCache(File::EntityId id) const
     {
-        return panda::helpers::math::PowerOfTwoTableSlot(id.GetOffset(), CLASS_CACHE_SIZE);
+        return method_cache_.Get(id, statistics_enabled_);
     }
 
-    inline Method *GetMethodFromCache([[maybe_unused]] File::EntityId id) const
+    inline void SetMethodCache(File::EntityId id, Method *method)
     {
-        uint32_t index = GetMethodIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<MethodCachePair> *>(reinterpret_cast<uintptr_t>(&(method_cache_[index])));
-        auto pair = pair_ptr->load(std::memory_order_acquire);
-        TSAN_ANNOTATE_HAPPENS_AFTER(pair_ptr);
-        if (pair.id_ == id) {
-            return pair.ptr_;
-        }
-        return nullptr;
+        method_cache_.Set(id, method);
     }
 
-    inline void SetMethodCache([[maybe_unused]] File::EntityId id, [[maybe_unused]] Method *method)
+    inline Field *GetFieldFromCache(File::EntityId id) const
     {
-        MethodCachePair pair;
-        pair.id_ = id;
-        pair.ptr_ = method;
-        uint32_t index = GetMethodIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<MethodCachePair> *>(reinterpret_cast<uintptr_t>(&(method_cache_[index])));
-        TSAN_ANNOTATE_HAPPENS_BEFORE(pair_ptr);
-        pair_ptr->store(pair, std::memory_order_release);
+        return field_cache_.Get(id, statistics_enabled_);
     }
 
-    inline Field *GetFieldFromCache([[maybe_unused]] File::EntityId id) const
+    inline void SetFieldCache(File::EntityId id, Field *field)
     {
-        uint32_t index = GetFieldIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<FieldCachePair> *>(reinterpret_cast<uintptr_t>(&(field_cache_[index])));
-        auto pair = pair_ptr->load(std::memory_order_acquire);
-        TSAN_ANNOTATE_HAPPENS_AFTER(pair_ptr);
-        if (pair.id_ == id) {
-            return pair.ptr_;
-        }
-        return nullptr;
+        field_cache_.Set(id, field);
     }
 
-    inline void SetFieldCache([[maybe_unused]] File::EntityId id, [[maybe_unused]] Field *field)
+    inline Class *GetClassFromCache(File::EntityId id) const
     {
-        uint32_t index = GetFieldIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<FieldCachePair> *>(reinterpret_cast<uintptr_t>(&(field_cache_[index])));
-        FieldCachePair pair;
-        pair.id_ = id;
-        pair.ptr_ = field;
-        TSAN_ANNOTATE_HAPPENS_BEFORE(pair_ptr);
-        pair_ptr->store(pair, std::memory_order_release);
+        return class_cache_.Get(id, statistics_enabled_);
     }
 
-    inline Class *GetClassFromCache([[maybe_unused]] File::EntityId id) const
+    inline void SetClassCache(File::EntityId id, Class *clazz)
     {
-        uint32_t index = GetClassIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<ClassCachePair> *>(reinterpret_cast<uintptr_t>(&(class_cache_[index])));
-        auto pair = pair_ptr->load(std::memory_order_acquire);
-        TSAN_ANNOTATE_HAPPENS_AFTER(pair_ptr);
-        if (pair.id_ == id) {
-            return pair.ptr_;
-        }
-        return nullptr;
+        class_cache_.Set(id, clazz);
     }
 
-    inline void SetClassCache([[maybe_unused]] File::EntityId id, [[maybe_unused]] Class *clazz)
+    template <class Callback>
+    bool EnumerateCachedClasses(const Callback &cb)
     {
-        ClassCachePair pair;
-        pair.id_ = id;
-        pair.ptr_ = clazz;
-        uint32_t index = GetClassIndex(id);
-        auto *pair_ptr =
-            reinterpret_cast<std::atomic<ClassCachePair> *>(reinterpret_cast<uintptr_t>(&(class_cache_[index])));
-        TSAN_ANNOTATE_HAPPENS_BEFORE(pair_ptr);
-        pair_ptr->store(pair, std::memory_order_release);
+        return class_cache_.Enumerate(cb);
     }
 
-    template <class Callback>
-    bool EnumerateCachedClasses([[maybe_unused]] const Callback &cb)
+    size_t GetMethodCacheSize() const
     {
-        for (uint32_t i = 0; i < CLASS_CACHE_SIZE; i++) {
-            auto *pair_ptr =
-                reinterpret_cast<std::atomic<ClassCachePair> *>(reinterpret_cast<uintptr_t>(&(class_cache_[i])));
-            auto pair = pair_ptr->load(std::memory_order_acquire);
-            TSAN_ANNOTATE_HAPPENS_AFTER(pair_ptr);
-            if (pair.ptr_ != nullptr) {
-                if (!cb(pair.ptr_)) {
-                    return false;
-                }
-            }
-        }
-        return true;
+        return method_cache_.GetSize();
+    }
+
+    size_t GetFieldCacheSize() const
+    {
+        return field_cache_.GetSize();
+    }
+
+    size_t GetClassCacheSize() const
+    {
+        return class_cache_.GetSize();
+    }
+
+    Statistics GetMethodStatistics() const
+    {
+        return method_cache_.GetStatistics();
     }
 
+    Statistics GetFieldStatistics() const
+    {
+        return field_cache_.GetStatistics();
+    }
+
+    Statistics GetClassStatistics() const
+    {
+        return class_cache_.GetStatistics();
+    }
+
+    static constexpr size_t WAYS = 4U;
+    static constexpr size_t MIN_CACHE_SIZE = 64U;
+    static constexpr size_t MAX_CACHE_SIZE = 16384U;
+
 private:
     static constexpr uint32_t DEFAULT_FIELD_CACHE_SIZE = 1024U;
     static constexpr uint32_t DEFAULT_METHOD_CACHE_SIZE = 1024U;
     static constexpr uint32_t DEFAULT_CLASS_CACHE_SIZE = 1024U;
-    static_assert(panda::helpers::math::IsPowerOfTwo(DEFAULT_FIELD_CACHE_SIZE));
-    static_assert(panda::helpers::math::IsPowerOfTwo(DEFAULT_METHOD_CACHE_SIZE));
-    static_assert(panda::helpers::math::IsPowerOfTwo(DEFAULT_CLASS_CACHE_SIZE));
+    static_assert(panda::helpers::math::IsPowerOfTwo(MIN_CACHE_SIZE));
+    static_assert(panda::helpers::math::IsPowerOfTwo(MAX_CACHE_SIZE));
+    static_assert(MIN_CACHE_SIZE % WAYS == 0);
+
+    static size_t GetCacheSize(size_t entities_num)
+    {
+        size_t size = panda::helpers::math::GetPowerOfTwoValue32(std::min(entities_num, MAX_CACHE_SIZE));
+        return std::clamp(size, MIN_CACHE_SIZE, MAX_CACHE_SIZE);
+    }
+
+    /**
+     * Set-associative table of (id, pointer) pairs. The pairs are read and written atomically,
+     * so a reader never sees a pointer of another id, but a concurrent insertion may evict an entry.
+     */
+    template <class T, class Pair>
+    class CacheTable {
+    public:
+        CacheTable(size_t size, uint32_t skipped_lowest_bits)
+            : buckets_(size / WAYS), SKIPPED_LOWEST_BITS(skipped_lowest_bits)
+        {
+        }
 
-    const uint32_t METHOD_CACHE_SIZE;
-    const uint32_t FIELD_CACHE_SIZE;
-    const uint32_t CLASS_CACHE_SIZE;
+        ~CacheTable() = default;
+
+        NO_COPY_SEMANTIC(CacheTable);
+        NO_MOVE_SEMANTIC(CacheTable);
+
+        T *Get(File::EntityId id, bool count) const
+        {
+            const Bucket &bucket = GetBucket(id);
+            for (const Pair &entry : bucket.pairs) {
+                auto pair = Load(&entry);
+                if (pair.id_ == id) {
+                    if (UNLIKELY(count)) {
+                        hits_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return pair.ptr_;
+                }
+            }
+            if (UNLIKELY(count)) {
+                misses_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return nullptr;
+        }
+
+        void Set(File::EntityId id, T *ptr)
+        {
+            Pair pair;
+            pair.id_ = id;
+            pair.ptr_ = ptr;
+            auto &pairs = GetBucket(id).pairs;
+            for (Pair &entry : pairs) {
+                if (Load(&entry).id_ == id) {
+                    Store(&entry, pair);
+                    return;
+                }
+            }
+            // New pairs are inserted first, so the last pair of a full bucket is the oldest one and it is evicted
+            for (size_t i = WAYS - 1; i > 0; i--) {
+                Store(&pairs[i], Load(&pairs[i - 1]));
+            }
+            Store(&pairs[0], pair);
+        }
+
+        template <class Callback>
+        bool Enumerate(const Callback &cb) const
+        {
+            for (const Bucket &bucket : buckets_) {
+                for (const Pair &entry : bucket.pairs) {
+                    auto pair = Load(&entry);
+                    if (pair.ptr_ != nullptr && !cb(pair.ptr_)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        size_t GetSize() const
+        {
+            return buckets_.size() * WAYS;
+        }
+
+        Statistics GetStatistics() const
+        {
+            return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+        }
+
+    private:
+        // A bucket of 4 pairs fills a cache line on 64-bit targets
+        struct alignas(WAYS * sizeof(Pair)) Bucket {
+            std::array<Pair, WAYS> pairs;
+        };
+
+        size_t GetBucketIndex(File::EntityId id) const
+        {
+            return panda::helpers::math::PowerOfTwoTableSlot(id.GetOffset(), static_cast<uint32_t>(buckets_.size()),
+                                                             SKIPPED_LOWEST_BITS);
+        }
+
+        Bucket &GetBucket(File::EntityId id)
+        {
+            return buckets_[GetBucketIndex(id)];
+        }
+
+        const Bucket &GetBucket(File::EntityId id) const
+        {
+            return buckets_[GetBucketIndex(id)];
+        }
+
+        static Pair Load(const Pair *entry)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto *pair_ptr = reinterpret_cast<const std::atomic<Pair> *>(entry);
+            auto pair = pair_ptr->load(std::memory_order_acquire);
+            TSAN_ANNOTATE_HAPPENS_AFTER(pair_ptr);
+            return pair;
+        }
+
+        static void Store(Pair *entry, Pair pair)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto *pair_ptr = reinterpret_cast<std::atomic<Pair> *>(entry);
+            TSAN_ANNOTATE_HAPPENS_BEFORE(pair_ptr);
+            pair_ptr->store(pair, std::memory_order_release);
+        }
+
+        std::vector<Bucket> buckets_;
+        const uint32_t SKIPPED_LOWEST_BITS;
+        mutable std::atomic<uint64_t> hits_ {0};
+        mutable std::atomic<uint64_t> misses_ {0};
+    };
 
-    std::vector<MethodCachePair> method_cache_;
-    std::vector<FieldCachePair> field_cache_;
-    std::vector<ClassCachePair> class_cache_;
+    CacheTable<Method, MethodCachePair> method_cache_;
+    CacheTable<Field, FieldCachePair> field_cache_;
+    CacheTable<Class, ClassCachePair> class_cache_;
+    bool statistics_enabled_ {false};
 };
 
 }  // namespace panda_file
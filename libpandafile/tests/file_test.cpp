@@ -13,9 +13,12 @@
  * limitations under the License.
  */
 
+#include "class_data_accessor-inl.h"
 #include "file-inl.h"
 #include "file_items.h"
 #include "file_item_container.h"
+#include "method_data_accessor-inl.h"
+#include "os/file.h"
 #include "utils/string_helpers.h"
 #include "zip_archive.h"
 #include "file.h"
@@ -24,10 +27,18 @@
 #include "assembly-parser.h"
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #ifdef PANDA_TARGET_MOBILE
 #include <unistd.h>
 #endif
+#ifdef PANDA_TARGET_UNIX
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
 
+#include <optional>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -136,6 +147,105 @@ TEST(File, GetClassByName)
     }
 }
 
+TEST(File, GetClassByNameWithHashIndex)
+{
+    // Enough classes to look them up with the hash index instead of the binary search
+    static constexpr size_t CLASSES_NUM = 100;
+
+    ItemContainer container;
+
+    std::vector<std::string> names;
+    std::vector<ClassItem *> classes;
+
+    for (size_t i = 0; i < CLASSES_NUM; i++) {
+        names.push_back("LClass" + std::to_string(i) + ";");
+        classes.push_back(container.GetOrCreateClassItem(names.back()));
+    }
+
+    MemoryWriter mem_writer;
+
+    ASSERT_TRUE(container.Write(&mem_writer));
+
+    // Read panda file from memory
+    auto data = mem_writer.GetData();
+    auto panda_file = GetPandaFile(&data);
+    ASSERT_NE(panda_file, nullptr);
+
+    for (size_t i = 0; i < names.size(); i++) {
+        EXPECT_EQ(panda_file->GetClassId(reinterpret_cast<const uint8_t *>(names[i].c_str())).GetOffset(),
+                  classes[i]->GetOffset());
+    }
+
+    EXPECT_FALSE(panda_file->GetClassId(reinterpret_cast<const uint8_t *>("LClass;")).IsValid());
+    EXPECT_FALSE(panda_file->GetClassId(reinterpret_cast<const uint8_t *>("LClass100;")).IsValid());
+}
+
+TEST(File, PrefetchPages)
+{
+    pandasm::Parser p;
+    auto res = p.Parse(".record R {}\n");
+    const char *filename = "__PrefetchPages__.abc";
+    ASSERT_TRUE(pandasm::AsmEmitter::Emit(filename, res.Value()));
+
+    auto pf = File::Open(filename);
+    ASSERT_NE(pf, nullptr);
+    pf->AdviseAccess(os::mem::AccessPattern::RANDOM);
+    auto pages = pf->GetResidentPages();
+#ifdef PANDA_TARGET_UNIX
+    // The header is read on open
+    ASSERT_FALSE(pages.empty());
+    EXPECT_EQ(pages[0], 0U);
+#endif
+    pf->PrefetchPages(pages);
+    pf->AdviseAccess(os::mem::AccessPattern::NORMAL);
+    EXPECT_NE(pf->GetClassId(utf::CStringAsMutf8("LR;")).GetOffset(), 0U);
+    remove(filename);
+}
+
+TEST(File, GetMethodOffsets)
+{
+    std::string source = ".record R {}\n";
+    for (size_t i = 0; i < 10; i++) {
+        source += ".function i32 R.f" + std::to_string(i) + "(i32 a0) {\n    lda a0\n    return\n}\n";
+    }
+    pandasm::Parser p;
+    auto res = p.Parse(source);
+    auto pf = pandasm::AsmEmitter::Emit(res.Value());
+    ASSERT_NE(pf, nullptr);
+
+    auto class_id = pf->GetClassId(utf::CStringAsMutf8("LR;"));
+    ASSERT_TRUE(class_id.IsValid());
+
+    // Data of the methods found by skipping
+    std::vector<File::EntityId> methods;
+    std::vector<std::optional<File::EntityId>> debug_infos;
+    std::vector<size_t> sizes;
+    ClassDataAccessor cda(*pf, class_id);
+    cda.EnumerateMethods([&](MethodDataAccessor &mda) {
+        methods.push_back(mda.GetMethodId());
+        debug_infos.push_back(mda.GetDebugInfoId());
+        sizes.push_back(mda.GetSize());
+    });
+    ASSERT_EQ(methods.size(), 10U);
+    EXPECT_EQ(pf->FindMethodOffsets(methods[0]), nullptr);
+
+    for (size_t i = 0; i < methods.size(); i++) {
+        const File::MethodOffsets *offsets = pf->GetMethodOffsets(methods[i]);
+        ASSERT_NE(offsets, nullptr);
+        EXPECT_EQ(offsets, pf->FindMethodOffsets(methods[i]));
+        EXPECT_EQ(offsets->size, sizes[i]);
+
+        // Accessors take the positions from the table now
+        MethodDataAccessor mda(*pf, methods[i]);
+        EXPECT_EQ(mda.GetDebugInfoId(), debug_infos[i]);
+        EXPECT_EQ(mda.GetSize(), sizes[i]);
+        size_t annotations = 0;
+        mda.EnumerateAnnotations([&annotations](File::EntityId /* unused */) { annotations++; });
+        EXPECT_EQ(annotations, 0U);
+    }
+    EXPECT_EQ(pf->GetMethodOffsets(class_id), nullptr);
+}
+
 TEST(File, OpenPandaFile)
 {
     // Create ZIP
@@ -194,6 +304,79 @@ TEST(File, OpenPandaFileOrZip)
     remove(zip_filename);
 }
 
+TEST(File, OpenPandaFileFromExtractionCache)
+{
+    auto cache_dir = os::file::File::GetTmpPath();
+    ASSERT_TRUE(cache_dir);
+
+    // Create ZIP
+    auto data = GetEmptyPandaFileBytes();
+    const char *zip_filename = "__OpenPandaFileFromExtractionCache__.zip";
+    int ret = CreateOrAddZipPandaFile(&data, zip_filename, ARCHIVE_FILENAME, APPEND_STATUS_CREATE, Z_BEST_COMPRESSION);
+    ASSERT_EQ(ret, 0);
+
+    // The first open extracts the file to the cache, the second one maps the extracted file
+    SetExtractionCacheDir(cache_dir.Value());
+    auto pf1 = OpenPandaFile(zip_filename);
+    auto pf2 = OpenPandaFile(zip_filename);
+    SetExtractionCacheDir("");
+    ASSERT_NE(pf1, nullptr);
+    ASSERT_NE(pf2, nullptr);
+    EXPECT_STREQ((pf2->GetFilename()).c_str(), zip_filename);
+    EXPECT_EQ(pf1->GetHeader()->checksum, pf2->GetHeader()->checksum);
+    EXPECT_EQ(memcmp(pf1->GetBase(), pf2->GetBase(), data.size()), 0);
+    remove(zip_filename);
+}
+
+#ifdef PANDA_TARGET_UNIX
+TEST(File, OpenPandaFileFromCorruptedExtractionCache)
+{
+    auto tmp_dir = os::file::File::GetTmpPath();
+    ASSERT_TRUE(tmp_dir);
+    std::string cache_dir = tmp_dir.Value() + "/__CorruptedExtractionCache__";
+    mkdir(cache_dir.c_str(), S_IRWXU);
+
+    // Create ZIP
+    auto data = GetEmptyPandaFileBytes();
+    const char *zip_filename = "__OpenPandaFileFromCorruptedExtractionCache__.zip";
+    int ret = CreateOrAddZipPandaFile(&data, zip_filename, ARCHIVE_FILENAME, APPEND_STATUS_CREATE, Z_BEST_COMPRESSION);
+    ASSERT_EQ(ret, 0);
+
+    SetExtractionCacheDir(cache_dir);
+    ASSERT_NE(OpenPandaFile(zip_filename), nullptr);
+    std::vector<std::string> cached_files;
+    DIR *dir = opendir(cache_dir.c_str());
+    ASSERT_NE(dir, nullptr);
+    for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            cached_files.push_back(cache_dir + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+    ASSERT_EQ(cached_files.size(), 1U);
+
+    // Only the owner may change the extracted file
+    struct stat file_stat {};
+    ASSERT_EQ(stat(cached_files[0].c_str(), &file_stat), 0);
+    EXPECT_EQ(file_stat.st_mode & static_cast<mode_t>(S_IWGRP | S_IWOTH), 0U);
+
+    // The last byte is changed, so the size and the header of the file are still valid, but CRC is not
+    FILE *fp = fopen(cached_files[0].c_str(), "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, -1, SEEK_END);
+    fputc(data.back() ^ 0xFFU, fp);
+    fclose(fp);
+
+    auto pf = OpenPandaFile(zip_filename);
+    SetExtractionCacheDir("");
+    ASSERT_NE(pf, nullptr);
+    EXPECT_EQ(memcmp(pf->GetBase(), data.data(), data.size()), 0);
+    remove(cached_files[0].c_str());
+    rmdir(cache_dir.c_str());
+    remove(zip_filename);
+}
+#endif
+
 TEST(File, OpenPandaFileUncompressed)
 {
     // Create ZIP
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 namespace panda {
 
@@ -84,6 +85,64 @@ TEST(PandaCache, TestClassCache)
     ASSERT_EQ(cache.GetClassFromCache(id2), class2);
 }
 
+TEST(PandaCache, TestCacheSize)
+{
+    PandaCache default_cache;
+    ASSERT_EQ(default_cache.GetMethodCacheSize(), 1024U);
+
+    PandaCache cache(10U, 100000U, 3000U);
+    ASSERT_EQ(cache.GetMethodCacheSize(), PandaCache::MIN_CACHE_SIZE);
+    ASSERT_EQ(cache.GetFieldCacheSize(), PandaCache::MAX_CACHE_SIZE);
+    ASSERT_EQ(cache.GetClassCacheSize(), 4096U);
+}
+
+TEST(PandaCache, TestConflicts)
+{
+    PandaCache cache(0, 0, 0);
+    // Ids are mapped to the same set
+    const uint32_t sets_num = cache.GetMethodCacheSize() / PandaCache::WAYS;
+    std::vector<Method *> methods;
+    for (uint32_t i = 0; i <= PandaCache::WAYS; i++) {
+        methods.push_back(reinterpret_cast<Method *>(GetNewMockPointer()));
+    }
+
+    for (uint32_t i = 0; i < PandaCache::WAYS; i++) {
+        cache.SetMethodCache(EntityId(1U + i * sets_num), methods[i]);
+    }
+    for (uint32_t i = 0; i < PandaCache::WAYS; i++) {
+        ASSERT_EQ(cache.GetMethodFromCache(EntityId(1U + i * sets_num)), methods[i]);
+    }
+
+    // The set is full, the first inserted method is evicted
+    cache.SetMethodCache(EntityId(1U + PandaCache::WAYS * sets_num), methods[PandaCache::WAYS]);
+    ASSERT_EQ(cache.GetMethodFromCache(EntityId(1U)), nullptr);
+    for (uint32_t i = 1; i <= PandaCache::WAYS; i++) {
+        ASSERT_EQ(cache.GetMethodFromCache(EntityId(1U + i * sets_num)), methods[i]);
+    }
+}
+
+TEST(PandaCache, TestStatistics)
+{
+    PandaCache cache;
+    EntityId id(100);
+    auto *klass = reinterpret_cast<Class *>(GetNewMockPointer());
+
+    // Lookups are not counted by default
+    ASSERT_EQ(cache.GetClassFromCache(id), nullptr);
+    ASSERT_EQ(cache.GetClassStatistics().misses, 0U);
+
+    cache.EnableStatistics();
+    ASSERT_EQ(cache.GetClassFromCache(id), nullptr);
+    cache.SetClassCache(id, klass);
+    ASSERT_EQ(cache.GetClassFromCache(id), klass);
+    ASSERT_EQ(cache.GetClassFromCache(id), klass);
+
+    auto stat = cache.GetClassStatistics();
+    ASSERT_EQ(stat.hits, 2U);
+    ASSERT_EQ(stat.misses, 1U);
+    ASSERT_EQ(cache.GetMethodStatistics().hits + cache.GetMethodStatistics().misses, 0U);
+}
+
 struct ElementMock {
     int data;
 };
@@ -19,6 +19,9 @@
 
 #include <securec.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace panda {
 
 constexpr size_t ZIP_MAGIC_MASK = 0xff;
@@ -153,6 +156,21 @@ int ExtractToMemory(ZipArchiveHandle &handle, void *buf, size_t buf_size)
     return ZIPARCHIVE_OK;
 }
 
+uint32_t CalculateCrc32(const void *buf, size_t buf_size)
+{
+    // zlib takes lengths of uInt, so large buffers are processed by chunks
+    constexpr size_t MAX_CHUNK_SIZE = std::numeric_limits<uInt>::max();
+    const auto *data = static_cast<const Bytef *>(buf);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    while (buf_size > 0) {
+        size_t chunk_size = std::min(buf_size, MAX_CHUNK_SIZE);
+        crc = crc32(crc, data, static_cast<uInt>(chunk_size));
+        data += chunk_size;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        buf_size -= chunk_size;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
 int CreateOrAddFileIntoZip(const char *zipname, const char *filename, const void *pbuf, size_t buf_size, int append,
                            int level)
 {
@@ -39,6 +39,11 @@ public:
         return (uint32_t)file_stat.compressed_size;
     }
 
+    uint32_t GetCrc() const
+    {
+        return (uint32_t)file_stat.crc;
+    }
+
     inline uint32_t GetOffset() const
     {
         return offset;
@@ -154,6 +159,11 @@ int CloseCurrentFile(ZipArchiveHandle &handle);
  */
 int ExtractToMemory(ZipArchiveHandle &handle, void *buf, size_t buf_size);
 
+/*
+ * Calculate CRC-32 of buf of size |buf_size| the same way as the CRC of zip entries is calculated.
+ */
+uint32_t CalculateCrc32(const void *buf, size_t buf_size);
+
 /*
  * Add a new file filename(resident in memory pbuf which has size of size |buf_size|) to the archive zipname,
  * append takes value from APPEND_STATUS_CREATE(which will create the archive zipname for first time) and
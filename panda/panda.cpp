@@ -112,6 +112,8 @@ bool VerifierProcessFile(const panda::verifier::VerificationOptions &opts, const
         LanguageContext ctx = extracted.Value();
         bool is_default_context = true;
 
+        // Classes are verified in the order of the class index, which mostly follows the file layout
+        file->AdviseAccess(os::mem::AccessPattern::SEQUENTIAL);
         for (auto id : file->GetClasses()) {
             Class *klass = nullptr;
             {
@@ -138,6 +140,7 @@ bool VerifierProcessFile(const panda::verifier::VerificationOptions &opts, const
                 break;
             }
         }
+        file->AdviseAccess(os::mem::AccessPattern::NORMAL);
     }
 
     return result;
@@ -281,6 +284,9 @@ int Main(const int argc, const char **argv)
     if (runtime_options.IsPrintGcStatistics()) {
         std::cout << Runtime::GetCurrent()->GetFinalStatistics();
     }
+    if (runtime_options.IsPrintPandaCacheStatistics()) {
+        std::cout << Runtime::GetCurrent()->GetPandaCacheStatistics();
+    }
     if (!Runtime::Destroy()) {
         std::cerr << "Error: cannot destroy runtime" << std::endl;
         return -1;
@@ -53,6 +53,10 @@ void ClassLinker::AddPandaFile(std::unique_ptr<const panda_file::File> &&pf, Cla
 
     SCOPED_TRACE_STREAM << __FUNCTION__ << " " << file->GetFilename();
 
+    if (Runtime::GetOptions().IsPrintPandaCacheStatistics()) {
+        file->GetPandaCache()->EnableStatistics();
+    }
+
     {
         os::memory::LockHolder lock {panda_files_lock_};
         panda_files_.push_back({context, std::forward<std::unique_ptr<const panda_file::File>>(pf)});
@@ -60,6 +64,7 @@ void ClassLinker::AddPandaFile(std::unique_ptr<const panda_file::File> &&pf, Cla
 
     if (context == nullptr || context->IsBootContext()) {
         boot_panda_files_.push_back(file);
+        AddBootClasses(file);
     }
 
     if (Runtime::GetCurrent()->IsInitialized()) {
@@ -97,6 +102,7 @@ void ClassLinker::FreeClassData(Class *class_ptr)
             }
         }
         allocator_->Free(itable.begin());
+        IMTableBuilder::FreeConflictTables(class_ptr);
     }
     Span<Class *> interfaces = class_ptr->GetInterfaces();
     if (!interfaces.Empty()) {
@@ -119,7 +125,7 @@ ClassLinker::~ClassLinker()
 
 ClassLinker::ClassLinker(mem::InternalAllocatorPtr allocator,
                          std::vector<std::unique_ptr<ClassLinkerExtension>> &&extensions)
-    : allocator_(allocator), copied_names_(allocator->Adapter())
+    : allocator_(allocator), boot_classes_(allocator->Adapter()), copied_names_(allocator->Adapter())
 {
     for (auto &ext : extensions) {
         extensions_[ToExtensionIndex(ext->GetLanguage())] = std::move(ext);
@@ -170,18 +176,28 @@ bool ClassLinker::InitializeRoots(ManagedThread *thread)
 }
 
 using ClassEntry = std::pair<panda_file::File::EntityId, const panda_file::File *>;
-using PandaFiles = PandaVector<const panda_file::File *>;
-
-static ClassEntry FindClassInPandaFiles(const uint8_t *descriptor, const PandaFiles &panda_files)
+void ClassLinker::AddBootClasses(const panda_file::File *pf)
 {
-    for (auto *pf : panda_files) {
-        auto class_id = pf->GetClassId(descriptor);
-        if (class_id.IsValid() && !pf->IsExternal(class_id)) {
-            return {class_id, pf};
+    trace::ScopedTrace scoped_trace("Add boot classes");
+    auto classes = pf->GetClasses();
+    boot_classes_.reserve(boot_classes_.size() + classes.Size());
+    for (uint32_t class_offset : classes) {
+        panda_file::File::EntityId class_id(class_offset);
+        if (pf->IsExternal(class_id)) {
+            continue;
         }
+        // Classes from the files added earlier take precedence, as with the lookup in boot_panda_files_ order
+        boot_classes_.emplace(pf->GetStringData(class_id).data, ClassEntry {class_id, pf});
     }
+}
 
-    return {};
+ClassEntry ClassLinker::FindBootClass(const uint8_t *descriptor) const
+{
+    auto it = boot_classes_.find(descriptor);
+    if (it == boot_classes_.end()) {
+        return {};
+    }
+    return it->second;
 }
 
 Class *ClassLinker::FindLoadedClass(const uint8_t *descriptor, ClassLinkerContext *context)
@@ -1011,7 +1027,7 @@ Class *ClassLinker::GetClass(const uint8_t *descriptor, bool need_copy_descripto
     }
 
     if (context->IsBootContext()) {
-        auto [class_id, panda_file] = FindClassInPandaFiles(descriptor, boot_panda_files_);
+        auto [class_id, panda_file] = FindBootClass(descriptor);
 
         if (!class_id.IsValid()) {
             PandaStringStream ss;
@@ -1055,7 +1071,7 @@ Class *ClassLinker::GetClass(const panda_file::File &pf, panda_file::File::Entit
         const panda_file::File *pf_ptr = nullptr;
         panda_file::File::EntityId ext_id;
 
-        std::tie(ext_id, pf_ptr) = FindClassInPandaFiles(descriptor, boot_panda_files_);
+        std::tie(ext_id, pf_ptr) = FindBootClass(descriptor);
 
         if (!ext_id.IsValid()) {
             PandaStringStream ss;
@@ -20,6 +20,7 @@
 #include "libpandabase/mem/object_pointer.h"
 #include "libpandabase/os/mutex.h"
 #include "libpandabase/utils/bit_utils.h"
+#include "runtime/class_table.h"
 #include "runtime/include/class.h"
 #include "runtime/include/mem/panda_containers.h"
 #include "runtime/mem/gc/gc.h"
@@ -35,13 +36,8 @@ class ClassLinkerContext {
 public:
     Class *FindClass(const uint8_t *descriptor)
     {
-        os::memory::LockHolder lock(classes_lock_);
-        auto it = loaded_classes_.find(descriptor);
-        if (it != loaded_classes_.cend()) {
-            return it->second;
-        }
-
-        return nullptr;
+        // Lookups don't take the lock, the table supports them concurrently with insertions
+        return loaded_classes_.Find(descriptor);
     }
 
     virtual bool IsBootContext() const
@@ -64,7 +60,7 @@ public:
         }
 
         ASSERT(klass->GetSourceLang() == lang_);
-        loaded_classes_.insert({klass->GetDescriptor(), klass});
+        loaded_classes_.Insert(klass);
         if (record_new_class_) {
             new_classes_.push_back(klass);
         }
@@ -74,7 +70,7 @@ public:
     void RemoveClass(Class *klass)
     {
         os::memory::LockHolder lock(classes_lock_);
-        loaded_classes_.erase(klass->GetDescriptor());
+        loaded_classes_.Remove(klass->GetDescriptor());
     }
 
     template <class Callback>
@@ -84,10 +80,8 @@ public:
                                  mem::VisitGCRootFlags::ACCESS_ROOT_NONE)) == 1);
         if ((flags & mem::VisitGCRootFlags::ACCESS_ROOT_ALL) != 0) {
             os::memory::LockHolder lock(classes_lock_);
-            for (const auto &v : loaded_classes_) {
-                if (!cb(v.second)) {
-                    return false;
-                }
+            if (!loaded_classes_.EnumerateClasses(cb)) {
+                return false;
             }
         } else if ((flags & mem::VisitGCRootFlags::ACCESS_ROOT_ONLY_NEW) != 0) {
             os::memory::LockHolder lock(classes_lock_);
@@ -120,16 +114,16 @@ public:
     size_t NumLoadedClasses()
     {
         os::memory::LockHolder lock(classes_lock_);
-        return loaded_classes_.size();
+        return loaded_classes_.Size();
     }
 
     void VisitLoadedClasses(size_t flag)
     {
         os::memory::LockHolder lock(classes_lock_);
-        for (auto &loaded_class : loaded_classes_) {
-            auto class_ptr = loaded_class.second;
-            class_ptr->DumpClass(GET_LOG_STREAM(ERROR, RUNTIME), flag);
-        }
+        loaded_classes_.EnumerateClasses([flag](Class *klass) {
+            klass->DumpClass(GET_LOG_STREAM(ERROR, RUNTIME), flag);
+            return true;
+        });
     }
 
     void VisitGCRoots(const ObjectVisitor &cb)
@@ -191,10 +185,10 @@ protected:
 #endif  // NDEBUG
 
 private:
-    // Dummy fix of concurrency issues to evaluate degradation
+    // Serializes modifications of the loaded classes, lookups don't take it.
+    // It is recursive, because enumeration callbacks may load classes
     os::memory::RecursiveMutex classes_lock_;
-    PandaUnorderedMap<const uint8_t *, Class *, utf::Mutf8Hash, utf::Mutf8Equal> loaded_classes_
-        GUARDED_BY(classes_lock_);
+    ClassTable loaded_classes_;
     PandaVector<ObjectPointer<ObjectHeader>> roots_;
     bool record_new_class_ {false};
     PandaVector<Class *> new_classes_;
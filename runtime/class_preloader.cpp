@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/class_preloader.h"
+
+#include <fstream>
+#include <string>
+
+#include "libpandabase/utils/logger.h"
+#include "libpandafile/class_data_accessor-inl.h"
+#include "runtime/include/class_linker.h"
+#include "runtime/include/runtime.h"
+#include "runtime/include/thread.h"
+#include "runtime/include/thread_scopes.h"
+#include "trace/trace.h"
+
+namespace panda {
+
+bool ClassPreloadProcessor::Init()
+{
+    Runtime *runtime = Runtime::GetCurrent();
+    thread_ = MTManagedThread::Create(runtime, runtime->GetPandaVM());
+    return thread_ != nullptr;
+}
+
+bool ClassPreloadProcessor::Process(ClassPreloadTask task)
+{
+    preloader_->LoadClass(thread_, task.GetDescriptor());
+    return true;
+}
+
+bool ClassPreloadProcessor::Destroy()
+{
+    thread_->Destroy();
+    thread_ = nullptr;
+    return true;
+}
+
+size_t ClassPreloader::Preload(const PandaVector<PandaString> &descriptors, size_t threads_count)
+{
+    PandaVector<const uint8_t *> mutf8_descriptors;
+    mutf8_descriptors.reserve(descriptors.size());
+    for (const auto &descriptor : descriptors) {
+        mutf8_descriptors.push_back(utf::CStringAsMutf8(descriptor.c_str()));
+    }
+    return Preload(mutf8_descriptors, threads_count);
+}
+
+size_t ClassPreloader::Preload(const PandaVector<const uint8_t *> &descriptors, size_t threads_count)
+{
+    trace::ScopedTrace scoped_trace("Preload classes");
+    auto levels = SplitByLevels(descriptors);
+    if (levels.empty()) {
+        return 0;
+    }
+
+    mem::InternalAllocatorPtr allocator = Runtime::GetCurrent()->GetInternalAllocator();
+    ClassPreloadQueue queue(allocator);
+    {
+        ThreadPool<ClassPreloadTask, ClassPreloadProcessor, ClassPreloader *> thread_pool(
+            allocator, &queue, this, std::max<size_t>(threads_count, 1), "ClassPreloader");
+        for (const auto &level : levels) {
+            {
+                os::memory::LockHolder lock(pending_lock_);
+                pending_classes_ += level.size();
+            }
+            for (const uint8_t *descriptor : level) {
+                thread_pool.PutTask(ClassPreloadTask(descriptor));
+            }
+            // Classes of the next level may depend on the classes of this one
+            os::memory::LockHolder lock(pending_lock_);
+            while (pending_classes_ != 0) {
+                pending_cond_var_.Wait(&pending_lock_);
+            }
+        }
+    }
+
+    LOG(INFO, CLASS_LINKER) << "Preloaded " << loaded_classes_ << " of " << descriptors.size() << " classes in "
+                            << levels.size() << " levels";
+    return loaded_classes_;
+}
+
+void ClassPreloader::LoadClass(MTManagedThread *thread, const uint8_t *descriptor)
+{
+    {
+        ScopedManagedCodeThread s(thread);
+        Class *klass = class_linker_->GetClass(descriptor, true, context_);
+        if (klass != nullptr) {
+            loaded_classes_++;
+        } else {
+            LOG(DEBUG, CLASS_LINKER) << "Cannot preload class " << utf::Mutf8AsCString(descriptor);
+        }
+        if (thread->HasPendingException()) {
+            thread->ClearException();
+        }
+    }
+
+    os::memory::LockHolder lock(pending_lock_);
+    ASSERT(pending_classes_ > 0);
+    if (--pending_classes_ == 0) {
+        pending_cond_var_.Signal();
+    }
+}
+
+PandaVector<PandaVector<const uint8_t *>> ClassPreloader::SplitByLevels(
+    const PandaVector<const uint8_t *> &descriptors)
+{
+    LevelsMap levels_map;
+    PandaVector<PandaVector<const uint8_t *>> levels;
+    for (const uint8_t *descriptor : descriptors) {
+        if (class_linker_->FindLoadedClass(descriptor, context_) != nullptr) {
+            continue;
+        }
+        size_t level = GetLevel(descriptor, &levels_map);
+        if (level >= levels.size()) {
+            levels.resize(level + 1);
+        }
+        levels[level].push_back(descriptor);
+    }
+    return levels;
+}
+
+size_t ClassPreloader::GetLevel(const uint8_t *descriptor, LevelsMap *levels)
+{
+    auto it = levels->find(descriptor);
+    if (it != levels->end()) {
+        return it->second;
+    }
+    // Also breaks cycles in malformed hierarchies
+    levels->emplace(descriptor, 0);
+
+    const panda_file::File *pf = nullptr;
+    panda_file::File::EntityId class_id;
+    class_linker_->EnumeratePandaFiles([descriptor, &pf, &class_id](const panda_file::File &file) {
+        auto id = file.GetClassId(descriptor);
+        if (id.IsValid() && !file.IsExternal(id)) {
+            pf = &file;
+            class_id = id;
+            return false;
+        }
+        return true;
+    });
+    if (pf == nullptr) {
+        // Array, primitive or unknown class, it is loaded as is
+        return 0;
+    }
+
+    // Descriptors of dependencies point to the file data, so they outlive the map
+    size_t level = 0;
+    panda_file::ClassDataAccessor cda(*pf, class_id);
+    auto super_class_id = cda.GetSuperClassId();
+    if (super_class_id.GetOffset() != 0) {
+        level = std::max(level, GetLevel(pf->GetStringData(super_class_id).data, levels) + 1);
+    }
+    cda.EnumerateInterfaces([this, pf, levels, &level](panda_file::File::EntityId interface_id) {
+        level = std::max(level, GetLevel(pf->GetStringData(interface_id).data, levels) + 1);
+    });
+    (*levels)[descriptor] = level;
+    return level;
+}
+
+bool ClassPreloader::ReadClassList(std::string_view file_name, PandaVector<PandaString> *descriptors)
+{
+    std::ifstream file(std::string(file_name).c_str());
+    if (!file.is_open()) {
+        LOG(ERROR, CLASS_LINKER) << "Cannot open class list " << file_name;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            descriptors->emplace_back(line.c_str());
+        }
+    }
+    return true;
+}
+
+}  // namespace panda
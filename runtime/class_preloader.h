@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_RUNTIME_CLASS_PRELOADER_H_
+#define PANDA_RUNTIME_CLASS_PRELOADER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "libpandabase/macros.h"
+#include "libpandabase/os/mutex.h"
+#include "libpandabase/utils/utf.h"
+#include "runtime/include/mem/panda_containers.h"
+#include "runtime/include/mem/panda_string.h"
+#include "runtime/thread_pool.h"
+
+namespace panda {
+
+class ClassLinker;
+class ClassLinkerContext;
+class ClassPreloader;
+class MTManagedThread;
+
+class ClassPreloadTask {
+public:
+    ClassPreloadTask() = default;
+    explicit ClassPreloadTask(const uint8_t *descriptor) : descriptor_(descriptor) {}
+    ~ClassPreloadTask() = default;
+    DEFAULT_COPY_SEMANTIC(ClassPreloadTask);
+    DEFAULT_MOVE_SEMANTIC(ClassPreloadTask);
+
+    bool IsEmpty() const
+    {
+        return descriptor_ == nullptr;
+    }
+
+    const uint8_t *GetDescriptor() const
+    {
+        return descriptor_;
+    }
+
+private:
+    const uint8_t *descriptor_ {nullptr};
+};
+
+class ClassPreloadQueue : public TaskQueueInterface<ClassPreloadTask> {
+public:
+    explicit ClassPreloadQueue(mem::InternalAllocatorPtr allocator) : queue_(allocator->Adapter()) {}
+    ~ClassPreloadQueue() override = default;
+    NO_COPY_SEMANTIC(ClassPreloadQueue);
+    NO_MOVE_SEMANTIC(ClassPreloadQueue);
+
+    ClassPreloadTask GetTask() override
+    {
+        if (queue_.empty()) {
+            return ClassPreloadTask();
+        }
+        auto task = queue_.front();
+        queue_.pop_front();
+        return task;
+    }
+
+    // NOLINTNEXTLINE(google-default-arguments)
+    void AddTask(ClassPreloadTask task, [[maybe_unused]] size_t priority = 0) override
+    {
+        queue_.push_back(task);
+    }
+
+    void Finalize() override
+    {
+        queue_.clear();
+    }
+
+protected:
+    size_t GetQueueSize() override
+    {
+        return queue_.size();
+    }
+
+private:
+    PandaDeque<ClassPreloadTask> queue_;
+};
+
+/**
+ * Worker of the class preloader. It is attached to the runtime as a managed thread, because loaded classes
+ * are allocated in the managed heap.
+ */
+class ClassPreloadProcessor : public ProcessorInterface<ClassPreloadTask, ClassPreloader *> {
+public:
+    explicit ClassPreloadProcessor(ClassPreloader *preloader) : preloader_(preloader) {}
+    ~ClassPreloadProcessor() override = default;
+    NO_COPY_SEMANTIC(ClassPreloadProcessor);
+    NO_MOVE_SEMANTIC(ClassPreloadProcessor);
+
+    bool Init() override;
+    bool Process(ClassPreloadTask task) override;
+    bool Destroy() override;
+
+private:
+    ClassPreloader *preloader_;
+    MTManagedThread *thread_ {nullptr};
+};
+
+/**
+ * Loads and links a list of classes in parallel ahead of their first use.
+ * Classes are split into levels: a class gets a greater level than its superclass and interfaces,
+ * and levels are loaded one after another. So classes loaded in parallel don't depend on each other and
+ * the workers don't race to load the same superclass. Classes are not initialized, <clinit> still runs lazily.
+ */
+class ClassPreloader {
+public:
+    ClassPreloader(ClassLinker *class_linker, ClassLinkerContext *context)
+        : class_linker_(class_linker), context_(context)
+    {
+    }
+    ~ClassPreloader() = default;
+    NO_COPY_SEMANTIC(ClassPreloader);
+    NO_MOVE_SEMANTIC(ClassPreloader);
+
+    /**
+     * \brief Load and link classes, the calling thread waits until all the classes are loaded
+     * @param descriptors - descriptors of the classes
+     * @param threads_count - number of worker threads
+     * @return number of successfully loaded classes
+     */
+    size_t Preload(const PandaVector<PandaString> &descriptors, size_t threads_count);
+
+    /**
+     * \brief Load and link classes, the calling thread waits until all the classes are loaded
+     * @param descriptors - MUTF-8 descriptors of the classes
+     * @param threads_count - number of worker threads
+     * @return number of successfully loaded classes
+     */
+    size_t Preload(const PandaVector<const uint8_t *> &descriptors, size_t threads_count);
+
+    /**
+     * \brief Read a list of class descriptors from a text file, one descriptor per line
+     * @param file_name - path to the file
+     * @param descriptors - output list of descriptors
+     * @return false if the file cannot be read
+     */
+    static bool ReadClassList(std::string_view file_name, PandaVector<PandaString> *descriptors);
+
+private:
+    using LevelsMap = PandaUnorderedMap<const uint8_t *, size_t, utf::Mutf8Hash, utf::Mutf8Equal>;
+
+    void LoadClass(MTManagedThread *thread, const uint8_t *descriptor);
+    PandaVector<PandaVector<const uint8_t *>> SplitByLevels(const PandaVector<const uint8_t *> &descriptors);
+    size_t GetLevel(const uint8_t *descriptor, LevelsMap *levels);
+
+    ClassLinker *class_linker_;
+    ClassLinkerContext *context_;
+    std::atomic_size_t loaded_classes_ {0};
+    os::memory::Mutex pending_lock_;
+    os::memory::ConditionVariable pending_cond_var_;
+    size_t pending_classes_ GUARDED_BY(pending_lock_) {0};
+
+    friend class ClassPreloadProcessor;
+};
+
+}  // namespace panda
+
+#endif  // PANDA_RUNTIME_CLASS_PRELOADER_H_
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_RUNTIME_CLASS_TABLE_H_
+#define PANDA_RUNTIME_CLASS_TABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "libpandabase/macros.h"
+#include "libpandabase/mem/mem.h"
+#include "libpandabase/utils/math_helpers.h"
+#include "libpandabase/utils/utf.h"
+#include "runtime/include/class.h"
+#include "runtime/include/mem/panda_containers.h"
+
+namespace panda {
+
+/**
+ * Hash table of loaded classes keyed by descriptor.
+ * Lookups are lock-free: the table is open addressing with linear probing over atomic slots,
+ * and a slot once taken by a class is never reused for another one.
+ * Modifications must be serialized by the caller. The table grows by copying live classes to a new array
+ * which is published atomically, old arrays are kept until the table is destroyed because
+ * concurrent readers may still probe them. Their total size is less than the size of the current array.
+ */
+class ClassTable {
+public:
+    ClassTable() = default;
+    ~ClassTable() = default;
+
+    NO_COPY_SEMANTIC(ClassTable);
+    NO_MOVE_SEMANTIC(ClassTable);
+
+    /**
+     * \brief Find a class by descriptor, can be called concurrently with modifications
+     * @param descriptor - class descriptor
+     * @return the class or nullptr if there is no such class in the table
+     */
+    Class *Find(const uint8_t *descriptor) const
+    {
+        const Slots *slots = slots_.load(std::memory_order_acquire);
+        if (slots == nullptr) {
+            return nullptr;
+        }
+        uint32_t hash = utf::Mutf8Hash()(descriptor);
+        size_t mask = slots->size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot &slot = (*slots)[i];
+            Class *klass = slot.klass.load(std::memory_order_acquire);
+            if (klass == nullptr) {
+                return nullptr;
+            }
+            if (!IsRemoved(klass) && slot.hash.load(std::memory_order_relaxed) == hash &&
+                utf::IsEqual(descriptor, klass->GetDescriptor())) {
+                return klass;
+            }
+        }
+    }
+
+    /**
+     * \brief Insert a class, the table must not contain a class with the same descriptor
+     * @param klass - class to insert
+     */
+    void Insert(Class *klass)
+    {
+        ASSERT(Find(klass->GetDescriptor()) == nullptr);
+        const Slots *slots = slots_.load(std::memory_order_relaxed);
+        // Keep the load factor not greater than 1/2, so probe sequences stay short and lookups always stop
+        if (slots == nullptr || 2U * (used_slots_ + 1) > slots->size()) {
+            Grow();
+        }
+        Place(slots_.load(std::memory_order_relaxed), klass);
+        used_slots_++;
+        size_++;
+    }
+
+    /**
+     * \brief Remove a class from the table
+     * @param descriptor - class descriptor
+     * @return true if the class was removed, false if there is no such class in the table
+     */
+    bool Remove(const uint8_t *descriptor)
+    {
+        Slots *slots = slots_.load(std::memory_order_relaxed);
+        if (slots == nullptr) {
+            return false;
+        }
+        uint32_t hash = utf::Mutf8Hash()(descriptor);
+        size_t mask = slots->size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot &slot = (*slots)[i];
+            Class *klass = slot.klass.load(std::memory_order_relaxed);
+            if (klass == nullptr) {
+                return false;
+            }
+            if (!IsRemoved(klass) && slot.hash.load(std::memory_order_relaxed) == hash &&
+                utf::IsEqual(descriptor, klass->GetDescriptor())) {
+                // The slot stays taken, so probe sequences passing through it are not broken
+                slot.klass.store(ToNativePtr<Class>(REMOVED_CLASS), std::memory_order_release);
+                size_--;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * \brief Enumerate classes in the table, must not be called concurrently with modifications
+     * @param cb - callback which returns false to stop the enumeration
+     * @return false if the enumeration was stopped by the callback
+     */
+    template <class Callback>
+    bool EnumerateClasses(const Callback &cb) const
+    {
+        const Slots *slots = slots_.load(std::memory_order_relaxed);
+        if (slots == nullptr) {
+            return true;
+        }
+        for (const Slot &slot : *slots) {
+            Class *klass = slot.klass.load(std::memory_order_relaxed);
+            if (klass != nullptr && !IsRemoved(klass) && !cb(klass)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t Size() const
+    {
+        return size_;
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 64;
+    // Marks a slot of the removed class, it is never a valid class address
+    static constexpr uintptr_t REMOVED_CLASS = 1;
+
+    struct Slot {
+        std::atomic_uint32_t hash {0};
+        // Stored after the hash with the release order, so readers see the hash of a published class
+        std::atomic<Class *> klass {nullptr};
+    };
+
+    using Slots = PandaVector<Slot>;
+
+    static bool IsRemoved(const Class *klass)
+    {
+        return ToUintPtr(klass) == REMOVED_CLASS;
+    }
+
+    static void Place(Slots *slots, Class *klass)
+    {
+        uint32_t hash = utf::Mutf8Hash()(klass->GetDescriptor());
+        size_t mask = slots->size() - 1;
+        size_t i = hash & mask;
+        while ((*slots)[i].klass.load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & mask;
+        }
+        (*slots)[i].hash.store(hash, std::memory_order_relaxed);
+        (*slots)[i].klass.store(klass, std::memory_order_release);
+    }
+
+    void Grow()
+    {
+        // The new array is filled at most by a quarter
+        size_t capacity = helpers::math::GetPowerOfTwoValue32(4U * (size_ + 1));
+        capacity = std::max(MIN_CAPACITY, capacity);
+        Slots &new_slots = slots_storage_.emplace_back(capacity);
+        const Slots *old_slots = slots_.load(std::memory_order_relaxed);
+        if (old_slots != nullptr) {
+            for (const Slot &slot : *old_slots) {
+                Class *klass = slot.klass.load(std::memory_order_relaxed);
+                if (klass != nullptr && !IsRemoved(klass)) {
+                    Place(&new_slots, klass);
+                }
+            }
+        }
+        used_slots_ = size_;
+        slots_.store(&new_slots, std::memory_order_release);
+    }
+
+    std::atomic<Slots *> slots_ {nullptr};
+    // Current and retired slot arrays, a list doesn't move its elements
+    PandaList<Slots> slots_storage_;
+    // Number of slots taken by classes including the removed ones
+    size_t used_slots_ {0};
+    size_t size_ {0};
+};
+
+}  // namespace panda
+
+#endif  // PANDA_RUNTIME_CLASS_TABLE_H_
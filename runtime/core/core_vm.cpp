@@ -36,6 +36,7 @@ static mem::MemoryManager *CreateMM(LanguageContext ctx, mem::InternalAllocatorP
         false,                                        // is_single_thread
         options.IsUseTlabForAllocations(),            // is_use_tlab_for_allocations
         options.IsStartAsZygote(),                    // is_start_as_zygote
+        options.GetHeapSamplingInterval(),            // heap_sampling_interval
     };
 
     mem::GCTriggerConfig gc_trigger_config(options.GetGcTriggerType(), options.GetGcDebugTriggerStart(),
@@ -49,7 +50,9 @@ static mem::MemoryManager *CreateMM(LanguageContext ctx, mem::InternalAllocatorP
                                  options.IsRunGcInPlace(),
                                  options.IsPreGcHeapVerifyEnabled(),
                                  options.IsPostGcHeapVerifyEnabled(),
-                                 options.IsFailOnHeapVerification()};
+                                 options.IsFailOnHeapVerification(),
+                                 options.IsGcTenuredCompaction(),
+                                 options.GetGcTenuredCompactionThreshold()};
 
     mem::GCType gc_type = Runtime::GetGCType(options);
 
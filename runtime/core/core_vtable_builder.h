@@ -34,7 +34,9 @@ struct CoreVTableOverridePred {
     }
 };
 
-using CoreVTableBuilder = VTableBuilderImpl<CoreVTableSearchBySignature, CoreVTableOverridePred>;
+// Overriding methods have equal names and signatures, so they are looked up by the hash of both
+using CoreVTableBuilder =
+    VTableBuilderImpl<CoreVTableSearchBySignature, CoreVTableOverridePred, MethodInfo::HashByNameAndSignature>;
 
 }  // namespace panda
 
@@ -13,15 +13,20 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <limits>
+#include <type_traits>
 
 #include "libpandabase/utils/hash.h"
 #include "libpandabase/utils/span.h"
+#include "libpandabase/utils/string_kernels.h"
 #include "runtime/arch/memory_helpers.h"
 #include "runtime/include/coretypes/array.h"
 #include "runtime/include/coretypes/string-inl.h"
+#include "runtime/include/exceptions.h"
+#include "runtime/include/object_header-inl.h"
 #include "runtime/include/runtime.h"
 #include "runtime/handle_base-inl.h"
 #include "runtime/include/panda_vm.h"
@@ -30,9 +35,70 @@ namespace panda::coretypes {
 
 bool String::compressed_strings_enabled = true;
 
+// Flatten both strings, the second one is held in a handle as flattening of the first one may trigger GC
+static bool FlattenStrings(String **str1, String **str2)
+{
+    if (LIKELY(!(*str1)->IsRope() && !(*str2)->IsRope())) {
+        return true;
+    }
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    VMHandle<String> str2_handle(thread, *str2);
+    String *flat1 = String::Flatten(*str1);
+    if (flat1 == nullptr) {
+        return false;
+    }
+    VMHandle<String> flat1_handle(thread, flat1);
+    String *flat2 = String::Flatten(str2_handle.GetPtr());
+    if (flat2 == nullptr) {
+        return false;
+    }
+    *str1 = flat1_handle.GetPtr();
+    *str2 = flat2;
+    return true;
+}
+
+// Copy characters of the parts of a rope, the parts which are flattened ropes are copied from their flat strings.
+// Other threads may flatten the parts concurrently, so the left part of each rope is read once.
+template <class T>
+static void CopyRopeData(String *str, T *to)
+{
+    // Ropes built by appending are chains of left parts, so they are iterated and only right parts are recursed into
+    while (str->IsRope()) {
+        String *left = str->GetRopeLeft();
+        if (str->IsFlattenedBy(left)) {
+            str = left;
+            break;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        CopyRopeData(str->GetRopeRight(), to + left->GetLength());
+        str = left;
+    }
+    String *flat = str;
+    uint32_t length = flat->GetLength();
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        if (length != 0 && memcpy_s(to, length, flat->GetDataMUtf8(), length) != EOK) {
+            LOG(FATAL, RUNTIME) << __func__ << " memcpy_s failed";
+            UNREACHABLE();
+        }
+    } else if (flat->IsUtf16()) {
+        size_t size = String::ComputeDataSizeUtf16(length);
+        if (length != 0 && memcpy_s(to, size, flat->GetDataUtf16(), size) != EOK) {
+            LOG(FATAL, RUNTIME) << __func__ << " memcpy_s failed";
+            UNREACHABLE();
+        }
+    } else {
+        string_kernels::Widen(flat->GetDataMUtf8(), to, length);
+    }
+}
+
 /* static */
 String *String::CreateFromString(String *str, LanguageContext ctx, PandaVM *vm)
 {
+    str = Flatten(str);
+    if (str == nullptr) {
+        return nullptr;
+    }
     // Allocator may trig gc and move str, need to hold it
     auto thread = ManagedThread::GetCurrent();
     [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
@@ -44,7 +110,8 @@ String *String::CreateFromString(String *str, LanguageContext ctx, PandaVM *vm)
 
     // Retrieve str after gc
     str = str_handle.GetPtr();
-    string->length_ = str->length_;
+    // The copy has its own data even if str refers to external data
+    string->length_ = str->length_ & ~STRING_EXTERNAL_BIT;
     string->hashcode_ = str->hashcode_;
 
     uint32_t length = str->GetLength();
@@ -120,6 +187,34 @@ String *String::CreateFromMUtf8(const uint8_t *mutf8_data, LanguageContext ctx,
     return CreateFromMUtf8(mutf8_data, mutf8_length, utf16_length, can_be_compressed, ctx, vm, movable);
 }
 
+/* static */
+String *String::CreateFromExternalMUtf8(const uint8_t *mutf8_data, uint32_t utf16_length, bool can_be_compressed,
+                                        LanguageContext ctx, PandaVM *vm)
+{
+    auto *string_class = Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(ClassRoot::STRING);
+    // Compressed data of a string is the same as its MUtf8 data, so it may be shared
+    if (!compressed_strings_enabled || !can_be_compressed || utf16_length < MIN_EXTERNAL_LENGTH ||
+        string_class->IsDynamicClass()) {
+        return CreateFromMUtf8(mutf8_data, utf16_length, can_be_compressed, ctx, vm, false);
+    }
+    ASSERT(CanBeCompressedMUtf8(mutf8_data, utf16_length));
+
+    auto *string =
+        reinterpret_cast<String *>(vm->GetHeapManager()->AllocateNonMovableObject(string_class, ComputeSizeExternal()));
+    if (string == nullptr) {
+        return nullptr;
+    }
+    ASSERT(string->hashcode_ == 0);
+    TSAN_ANNOTATE_IGNORE_WRITES_BEGIN();
+    string->SetLength(utf16_length, true);
+    string->length_ |= STRING_EXTERNAL_BIT;
+    string->SetFieldPrimitive<uintptr_t>(GetDataOffset(), ToUintPtr(mutf8_data));
+    TSAN_ANNOTATE_IGNORE_WRITES_END();
+    // String is supposed to be a constant object, so all its data should be visible to all threads
+    arch::FullMemoryBarrier();
+    return string;
+}
+
 /* static */
 String *String::CreateFromUtf16(const uint16_t *utf16_data, uint32_t utf16_length, LanguageContext ctx, PandaVM *vm,
                                 bool movable)
@@ -158,11 +253,7 @@ String *String::CreateEmptyString(LanguageContext ctx, PandaVM *vm)
 /* static */
 void String::CopyUtf16AsMUtf8(const uint16_t *utf16_from, uint8_t *mutf8_to, uint32_t utf16_length)
 {
-    Span<const uint16_t> from(utf16_from, utf16_length);
-    Span<uint8_t> to(mutf8_to, utf16_length);
-    for (uint32_t i = 0; i < utf16_length; i++) {
-        to[i] = from[i];
-    }
+    string_kernels::Narrow(utf16_from, mutf8_to, utf16_length);
 }
 
 // static
@@ -249,13 +340,11 @@ String *String::CreateNewStringFromBytes(uint32_t offset, uint32_t length, uint3
 template <typename T1, typename T2>
 int32_t CompareStringSpan(Span<T1> &lhs_sp, Span<T2> &rhs_sp, int32_t count)
 {
-    for (int32_t i = 0; i < count; ++i) {
-        int32_t char_diff = static_cast<int32_t>(lhs_sp[i]) - static_cast<int32_t>(rhs_sp[i]);
-        if (char_diff != 0) {
-            return char_diff;
-        }
+    auto i = string_kernels::FindMismatch(lhs_sp.data(), rhs_sp.data(), count);
+    if (i == static_cast<size_t>(count)) {
+        return 0;
     }
-    return 0;
+    return static_cast<int32_t>(lhs_sp[i]) - static_cast<int32_t>(rhs_sp[i]);
 }
 
 int32_t String::Compare(String *rstr)
@@ -264,6 +353,9 @@ int32_t String::Compare(String *rstr)
     if (lstr == rstr) {
         return 0;
     }
+    if (!FlattenStrings(&lstr, &rstr)) {
+        return 0;
+    }
     auto lstr_leng = static_cast<int32_t>(lstr->GetLength());
     auto rstr_leng = static_cast<int32_t>(rstr->GetLength());
     int32_t leng_ret = lstr_leng - rstr_leng;
@@ -283,8 +375,8 @@ int32_t String::Compare(String *rstr)
             return char_diff;
         }
     } else if (!rstr->IsUtf16()) {
-        Span<uint16_t> lhs_sp(lstr->GetDataUtf16(), rstr_leng);
-        Span<uint8_t> rhs_sp(rstr->GetDataMUtf8(), lstr_leng);
+        Span<uint16_t> lhs_sp(lstr->GetDataUtf16(), lstr_leng);
+        Span<uint8_t> rhs_sp(rstr->GetDataMUtf8(), rstr_leng);
         int32_t char_diff = CompareStringSpan(lhs_sp, rhs_sp, min_count);
         if (char_diff != 0) {
             return char_diff;
@@ -304,25 +396,17 @@ int32_t String::Compare(String *rstr)
 template <typename T1, typename T2>
 int32_t String::IndexOf(Span<const T1> &lhs_sp, Span<const T2> &rhs_sp, int32_t pos, int32_t max)
 {
-    auto first = static_cast<int32_t>(rhs_sp[0]);
+    auto first = static_cast<uint16_t>(rhs_sp[0]);
+    auto rest = rhs_sp.SubSpan(1);
     for (int32_t i = pos; i <= max; i++) {
-        if (static_cast<int32_t>(lhs_sp[i]) != first) {
-            i++;
-            while (i <= max && static_cast<int32_t>(lhs_sp[i]) != first) {
-                i++;
-            }
+        i += static_cast<int32_t>(string_kernels::FindChar(lhs_sp.SubSpan(i).data(), max - i + 1, first));
+        if (i > max) {
+            break;
         }
         /* Found the first character, now look at the rest of rhs_sp */
-        if (i <= max) {
-            int j = i + 1;
-            int end = j + rhs_sp.size() - 1;
-
-            for (int k = 1; j < end && static_cast<int32_t>(lhs_sp[j]) == static_cast<int32_t>(rhs_sp[k]); j++, k++) {
-            }
-            if (j == end) {
-                /* Found whole string. */
-                return i;
-            }
+        if (string_kernels::FindMismatch(lhs_sp.SubSpan(i + 1).data(), rest.data(), rest.size()) == rest.size()) {
+            /* Found whole string. */
+            return i;
         }
     }
     return -1;
@@ -349,6 +433,9 @@ int32_t String::IndexOf(String *rhs, int32_t pos)
         pos = 0;
     }
 
+    if (!FlattenStrings(&lhs, &rhs)) {
+        return -1;
+    }
     int32_t max = lhs_count - rhs_count;
     if (rhs->IsMUtf8() && lhs->IsMUtf8()) {
         Span<const uint8_t> lhs_sp(lhs->GetDataMUtf8(), lhs_count);
@@ -377,15 +464,7 @@ bool String::CanBeCompressed(const uint16_t *utf16_data, uint32_t utf16_length)
     if (!compressed_strings_enabled) {
         return false;
     }
-    bool is_compressed = true;
-    Span<const uint16_t> data(utf16_data, utf16_length);
-    for (uint32_t i = 0; i < utf16_length; i++) {
-        if (!IsASCIICharacter(data[i])) {
-            is_compressed = false;
-            break;
-        }
-    }
-    return is_compressed;
+    return string_kernels::IsAsciiOnly(utf16_data, utf16_length);
 }
 
 // static
@@ -394,15 +473,7 @@ bool String::CanBeCompressedMUtf8(const uint8_t *mutf8_data, uint32_t mutf8_leng
     if (!compressed_strings_enabled) {
         return false;
     }
-    bool is_compressed = true;
-    Span<const uint8_t> data(mutf8_data, mutf8_length);
-    for (uint32_t i = 0; i < mutf8_length; i++) {
-        if (!IsASCIICharacter(data[i])) {
-            is_compressed = false;
-            break;
-        }
-    }
-    return is_compressed;
+    return string_kernels::IsAsciiOnly(mutf8_data, mutf8_length);
 }
 
 /* static */
@@ -451,6 +522,9 @@ bool String::StringsAreEqual(String *str1, String *str2)
     if ((str1->IsUtf16() != str2->IsUtf16()) || (str1->GetLength() != str2->GetLength())) {
         return false;
     }
+    if (!FlattenStrings(&str1, &str2)) {
+        return false;
+    }
 
     if (str1->IsUtf16()) {
         Span<const uint16_t> data1(str1->GetDataUtf16(), str1->GetLength());
@@ -484,6 +558,10 @@ bool String::StringsAreEqualMUtf8(String *str1, const uint8_t *mutf8_data, uint3
         if (str1_can_be_compressed != can_be_compressed) {
             return false;
         }
+        str1 = Flatten(str1);
+        if (str1 == nullptr) {
+            return false;
+        }
 
         ASSERT(str1_can_be_compressed == can_be_compressed);
         if (str1_can_be_compressed) {
@@ -500,10 +578,15 @@ bool String::StringsAreEqualMUtf8(String *str1, const uint8_t *mutf8_data, uint3
 /* static */
 bool String::StringsAreEqualUtf16(String *str1, const uint16_t *utf16_data, uint32_t utf16_data_length)
 {
-    bool result = true;
     if (str1->GetLength() != utf16_data_length) {
-        result = false;
-    } else if (!str1->IsUtf16()) {
+        return false;
+    }
+    str1 = Flatten(str1);
+    if (str1 == nullptr) {
+        return false;
+    }
+    bool result = true;
+    if (!str1->IsUtf16()) {
         result = IsMutf8EqualsUtf16(str1->GetDataMUtf8(), str1->GetLength(), utf16_data, utf16_data_length);
     } else {
         Span<const uint16_t> data1(str1->GetDataUtf16(), str1->GetLength());
@@ -513,57 +596,87 @@ bool String::StringsAreEqualUtf16(String *str1, const uint16_t *utf16_data, uint
     return result;
 }
 
+// Compare UTF-16 characters of MUTF-8 data with UTF-16 data while decoding, runs of one-byte characters are compared
+// at once. The data is not converted into a temporary buffer.
+static bool IsMutf8EqualsUtf16Impl(const uint8_t *mutf8_data, size_t mutf8_length, const uint16_t *utf16_data,
+                                   uint32_t utf16_length)
+{
+    size_t in_pos = 0;
+    size_t count = 0;
+    while (count < utf16_length) {
+        // A matching character takes at least one byte, so the bytes of the run are not more than the characters left
+        size_t run_length = std::min<size_t>(utf16_length - count, mutf8_length - in_pos);
+        size_t single_bytes = string_kernels::CountSingleBytes(mutf8_data, run_length);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (string_kernels::FindMismatch(mutf8_data, utf16_data + count, single_bytes) != single_bytes) {
+            return false;
+        }
+        mutf8_data += single_bytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        in_pos += single_bytes;
+        count += single_bytes;
+        if (count == utf16_length) {
+            break;
+        }
+        if (in_pos == mutf8_length) {
+            return false;
+        }
+        auto [pair, nbytes] = utf::ConvertMUtf8ToUtf16Pair(mutf8_data, mutf8_length - in_pos);
+        auto [p_hi, p_lo] = utf::SplitUtf16Pair(pair);
+        if (p_hi != 0) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if (count + 1U == utf16_length || utf16_data[count] != p_hi) {
+                return false;
+            }
+            count++;
+        }
+        if (utf16_data[count] != p_lo) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return false;
+        }
+        count++;
+        mutf8_data += nbytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        in_pos += nbytes;
+    }
+    return true;
+}
+
 /* static */
 bool String::IsMutf8EqualsUtf16(const uint8_t *utf8_data, uint32_t utf8_data_length, const uint16_t *utf16_data,
                                 uint32_t utf16_data_length)
 {
-    auto allocator = Runtime::GetCurrent()->GetInternalAllocator();
-    auto tmp_buffer = allocator->AllocArray<uint16_t>(utf16_data_length);
-    [[maybe_unused]] auto converted_string_size =
-        utf::ConvertRegionMUtf8ToUtf16(utf8_data, tmp_buffer, utf8_data_length, utf16_data_length, 0);
-    ASSERT(converted_string_size == utf16_data_length);
-
-    Span<const uint16_t> data1(tmp_buffer, utf16_data_length);
-    Span<const uint16_t> data2(utf16_data, utf16_data_length);
-    bool result = String::StringsAreEquals(data1, data2);
-    allocator->Delete(tmp_buffer);
-    return result;
+    if (utf8_data_length == utf16_data_length) {
+        // Each character takes one byte, e.g. the data of a compressed string
+        return string_kernels::FindMismatch(utf8_data, utf16_data, utf16_data_length) == utf16_data_length;
+    }
+    return IsMutf8EqualsUtf16Impl(utf8_data, utf8_data_length, utf16_data, utf16_data_length);
 }
 
 /* static */
 bool String::IsMutf8EqualsUtf16(const uint8_t *utf8_data, const uint16_t *utf16_data, uint32_t utf16_data_length)
 {
-    auto allocator = Runtime::GetCurrent()->GetInternalAllocator();
-    auto tmp_buffer = allocator->AllocArray<uint16_t>(utf16_data_length);
-    utf::ConvertMUtf8ToUtf16(utf8_data, utf::Mutf8Size(utf8_data), tmp_buffer);
-
-    Span<const uint16_t> data1(tmp_buffer, utf16_data_length);
-    Span<const uint16_t> data2(utf16_data, utf16_data_length);
-    bool result = String::StringsAreEquals(data1, data2);
-    allocator->Delete(tmp_buffer);
-    return result;
+    // The length of the data is not known, it is well-formed, so no sequence crosses the terminating zero
+    return IsMutf8EqualsUtf16Impl(utf8_data, std::numeric_limits<size_t>::max(), utf16_data, utf16_data_length);
 }
 
 /* static */
 template <typename T>
 bool String::StringsAreEquals(Span<const T> &str1, Span<const T> &str2)
 {
-    for (size_t i = 0; i < str1.Size(); i++) {
-        if (str1[i] != str2[i]) {
-            return false;
-        }
-    }
-    return true;
+    ASSERT(str1.Size() <= str2.Size());
+    return string_kernels::FindMismatch(str1.data(), str2.data(), str1.Size()) == str1.Size();
 }
 
 Array *String::ToCharArray(LanguageContext ctx)
 {
+    String *flat = Flatten(this);
+    if (flat == nullptr) {
+        return nullptr;
+    }
     // allocator may trig gc and move 'this', need to hold it
     auto thread = ManagedThread::GetCurrent();
     [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
-    VMHandle<String> str(thread, this);
+    VMHandle<String> str(thread, flat);
     auto *klass = Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(ClassRoot::ARRAY_U16);
-    Array *array = Array::Create(klass, GetLength());
+    Array *array = Array::Create(klass, str->GetLength());
     if (array == nullptr) {
         return nullptr;
     }
@@ -587,33 +700,66 @@ Array *String::ToCharArray(LanguageContext ctx)
 // when compiles switch-case statement with strings
 template <class T>
 static int32_t ComputeHashForData(const T *data, size_t size)
+{
+    return static_cast<int32_t>(string_kernels::HashCode(0U, data, size));
+}
+
+static constexpr uint32_t HASH_MULTIPLIER = 31;
+
+// Hash of UTF-16 characters of MUTF-8 data computed while decoding, runs of one-byte characters are hashed at once
+static int32_t ComputeHashForMutf8(const uint8_t *mutf8_data, uint32_t utf16_length)
 {
     uint32_t hash = 0;
-#if defined(__GNUC__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wignored-attributes"
-    Span<const T> sp(data, size);
-#pragma GCC diagnostic pop
-#endif
-    for (auto c : sp) {
-        constexpr size_t SHIFT = 5;
-        hash = (hash << SHIFT) - hash + c;
+    size_t count = 0;
+    while (count < utf16_length) {
+        // Each UTF-16 character takes at least one byte, so the remaining bytes are not fewer than the characters
+        size_t single_bytes = string_kernels::CountSingleBytes(mutf8_data, utf16_length - count);
+        hash = string_kernels::HashCode(hash, mutf8_data, single_bytes);
+        mutf8_data += single_bytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        count += single_bytes;
+        if (count == utf16_length) {
+            break;
+        }
+        auto [pair, nbytes] = utf::ConvertMUtf8ToUtf16Pair(mutf8_data);
+        auto [p_hi, p_lo] = utf::SplitUtf16Pair(pair);
+        if (p_hi != 0) {
+            hash = hash * HASH_MULTIPLIER + p_hi;
+            count++;
+        }
+        hash = hash * HASH_MULTIPLIER + p_lo;
+        count++;
+        mutf8_data += nbytes;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     }
     return static_cast<int32_t>(hash);
 }
 
-static int32_t ComputeHashForMutf8(const uint8_t *mutf8_data)
+// 31^exponent modulo 2^32
+static uint32_t PowerOfHashMultiplier(uint32_t exponent)
 {
-    uint32_t hash = 0;
-    while (*mutf8_data != '\0') {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        constexpr size_t SHIFT = 5;
-        hash = (hash << SHIFT) - hash + *mutf8_data++;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    uint32_t result = 1;
+    uint32_t base = HASH_MULTIPLIER;
+    for (; exponent != 0; exponent >>= 1U) {
+        if ((exponent & 1U) != 0) {
+            result *= base;
+        }
+        base *= base;
     }
-    return static_cast<int32_t>(hash);
+    return result;
 }
 
 uint32_t String::ComputeHashcode()
 {
+    if (UNLIKELY(IsRope())) {
+        // Hashes of the parts are cached in them, so a rope is hashed without flattening:
+        // hash(left + right) = hash(left) * 31^length(right) + hash(right)
+        // The left part is read once, the right part is the original one unless the left part is the flat string
+        String *left = GetRopeLeft();
+        if (IsFlattenedBy(left)) {
+            return left->GetHashcode();
+        }
+        String *right = GetRopeRight();
+        return left->GetHashcode() * PowerOfHashMultiplier(right->GetLength()) + right->GetHashcode();
+    }
     uint32_t hash;
     if (compressed_strings_enabled) {
         if (!IsUtf16()) {
@@ -637,17 +783,10 @@ uint32_t String::ComputeHashcodeMutf8(const uint8_t *mutf8_data, uint32_t utf16_
 /* static */
 uint32_t String::ComputeHashcodeMutf8(const uint8_t *mutf8_data, uint32_t utf16_length, bool can_be_compressed)
 {
-    uint32_t hash;
     if (can_be_compressed) {
-        hash = static_cast<uint32_t>(ComputeHashForMutf8(mutf8_data));
-    } else {
-        auto allocator = Runtime::GetCurrent()->GetInternalAllocator();
-        auto tmp_buffer = allocator->AllocArray<uint16_t>(utf16_length);
-        utf::ConvertMUtf8ToUtf16(mutf8_data, utf::Mutf8Size(mutf8_data), tmp_buffer);
-        hash = static_cast<uint32_t>(ComputeHashForData(tmp_buffer, utf16_length));
-        allocator->Delete(tmp_buffer);
+        return static_cast<uint32_t>(ComputeHashForData(mutf8_data, utf16_length));
     }
-    return hash;
+    return static_cast<uint32_t>(ComputeHashForMutf8(mutf8_data, utf16_length));
 }
 
 /* static */
@@ -659,6 +798,10 @@ uint32_t String::ComputeHashcodeUtf16(uint16_t *utf16_data, uint32_t length)
 /* static */
 String *String::DoReplace(String *src, uint16_t old_c, uint16_t new_c, LanguageContext ctx, PandaVM *vm)
 {
+    src = Flatten(src);
+    if (src == nullptr) {
+        return nullptr;
+    }
     auto length = src->GetLength();
     bool can_be_compressed = IsASCIICharacter(new_c);
     if (src->IsUtf16()) {
@@ -712,6 +855,10 @@ String *String::DoReplace(String *src, uint16_t old_c, uint16_t new_c, LanguageC
 /* static */
 String *String::FastSubString(String *src, uint32_t start, uint32_t utf16_length, LanguageContext ctx, PandaVM *vm)
 {
+    src = Flatten(src);
+    if (src == nullptr) {
+        return nullptr;
+    }
     // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     bool can_be_compressed = !src->IsUtf16() || CanBeCompressed(src->GetDataUtf16() + start, utf16_length);
 
@@ -758,15 +905,29 @@ String *String::FastSubString(String *src, uint32_t start, uint32_t utf16_length
 /* static */
 String *String::Concat(String *string1, String *string2, LanguageContext ctx, PandaVM *vm)
 {
+    uint32_t length1 = string1->GetLength();
+    uint32_t length2 = string2->GetLength();
+    // Ropes don't allocate characters, so a huge length can be reached by few concatenations
+    if (UNLIKELY(length1 > MAX_LENGTH - length2)) {
+        ThrowOutOfMemoryError(ctx, ManagedThread::GetCurrent(),
+                              "Length of the concatenated string exceeds the maximum length of a string");
+        return nullptr;
+    }
+    uint32_t new_length = length1 + length2;
+    // GC of dynamic languages doesn't visit references from strings, so they don't use ropes
+    if (new_length >= MIN_ROPE_LENGTH && length1 != 0 && length2 != 0 &&
+        !string1->ClassAddr<BaseClass>()->IsDynamicClass()) {
+        return CreateRope(string1, string2, ctx, vm);
+    }
+    if (!FlattenStrings(&string1, &string2)) {
+        return nullptr;
+    }
+
     // allocator may trig gc and move src, need to hold it
     auto thread = ManagedThread::GetCurrent();
     [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
     VMHandle<String> str1_handle(thread, string1);
     VMHandle<String> str2_handle(thread, string2);
-
-    uint32_t length1 = string1->GetLength();
-    uint32_t length2 = string2->GetLength();
-    uint32_t new_length = length1 + length2;
     bool compressed = compressed_strings_enabled && (!string1->IsUtf16() && !string2->IsUtf16());
     auto new_string = AllocStringObject(new_length, compressed, ctx, vm);
     if (UNLIKELY(new_string == nullptr)) {
@@ -795,9 +956,7 @@ String *String::Concat(String *string1, String *string2, LanguageContext ctx, Pa
     } else {
         Span<uint16_t> sp(new_string->GetDataUtf16(), new_length);
         if (!string1->IsUtf16()) {
-            for (uint32_t i = 0; i < length1; ++i) {
-                sp[i] = string1->At<false>(i);
-            }
+            string_kernels::Widen(string1->GetDataMUtf8(), sp.data(), length1);
         } else {
             if (memcpy_s(sp.Data(), sp.SizeBytes(), string1->GetDataUtf16(), length1 << 1U) != EOK) {
                 LOG(FATAL, RUNTIME) << __func__ << " memcpy_s failed";
@@ -806,9 +965,7 @@ String *String::Concat(String *string1, String *string2, LanguageContext ctx, Pa
         }
         sp = sp.SubSpan(length1);
         if (!string2->IsUtf16()) {
-            for (uint32_t i = 0; i < length2; ++i) {
-                sp[i] = string2->At<false>(i);
-            }
+            string_kernels::Widen(string2->GetDataMUtf8(), sp.data(), length2);
         } else {
             if (memcpy_s(sp.Data(), sp.SizeBytes(), string2->GetDataUtf16(), length2 << 1U) != EOK) {
                 LOG(FATAL, RUNTIME) << __func__ << " memcpy_s failed";
@@ -823,11 +980,123 @@ String *String::Concat(String *string1, String *string2, LanguageContext ctx, Pa
     return new_string;
 }
 
+/* static */
+String *String::CreateRope(String *left, String *right, LanguageContext ctx, PandaVM *vm)
+{
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    // The deeper part of a too deep rope is flattened, so methods visiting parts of ropes recurse boundedly
+    auto depth = [](String *str) { return str->IsRope() ? str->GetRopeDepth() : 0U; };
+    if (std::max(depth(left), depth(right)) >= MAX_ROPE_DEPTH) {
+        VMHandle<String> left_holder(thread, left);
+        VMHandle<String> right_holder(thread, right);
+        bool left_is_deeper = depth(left) >= depth(right);
+        String *flat = Flatten(left_is_deeper ? left : right);
+        if (flat == nullptr) {
+            return nullptr;
+        }
+        left = left_is_deeper ? flat : left_holder.GetPtr();
+        right = left_is_deeper ? right_holder.GetPtr() : flat;
+    }
+
+    // allocator may trig gc and move parts, need to hold them
+    VMHandle<String> left_handle(thread, left);
+    VMHandle<String> right_handle(thread, right);
+    uint32_t length = left->GetLength() + right->GetLength();
+    ASSERT(length <= MAX_LENGTH);
+    bool compressed = compressed_strings_enabled && !left->IsUtf16() && !right->IsUtf16();
+    uint32_t rope_depth = std::max(depth(left), depth(right)) + 1U;
+    auto *string_class = Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(ClassRoot::STRING);
+    auto rope = reinterpret_cast<String *>(vm->GetHeapManager()->AllocateObject(string_class, ComputeSizeRope()));
+    if (rope == nullptr) {
+        return nullptr;
+    }
+    rope->SetLength(length, compressed);
+    rope->length_ |= STRING_ROPE_BIT;
+    rope->SetFieldPrimitive<uint32_t>(GetDataOffset() + ROPE_DEPTH_OFFSET, rope_depth);
+    rope->SetFieldObject(GetRopeLeftOffset(), left_handle.GetPtr());
+    rope->SetFieldObject(GetRopeRightOffset(), right_handle.GetPtr());
+    // String is supposed to be a constant object, so all its data should be visible to all threads
+    arch::FullMemoryBarrier();
+    return rope;
+}
+
+/* static */
+String *String::Flatten(String *str)
+{
+    if (LIKELY(!str->IsRope())) {
+        return str;
+    }
+    String *left = str->GetRopeLeft();
+    if (str->IsFlattenedBy(left)) {
+        return left;
+    }
+
+    // allocator may trig gc and move the rope, need to hold it
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    VMHandle<String> rope_handle(thread, str);
+    bool compressed = !str->IsUtf16();
+    auto flat = AllocStringObject(str->ClassAddr<BaseClass>(), str->GetLength(), compressed, thread->GetVM());
+    if (flat == nullptr) {
+        return nullptr;
+    }
+    String *rope = rope_handle.GetPtr();
+
+    // After copying we should have a full barrier, so this writes should happen-before barrier
+    TSAN_ANNOTATE_IGNORE_WRITES_BEGIN();
+    if (compressed) {
+        CopyRopeData(rope, flat->GetDataMUtf8());
+    } else {
+        CopyRopeData(rope, flat->GetDataUtf16());
+    }
+    flat->hashcode_ = rope->hashcode_;
+    TSAN_ANNOTATE_IGNORE_WRITES_END();
+    arch::FullMemoryBarrier();
+
+    // The flat string is published by a single store of the left part, the right part and the depth are kept, so
+    // readers which loaded the previous left part see a consistent pair of parts. Concurrent flattenings may publish
+    // different flat strings, all of them have the same characters.
+    rope->SetFieldObject<true>(GetRopeLeftOffset(), flat);
+    return flat;
+}
+
+String *String::GetRopeLeft() const
+{
+    ASSERT(IsRope());
+    return static_cast<String *>(GetFieldObject<true>(GetRopeLeftOffset()));
+}
+
+String *String::GetRopeRight() const
+{
+    ASSERT(IsRope());
+    return static_cast<String *>(GetFieldObject<true>(GetRopeRightOffset()));
+}
+
+uint32_t String::GetRopeDepth() const
+{
+    ASSERT(IsRope());
+    return GetFieldPrimitive<uint32_t>(GetDataOffset() + ROPE_DEPTH_OFFSET);
+}
+
+String *String::GetFlattenedRope() const
+{
+    String *left = GetRopeLeft();
+    LOG_IF(!IsFlattenedBy(left), FATAL, RUNTIME) << "String: Read data of a rope which is not flattened";
+    return left;
+}
+
 /* static */
 String *String::AllocStringObject(size_t length, bool compressed, LanguageContext ctx, PandaVM *vm, bool movable)
 {
-    ASSERT(vm != nullptr);
     auto *string_class = Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(ClassRoot::STRING);
+    return AllocStringObject(string_class, length, compressed, vm, movable);
+}
+
+/* static */
+String *String::AllocStringObject(BaseClass *string_class, size_t length, bool compressed, PandaVM *vm, bool movable)
+{
+    ASSERT(vm != nullptr);
     size_t size = compressed ? String::ComputeSizeMUtf8(length) : String::ComputeSizeUtf16(length);
     auto string = movable
                       ? reinterpret_cast<String *>(vm->GetHeapManager()->AllocateObject(string_class, size))
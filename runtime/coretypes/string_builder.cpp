@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string>
+
+#include "libpandabase/utils/string_kernels.h"
+#include "libpandabase/utils/utf.h"
+#include "runtime/arch/memory_helpers.h"
+#include "runtime/handle_base-inl.h"
+#include "runtime/include/class-inl.h"
+#include "runtime/include/class_linker.h"
+#include "runtime/include/coretypes/array.h"
+#include "runtime/include/coretypes/string-inl.h"
+#include "runtime/include/coretypes/string_builder.h"
+#include "runtime/include/exceptions.h"
+#include "runtime/include/object_header-inl.h"
+#include "runtime/include/runtime.h"
+#include "runtime/include/thread.h"
+
+namespace panda::coretypes {
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+bool StringBuilder::CheckLayout(const Class *klass)
+{
+    Field *buffer = klass->GetInstanceFieldByName(utf::CStringAsMutf8("buffer"));
+    Field *length = klass->GetInstanceFieldByName(utf::CStringAsMutf8("length"));
+    return buffer != nullptr && length != nullptr && buffer->GetOffset() == GetBufferOffset() &&
+           length->GetOffset() == GetLengthOffset();
+}
+
+static void CopyChars(void *dst, size_t dst_size, const void *src, size_t size)
+{
+    if (size != 0 && memcpy_s(dst, dst_size, src, size) != EOK) {
+        LOG(FATAL, RUNTIME) << __func__ << " memcpy_s failed";
+        UNREACHABLE();
+    }
+}
+
+static Class *GetBufferClass(LanguageContext ctx, bool utf16)
+{
+    return Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(utf16 ? ClassRoot::ARRAY_U16
+                                                                                           : ClassRoot::ARRAY_U8);
+}
+
+template <class T>
+static T *GetChars(Array *buffer)
+{
+    return reinterpret_cast<T *>(buffer->GetData());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// The class of a builder is loaded by the boot context, a class with the same name from another context is different
+static bool IsBuilderClass(const Class *klass, LanguageContext ctx)
+{
+    auto *ext = Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx);
+    return klass->GetLoadContext() == ext->GetBootContext() &&
+           utf::IsEqual(klass->GetDescriptor(), utf::CStringAsMutf8("LStringBuilder;"));
+}
+
+// Unverified code can pass any object as a builder and managed code can write the fields at any time,
+// so each field is read once and the values are checked before the buffer is accessed
+bool StringBuilder::CheckBuffer(LanguageContext ctx, Array **buffer, uint32_t *length, bool *utf16) const
+{
+    auto *builder_class = ClassAddr<Class>();
+    if (UNLIKELY(!IsBuilderClass(builder_class, ctx))) {
+        std::string msg = builder_class->GetName() + " cannot be cast to StringBuilder";
+        ThrowException(ctx, ManagedThread::GetCurrent(), ctx.GetClassCastExceptionClassDescriptor(),
+                       utf::CStringAsMutf8(msg.c_str()));
+        return false;
+    }
+    ASSERT(CheckLayout(builder_class));
+    *buffer = GetBuffer();
+    *length = GetLength();
+    *utf16 = !String::GetCompressedStringsEnabled();
+    uint32_t capacity = 0;
+    if (*buffer != nullptr) {
+        auto *klass = (*buffer)->ClassAddr<Class>();
+        if (UNLIKELY(klass != GetBufferClass(ctx, false) && klass != GetBufferClass(ctx, true))) {
+            ThrowIllegalStateException("StringBuilder buffer is not a character array");
+            return false;
+        }
+        *utf16 = klass->GetComponentSize() == sizeof(uint16_t);
+        capacity = (*buffer)->GetLength();
+    }
+    if (UNLIKELY(*length > capacity)) {
+        ThrowIllegalStateException("StringBuilder length is greater than its capacity");
+        return false;
+    }
+    return true;
+}
+
+StringBuilder *StringBuilder::Reserve(StringBuilder *builder, uint32_t count, bool utf16, LanguageContext ctx,
+                                      PandaVM *vm, Array **buffer, uint32_t *length)
+{
+    bool buffer_utf16 = false;
+    if (!builder->CheckBuffer(ctx, buffer, length, &buffer_utf16)) {
+        return nullptr;
+    }
+    uint32_t capacity = *buffer == nullptr ? 0 : (*buffer)->GetLength();
+    bool new_utf16 = buffer_utf16 || utf16;
+    if (*buffer != nullptr && count <= capacity - *length && new_utf16 == buffer_utf16) {
+        return builder;
+    }
+
+    constexpr uint32_t MAX_CAPACITY = String::MAX_LENGTH;
+    if (count > MAX_CAPACITY - *length) {
+        ThrowOutOfMemoryError("StringBuilder capacity exceeds the maximum length of a string");
+        return nullptr;
+    }
+    uint32_t new_capacity = capacity;
+    if (count > capacity - *length) {
+        new_capacity = std::max({*length + count, std::min(capacity, MAX_CAPACITY / 2U) * 2U, MIN_CAPACITY});
+        new_capacity = std::min(new_capacity, MAX_CAPACITY);
+    }
+
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    VMHandle<StringBuilder> builder_handle(thread, builder);
+    VMHandle<Array> buffer_handle(thread, *buffer);
+    Array *new_buffer = Array::Create(GetBufferClass(ctx, new_utf16), new_capacity);
+    if (UNLIKELY(new_buffer == nullptr)) {
+        return nullptr;
+    }
+    builder = builder_handle.GetPtr();
+    Array *old_buffer = buffer_handle.GetPtr();
+    if (*length != 0) {
+        if (new_utf16 && !buffer_utf16) {
+            string_kernels::Widen(GetChars<uint8_t>(old_buffer), GetChars<uint16_t>(new_buffer), *length);
+        } else if (new_utf16) {
+            CopyChars(new_buffer->GetData(), new_capacity * sizeof(uint16_t), old_buffer->GetData(),
+                      *length * sizeof(uint16_t));
+        } else {
+            CopyChars(new_buffer->GetData(), new_capacity, old_buffer->GetData(), *length);
+        }
+    }
+    builder->SetBuffer(new_buffer);
+    *buffer = new_buffer;
+    return builder;
+}
+
+bool StringBuilder::AppendChar(StringBuilder *builder, uint16_t c, LanguageContext ctx, PandaVM *vm)
+{
+    Array *buffer = nullptr;
+    uint32_t length = 0;
+    builder = Reserve(builder, 1U, !String::IsASCIICharacter(c), ctx, vm, &buffer, &length);
+    if (builder == nullptr) {
+        return false;
+    }
+    if (buffer->ClassAddr<Class>()->GetComponentSize() == sizeof(uint16_t)) {
+        GetChars<uint16_t>(buffer)[length] = c;
+    } else {
+        GetChars<uint8_t>(buffer)[length] = static_cast<uint8_t>(c);
+    }
+    builder->SetLength(length + 1U);
+    return true;
+}
+
+bool StringBuilder::AppendString(StringBuilder *builder, String *str, LanguageContext ctx, PandaVM *vm)
+{
+    ASSERT(str != nullptr);
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    VMHandle<StringBuilder> builder_handle(thread, builder);
+    // Flattening of a rope may trigger GC
+    str = String::Flatten(str);
+    if (UNLIKELY(str == nullptr)) {
+        return false;
+    }
+    uint32_t count = str->GetLength();
+    if (count == 0) {
+        return true;
+    }
+    VMHandle<String> str_handle(thread, str);
+    Array *buffer = nullptr;
+    uint32_t length = 0;
+    builder = Reserve(builder_handle.GetPtr(), count, str->IsUtf16(), ctx, vm, &buffer, &length);
+    if (builder == nullptr) {
+        return false;
+    }
+    str = str_handle.GetPtr();
+    uint32_t free = buffer->GetLength() - length;
+    if (buffer->ClassAddr<Class>()->GetComponentSize() != sizeof(uint16_t)) {
+        CopyChars(GetChars<uint8_t>(buffer) + length, free, str->GetDataMUtf8(), count);
+    } else if (!str->IsUtf16()) {
+        string_kernels::Widen(str->GetDataMUtf8(), GetChars<uint16_t>(buffer) + length, count);
+    } else {
+        CopyChars(GetChars<uint16_t>(buffer) + length, free * sizeof(uint16_t), str->GetDataUtf16(),
+                  count * sizeof(uint16_t));
+    }
+    builder->SetLength(length + count);
+    return true;
+}
+
+bool StringBuilder::AppendAscii(StringBuilder *builder, const char *data, uint32_t count, LanguageContext ctx,
+                                PandaVM *vm)
+{
+    Array *buffer = nullptr;
+    uint32_t length = 0;
+    builder = Reserve(builder, count, false, ctx, vm, &buffer, &length);
+    if (builder == nullptr) {
+        return false;
+    }
+    auto *chars = reinterpret_cast<const uint8_t *>(data);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (buffer->ClassAddr<Class>()->GetComponentSize() == sizeof(uint16_t)) {
+        string_kernels::Widen(chars, GetChars<uint16_t>(buffer) + length, count);
+    } else {
+        CopyChars(GetChars<uint8_t>(buffer) + length, buffer->GetLength() - length, chars, count);
+    }
+    builder->SetLength(length + count);
+    return true;
+}
+
+bool StringBuilder::AppendI64(StringBuilder *builder, int64_t value, LanguageContext ctx, PandaVM *vm)
+{
+    // Sign and 19 digits
+    std::array<char, 20U> digits {};
+    auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    ASSERT(result.ec == std::errc());
+    return AppendAscii(builder, digits.data(), static_cast<uint32_t>(result.ptr - digits.data()), ctx, vm);
+}
+
+bool StringBuilder::AppendF64(StringBuilder *builder, double value, LanguageContext ctx, PandaVM *vm)
+{
+    // Sign, 17 significant digits, point and exponent, for example -2.2250738585072014e-308
+    std::array<char, 32U> chars {};
+    // The shortest representation which is parsed back to the same value
+    auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+    ASSERT(result.ec == std::errc());
+    return AppendAscii(builder, chars.data(), static_cast<uint32_t>(result.ptr - chars.data()), ctx, vm);
+}
+
+String *StringBuilder::ToString(StringBuilder *builder, LanguageContext ctx, PandaVM *vm)
+{
+    Array *buffer = nullptr;
+    uint32_t length = 0;
+    bool utf16 = false;
+    if (!builder->CheckBuffer(ctx, &buffer, &length, &utf16)) {
+        return nullptr;
+    }
+    if (length == 0) {
+        return String::CreateEmptyString(ctx, vm);
+    }
+    // The buffer may be written by managed code, so the encoding of the string is chosen by its characters
+    bool compressed = utf16 ? String::CanBeCompressed(GetChars<uint16_t>(buffer), length)
+                            : String::CanBeCompressedMUtf8(GetChars<uint8_t>(buffer), length);
+
+    auto thread = ManagedThread::GetCurrent();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread);
+    VMHandle<StringBuilder> builder_handle(thread, builder);
+    VMHandle<Array> buffer_handle(thread, buffer);
+    String *str = String::AllocStringObject(length, compressed, ctx, vm);
+    if (UNLIKELY(str == nullptr)) {
+        return nullptr;
+    }
+    builder = builder_handle.GetPtr();
+    buffer = buffer_handle.GetPtr();
+    if (utf16 && compressed) {
+        String::CopyUtf16AsMUtf8(GetChars<uint16_t>(buffer), str->GetDataMUtf8(), length);
+    } else if (utf16) {
+        CopyChars(str->GetDataUtf16(), length * sizeof(uint16_t), buffer->GetData(), length * sizeof(uint16_t));
+    } else if (compressed) {
+        CopyChars(str->GetDataMUtf8(), length, buffer->GetData(), length);
+    } else {
+        string_kernels::Widen(GetChars<uint8_t>(buffer), str->GetDataUtf16(), length);
+    }
+    builder->SetLength(0);
+    // String is supposed to be a constant object, so all its data should be visible to all threads
+    arch::FullMemoryBarrier();
+    return str;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+}  // namespace panda::coretypes
@@ -251,8 +251,11 @@ void ThrowIllegalAccessException(const PandaString &msg)
 
 void ThrowOutOfMemoryError(ManagedThread *thread, const PandaString &msg)
 {
-    auto ctx = GetLanguageContext(thread);
+    ThrowOutOfMemoryError(GetLanguageContext(thread), thread, msg);
+}
 
+void ThrowOutOfMemoryError(LanguageContext ctx, ManagedThread *thread, const PandaString &msg)
+{
     if (thread->IsThrowingOOM()) {
         thread->SetUsePreAllocObj(true);
     }
@@ -36,6 +36,9 @@ std::ostream &operator<<(std::ostream &os, const GCTaskCause &cause)
         case GCTaskCause::INVALID_CAUSE:
             os << "Invalid";
             break;
+        case GCTaskCause::RELEASE_IDLE_POOLS_CAUSE:
+            os << "ReleaseIdlePools";
+            break;
         case GCTaskCause::PYGOTE_FORK_CAUSE:
             os << "PygoteFork";
             break;
@@ -16,6 +16,9 @@
 #include "libpandabase/macros.h"
 #include "runtime/include/imtable_builder.h"
 #include "runtime/include/class_linker.h"
+#include "runtime/include/runtime.h"
+
+#include <algorithm>
 
 namespace panda {
 void IMTableBuilder::Build(const panda_file::ClassDataAccessor *cda, ITable itable)
@@ -33,12 +36,8 @@ void IMTableBuilder::Build(const panda_file::ClassDataAccessor *cda, ITable itab
 
     // set imtable size rules
     // (1) as interface methods number when it's smaller than fixed IMTABLE_SIZE
-    // (2) as IMTABLE_SIZE when it's in [IMTABLE_SIZE, IMTABLE_SIZE * OVERSIZE_MULTIPLE], eg. [32,64]
-    // (3) as 0 when it's much more bigger than fixed IMTABLE_SIZE, since conflict probability is high and IMTable will
-    // be almost empty
-    SetIMTSize(ifm_num <= Class::IMTABLE_SIZE
-                   ? ifm_num
-                   : (ifm_num <= Class::IMTABLE_SIZE * OVERSIZE_MULTIPLE ? Class::IMTABLE_SIZE : 0));
+    // (2) as IMTABLE_SIZE otherwise, methods sharing a slot are resolved through its conflict table
+    SetIMTSize(std::min(ifm_num, Class::IMTABLE_SIZE));
 }
 
 void IMTableBuilder::Build(ITable itable, bool is_interface)
@@ -55,9 +54,7 @@ void IMTableBuilder::Build(ITable itable, bool is_interface)
     }
 
     // set imtable size rules: the same as function above
-    SetIMTSize(ifm_num <= Class::IMTABLE_SIZE
-                   ? ifm_num
-                   : (ifm_num <= Class::IMTABLE_SIZE * OVERSIZE_MULTIPLE ? Class::IMTABLE_SIZE : 0));
+    SetIMTSize(std::min(ifm_num, Class::IMTABLE_SIZE));
 }
 
 void IMTableBuilder::UpdateClass(Class *klass)
@@ -71,7 +68,7 @@ void IMTableBuilder::UpdateClass(Class *klass)
         return;
     }
 
-    std::array<bool, Class::IMTABLE_SIZE> is_method_conflict = {false};
+    std::array<PandaVector<Class::IMTConflictEntry>, Class::IMTABLE_SIZE> slots;
 
     auto itable = klass->GetITable();
     auto imtable = klass->GetIMT();
@@ -82,32 +79,57 @@ void IMTableBuilder::UpdateClass(Class *klass)
         auto imp_methods = entry.GetMethods();
 
         for (size_t j = 0; j < itf_methods.Size(); j++) {
-            auto imp_method = imp_methods[j];
             auto itf_method_id = klass->GetIMTableIndex(itf_methods[j].GetFileId().GetOffset());
-            if (!is_method_conflict.at(itf_method_id)) {
-                auto ret = AddMethod(imtable, imtable_size, itf_method_id, imp_method);
-                is_method_conflict[itf_method_id] = !ret;
-            }
+            slots[itf_method_id].push_back({&itf_methods[j], imp_methods[j]});
         }
     }
 
+    for (size_t i = 0; i < imtable_size; i++) {
+        imtable[i] = CreateSlot(slots[i]);
+    }
+
 #ifndef NDEBUG
     DumpIMTable(klass);
 #endif  // NDEBUG
 }
 
-bool IMTableBuilder::AddMethod(panda::Span<panda::Method *> imtable, [[maybe_unused]] uint32_t imtable_size,
-                               uint32_t id, Method *method)
+Method *IMTableBuilder::CreateSlot(const PandaVector<Class::IMTConflictEntry> &entries)
 {
-    bool result = false;
-    ASSERT(id < imtable_size);
-    if (imtable[id] == nullptr) {
-        imtable[id] = method;
-        result = true;
-    } else {
-        imtable[id] = nullptr;
+    if (entries.empty()) {
+        return nullptr;
+    }
+    Method *implementation = entries.front().implementation;
+    bool has_conflict = std::any_of(entries.begin(), entries.end(), [implementation](const auto &entry) {
+        return entry.implementation != implementation;
+    });
+    if (!has_conflict) {
+        return implementation;
+    }
+
+    // The table is terminated by a null entry
+    auto *table =
+        Runtime::GetCurrent()->GetInternalAllocator()->AllocArray<Class::IMTConflictEntry>(entries.size() + 1);
+    if (table == nullptr) {
+        // Methods of the slot are resolved through the itable
+        return nullptr;
+    }
+    std::copy(entries.begin(), entries.end(), table);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    table[entries.size()] = {nullptr, nullptr};
+    return Class::MakeIMTConflictSlot(table);
+}
+
+void IMTableBuilder::FreeConflictTables(Class *klass)
+{
+    if (klass->GetIMTSize() == 0U) {
+        return;
+    }
+    auto allocator = Runtime::GetCurrent()->GetInternalAllocator();
+    for (auto *slot : klass->GetIMT()) {
+        if (Class::IsIMTConflictSlot(slot)) {
+            allocator->Free(const_cast<Class::IMTConflictEntry *>(Class::GetIMTConflictTable(slot)));
+        }
     }
-    return result;
 }
 
 void IMTableBuilder::DumpIMTable(Class *klass)
@@ -117,7 +139,16 @@ void IMTableBuilder::DumpIMTable(Class *klass)
     auto imtable_size = klass->GetIMTSize();
     for (size_t i = 0; i < imtable_size; i++) {
         auto method = imtable[i];
-        if (method != nullptr) {
+        if (Class::IsIMTConflictSlot(method)) {
+            size_t conflicts_num = 0;
+            auto *entry = Class::GetIMTConflictTable(method);
+            while (entry->interface_method != nullptr) {
+                entry++;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                conflicts_num++;
+            }
+            LOG(DEBUG, CLASS_LINKER) << "[ " << i << " ] "
+                                     << "CONFLICT TABLE of " << conflicts_num << " methods";
+        } else if (method != nullptr) {
             LOG(DEBUG, CLASS_LINKER) << "[ " << i << " ] " << method->GetFullName();
         } else {
             LOG(DEBUG, CLASS_LINKER) << "[ " << i << " ] "
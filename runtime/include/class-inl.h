@@ -361,6 +361,14 @@ inline Method *Class::ResolveVirtualMethod(const Method *method) const
             auto imtable = GetIMT();
             auto method_id = GetIMTableIndex(method->GetFileId().GetOffset());
             resolved = imtable[method_id];
+            if (UNLIKELY(IsIMTConflictSlot(resolved))) {
+                // The terminating entry has null implementation
+                auto *entry = GetIMTConflictTable(resolved);
+                while (entry->interface_method != nullptr && entry->interface_method != method) {
+                    entry++;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                }
+                resolved = entry->implementation;
+            }
             if (resolved != nullptr) {
                 return resolved;
             }
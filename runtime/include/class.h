@@ -113,6 +113,8 @@ public:
     using UniqId = uint64_t;
     static constexpr uint32_t STRING_CLASS = 1U << 1U;
     static constexpr size_t IMTABLE_SIZE = 32;
+    // Low bit of an IMT slot which points to a conflict table instead of a method
+    static constexpr uintptr_t IMT_CONFLICT_TAG = 1U;
 
     enum {
         DUMPCLASSFULLDETAILS = 1,
@@ -248,6 +250,34 @@ public:
         return method_offset % imt_size_;
     }
 
+    /**
+     * Entry of the conflict table of an IMT slot shared by interface methods with different implementations.
+     * The table ends with an entry with null interface method
+     */
+    struct IMTConflictEntry {
+        const Method *interface_method;
+        Method *implementation;
+    };
+
+    static bool IsIMTConflictSlot(const Method *slot)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return (reinterpret_cast<uintptr_t>(slot) & IMT_CONFLICT_TAG) != 0;
+    }
+
+    static Method *MakeIMTConflictSlot(const IMTConflictEntry *table)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<Method *>(reinterpret_cast<uintptr_t>(table) | IMT_CONFLICT_TAG);
+    }
+
+    static const IMTConflictEntry *GetIMTConflictTable(const Method *slot)
+    {
+        ASSERT(IsIMTConflictSlot(slot));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<const IMTConflictEntry *>(reinterpret_cast<uintptr_t>(slot) & ~IMT_CONFLICT_TAG);
+    }
+
     uint32_t GetAccessFlags() const
     {
         return access_flags_;
@@ -345,6 +345,10 @@ private:
 
     void OnError(ClassLinkerErrorHandler *error_handler, Error error, const PandaString &msg);
 
+    void AddBootClasses(const panda_file::File *pf);
+
+    std::pair<panda_file::File::EntityId, const panda_file::File *> FindBootClass(const uint8_t *descriptor) const;
+
     static bool LayoutFields(Class *klass, Span<Field> fields, bool is_static, ClassLinkerErrorHandler *error_handler);
 
     static constexpr size_t ToExtensionIndex(panda_file::SourceLang lang)
@@ -356,6 +360,12 @@ private:
 
     PandaVector<const panda_file::File *> boot_panda_files_;
 
+    // Maps descriptors of classes defined in the boot panda files to their first definition,
+    // so the boot class lookup doesn't probe the files one by one
+    PandaUnorderedMap<const uint8_t *, std::pair<panda_file::File::EntityId, const panda_file::File *>, utf::Mutf8Hash,
+                      utf::Mutf8Equal>
+        boot_classes_;
+
     struct PandaFileLoadData {
         ClassLinkerContext *context;
         std::unique_ptr<const panda_file::File> pf;
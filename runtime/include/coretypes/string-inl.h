@@ -34,6 +34,10 @@ inline uint16_t String::At(int32_t index)
             return 0;
         }
     }
+    if (UNLIKELY(IsRope())) {
+        String *flat = Flatten(this);
+        return flat == nullptr ? 0 : flat->At<false>(index);
+    }
     if (!IsUtf16()) {
         Span<uint8_t> sp(GetDataMUtf8(), length);
         return sp[index];
@@ -54,8 +54,29 @@ public:
 
     static String *CreateFromString(String *str, LanguageContext ctx, PandaVM *vm);
 
+    /**
+     * \brief Create a non-movable string from MUtf8 data which outlives the string, e.g. data of a panda file
+     * registered in the class linker. If the data is compressible, the string refers to it instead of copying.
+     */
+    static String *CreateFromExternalMUtf8(const uint8_t *mutf8_data, uint32_t utf16_length, bool can_be_compressed,
+                                           LanguageContext ctx, PandaVM *vm);
+
+    /**
+     * \brief Concatenate strings, long results are ropes which refer to both strings instead of copying them
+     * Ropes are flattened by Flatten on the first access to their characters
+     */
     static String *Concat(String *jstring1, String *jstring2, LanguageContext ctx, PandaVM *vm);
 
+    /**
+     * \brief Get a flat string with the characters of the string
+     * The characters of a rope are copied into a new string on the first call, the rope keeps it, so the next calls
+     * don't allocate. Methods which read characters flatten ropes by this method, so for a rope they may trigger GC:
+     * GetMUtf8Length, CopyDataMUtf8, CopyDataUtf16, their region variants and At. Callers of these methods should
+     * hold strings in handles. GetDataMUtf8 and GetDataUtf16 don't allocate, a rope should be flattened before them.
+     * @return the string itself if it isn't a rope, nullptr if the allocation failed
+     */
+    static String *Flatten(String *str);
+
     static String *CreateNewStringFromChars(uint32_t offset, uint32_t length, Array *chararray, LanguageContext ctx,
                                             PandaVM *vm);
 
@@ -69,6 +90,39 @@ public:
 
     Array *ToCharArray(LanguageContext ctx);
 
+    bool IsRope() const
+    {
+        return (length_ & STRING_ROPE_BIT) != 0;
+    }
+
+    /**
+     * \brief Get the left part of a rope, it is replaced by the flat string of the whole rope when it is flattened
+     * Flattening may happen concurrently, so the left part should be read once and checked by IsFlattenedBy
+     */
+    String *GetRopeLeft() const;
+
+    /**
+     * \brief Get the right part of a rope, it is never changed and it is never nullptr
+     */
+    String *GetRopeRight() const;
+
+    /**
+     * \brief Check that the left part of the rope read by GetRopeLeft is the flat string of the whole rope
+     * Parts of ropes are not empty, so a flat left part has the length of the rope only if the rope is flattened
+     */
+    bool IsFlattenedBy(const String *left) const
+    {
+        ASSERT(IsRope());
+        return !left->IsRope() && left->GetLength() == GetLength();
+    }
+
+    uint32_t GetRopeDepth() const;
+
+    bool IsExternal() const
+    {
+        return (length_ & STRING_EXTERNAL_BIT) != 0;
+    }
+
     bool IsUtf16() const
     {
         return compressed_strings_enabled ? ((length_ & STRING_COMPRESSED_BIT) == STRING_UNCOMPRESSED) : true;
@@ -95,6 +149,9 @@ public:
     uint16_t *GetDataUtf16()
     {
         LOG_IF(!IsUtf16(), FATAL, RUNTIME) << "String: Read data as utf16 for mutf8 string";
+        if (UNLIKELY(IsRope())) {
+            return GetFlattenedRope()->data_utf16_;
+        }
         return data_utf16_;
     }
 
@@ -112,11 +169,22 @@ public:
     uint8_t *GetDataMUtf8()
     {
         LOG_IF(IsUtf16(), FATAL, RUNTIME) << "String: Read data as mutf8 for utf16 string";
+        if (UNLIKELY(IsRope())) {
+            return GetFlattenedRope()->GetDataMUtf8();
+        }
+        if (UNLIKELY(IsExternal())) {
+            // External data is read-only, it is never written as strings are constant
+            return ToNativePtr<uint8_t>(GetFieldPrimitive<uintptr_t>(GetDataOffset()));
+        }
         return reinterpret_cast<uint8_t *>(data_utf16_);
     }
 
     size_t GetMUtf8Length()
     {
+        if (UNLIKELY(IsRope())) {
+            String *flat = Flatten(this);
+            return flat == nullptr ? 0 : flat->GetMUtf8Length();
+        }
         if (!IsUtf16()) {
             return GetLength() + 1;  // add place for zero at the end
         }
@@ -144,6 +212,10 @@ public:
         if (start + length > len) {
             return 0;
         }
+        if (UNLIKELY(IsRope())) {
+            String *flat = Flatten(this);
+            return flat == nullptr ? 0 : flat->CopyDataRegionMUtf8(buf, start, length, max_length);
+        }
         if (!IsUtf16()) {
             constexpr size_t MAX_LEN = std::numeric_limits<size_t>::max() / 2 - 1;
             if (length > MAX_LEN) {
@@ -173,6 +245,10 @@ public:
         if (start + length > len) {
             return 0;
         }
+        if (UNLIKELY(IsRope())) {
+            String *flat = Flatten(this);
+            return flat == nullptr ? 0 : flat->CopyDataRegionUtf16(buf, start, length, max_length);
+        }
         if (IsUtf16()) {
             // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
             if (memcpy_s(buf, sizeof(uint16_t) * max_length, GetDataUtf16() + start, ComputeDataSizeUtf16(length)) !=
@@ -186,11 +262,9 @@ public:
 
     uint32_t GetLength() const
     {
-        uint32_t length;
+        uint32_t length = length_ & ~(STRING_ROPE_BIT | STRING_EXTERNAL_BIT);
         if (compressed_strings_enabled) {
-            length = length_ >> 1U;
-        } else {
-            length = length_;
+            length >>= 1U;
         }
         return length;
     }
@@ -201,8 +275,24 @@ public:
         return length_ == 0;
     }
 
+    static constexpr size_t ComputeSizeRope()
+    {
+        return sizeof(String) + ROPE_DEPTH_OFFSET + sizeof(uint32_t);
+    }
+
+    static constexpr size_t ComputeSizeExternal()
+    {
+        return sizeof(String) + sizeof(uintptr_t);
+    }
+
     size_t ObjectSize() const
     {
+        if (IsRope()) {
+            return ComputeSizeRope();
+        }
+        if (IsExternal()) {
+            return ComputeSizeExternal();
+        }
         uint32_t length = GetLength();
         return IsUtf16() ? ComputeSizeUtf16(length) : ComputeSizeMUtf8(length);
     }
@@ -232,6 +322,21 @@ public:
         return STRING_COMPRESSED_BIT;
     }
 
+    static constexpr uint32_t GetRopeLeftOffset()
+    {
+        return GetDataOffset();
+    }
+
+    static constexpr uint32_t GetRopeRightOffset()
+    {
+        return GetDataOffset() + ClassHelper::OBJECT_POINTER_SIZE;
+    }
+
+    static constexpr size_t MIN_ROPE_LENGTH = 16;
+    static constexpr uint32_t MAX_ROPE_DEPTH = 64;
+    // Lengths are stored shifted left by one bit, two highest bits of length_ are flags
+    static constexpr uint32_t MAX_LENGTH = (0x40000000U >> 1U) - 1U;
+
     /**
      * Compares strings by bytes. It doesn't check canonical unicode equivalence.
      */
@@ -270,10 +375,11 @@ protected:
     void SetLength(uint32_t length, bool compressed = false)
     {
         if (compressed_strings_enabled) {
-            ASSERT(length < 0x80000000U);
+            ASSERT(length < (STRING_EXTERNAL_BIT >> 1U));
             // Use 0u for compressed/utf8 expression
             length_ = (length << 1U) | (compressed ? STRING_COMPRESSED : STRING_UNCOMPRESSED);
         } else {
+            ASSERT(length < STRING_EXTERNAL_BIT);
             length_ = length;
         }
     }
@@ -288,8 +394,19 @@ protected:
     static void CopyUtf16AsMUtf8(const uint16_t *utf16_from, uint8_t *mutf8_to, uint32_t utf16_length);
 
 private:
+    // The builder allocates the strings it builds and copies its characters into them
+    friend class StringBuilder;
+
     static bool compressed_strings_enabled;
     static constexpr uint32_t STRING_COMPRESSED_BIT = 0x1;
+    // The highest bit of length_ is set for ropes. The data of a rope is references to its parts and its depth.
+    static constexpr uint32_t STRING_ROPE_BIT = 0x80000000U;
+    static constexpr size_t ROPE_DEPTH_OFFSET = 2U * ClassHelper::OBJECT_POINTER_SIZE;
+    // The next bit is set for compressed strings which data is a pointer to characters outside of the heap
+    static constexpr uint32_t STRING_EXTERNAL_BIT = 0x40000000U;
+    static_assert(MAX_LENGTH < (STRING_EXTERNAL_BIT >> 1U));
+    // Shorter strings take less memory when their characters are copied
+    static constexpr uint32_t MIN_EXTERNAL_LENGTH = sizeof(uintptr_t) + 1U;
     enum CompressedStatus {
         STRING_COMPRESSED,
         STRING_UNCOMPRESSED,
@@ -325,6 +442,11 @@ private:
 
     static String *AllocStringObject(size_t length, bool compressed, LanguageContext ctx, PandaVM *vm = nullptr,
                                      bool movable = true);
+    static String *AllocStringObject(BaseClass *string_class, size_t length, bool compressed, PandaVM *vm,
+                                     bool movable = true);
+    static String *CreateRope(String *left, String *right, LanguageContext ctx, PandaVM *vm);
+
+    String *GetFlattenedRope() const;
 
     // In last bit of length_ we store if this string is compressed or not.
     uint32_t length_;
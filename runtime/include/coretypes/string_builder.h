@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_RUNTIME_INCLUDE_CORETYPES_STRING_BUILDER_H_
+#define PANDA_RUNTIME_INCLUDE_CORETYPES_STRING_BUILDER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libpandabase/mem/mem.h"
+#include "runtime/include/class_helper.h"
+#include "runtime/include/coretypes/array.h"
+#include "runtime/include/coretypes/string.h"
+#include "runtime/include/language_context.h"
+#include "runtime/include/object_header.h"
+
+namespace panda::coretypes {
+
+/**
+ * Mirror of the managed record
+ *
+ *     .record StringBuilder {
+ *         panda.Object buffer
+ *         i32 length
+ *     }
+ *
+ * The characters are stored in the first `length` elements of the buffer, which is an u8[] array while all appended
+ * characters are compressible and an u16[] array otherwise. The length of the array is the capacity of the builder,
+ * it grows twice, so appending takes amortized constant time. The buffer is never exposed as a string: ToString
+ * copies the characters once into a new string, so the result is immutable even if the builder is appended later.
+ * The builder is empty after ToString and keeps the buffer for reuse. The fields are supposed to be written only by
+ * these methods, but managed code can write them concurrently and unverified code can pass any object as a builder.
+ * So the class of the builder, the class of the buffer and the length are checked, and each field is read once:
+ * the characters are accessed only through the checked values. Methods which append may trigger GC, so the builder
+ * and the appended string may be moved by them.
+ */
+class StringBuilder : public ObjectHeader {
+public:
+    static StringBuilder *Cast(ObjectHeader *object)
+    {
+        return static_cast<StringBuilder *>(object);
+    }
+
+    /**
+     * \brief Append characters, return false if an exception is thrown
+     */
+    static bool AppendChar(StringBuilder *builder, uint16_t c, LanguageContext ctx, PandaVM *vm);
+
+    static bool AppendString(StringBuilder *builder, String *str, LanguageContext ctx, PandaVM *vm);
+
+    static bool AppendI64(StringBuilder *builder, int64_t value, LanguageContext ctx, PandaVM *vm);
+
+    /**
+     * \brief Append the shortest representation of the number which is parsed back to the same value
+     */
+    static bool AppendF64(StringBuilder *builder, double value, LanguageContext ctx, PandaVM *vm);
+
+    /**
+     * \brief Get a string with the characters of the builder, the builder is empty after the call
+     * @return the string or nullptr if the allocation failed
+     */
+    static String *ToString(StringBuilder *builder, LanguageContext ctx, PandaVM *vm);
+
+    Array *GetBuffer() const
+    {
+        return static_cast<Array *>(GetFieldObject(GetBufferOffset()));
+    }
+
+    uint32_t GetLength() const
+    {
+        return GetFieldPrimitive<uint32_t>(GetLengthOffset());
+    }
+
+    uint32_t GetCapacity() const
+    {
+        Array *buffer = GetBuffer();
+        return buffer == nullptr ? 0 : buffer->GetLength();
+    }
+
+    // Reference fields are laid out first and right after the header, the class has no base
+    static constexpr uint32_t GetBufferOffset()
+    {
+        return static_cast<uint32_t>(
+            AlignUp(static_cast<size_t>(ObjectHeader::ObjectHeaderSize()), ClassHelper::OBJECT_POINTER_SIZE));
+    }
+
+    static constexpr uint32_t GetLengthOffset()
+    {
+        return GetBufferOffset() + ClassHelper::OBJECT_POINTER_SIZE;
+    }
+
+    /**
+     * \brief Check that the fields of the class are laid out as the mirror expects
+     */
+    static bool CheckLayout(const Class *klass);
+
+    static constexpr uint32_t MIN_CAPACITY = 16U;
+
+private:
+    void SetBuffer(Array *buffer)
+    {
+        SetFieldObject(GetBufferOffset(), buffer);
+    }
+
+    void SetLength(uint32_t length)
+    {
+        SetFieldPrimitive<uint32_t>(GetLengthOffset(), length);
+    }
+
+    /**
+     * \brief Check that the object is a builder, its buffer is a character array and the length does not exceed
+     * the capacity
+     * @param[out] buffer the buffer, may be nullptr
+     * @param[out] length the length which is not greater than the length of the buffer
+     * @param[out] utf16 whether the buffer is an u16[] array
+     * @return false if an exception is thrown
+     */
+    bool CheckBuffer(LanguageContext ctx, Array **buffer, uint32_t *length, bool *utf16) const;
+
+    /**
+     * \brief Make room for `count` more characters, the buffer becomes an u16[] array if `utf16` is true
+     * @param[out] buffer the buffer of the builder which has room for `count` characters after `length`
+     * @param[out] length the checked length of the builder
+     * @return the builder, which may be moved by GC, or nullptr if an exception is thrown
+     */
+    static StringBuilder *Reserve(StringBuilder *builder, uint32_t count, bool utf16, LanguageContext ctx,
+                                  PandaVM *vm, Array **buffer, uint32_t *length);
+
+    static bool AppendAscii(StringBuilder *builder, const char *data, uint32_t count, LanguageContext ctx,
+                            PandaVM *vm);
+};
+
+}  // namespace panda::coretypes
+
+#endif  // PANDA_RUNTIME_INCLUDE_CORETYPES_STRING_BUILDER_H_
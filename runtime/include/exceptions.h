@@ -68,6 +68,8 @@ void ThrowClassCircularityError(const PandaString &class_name, LanguageContext c
 
 void ThrowOutOfMemoryError(ManagedThread *thread, const PandaString &msg);
 
+void ThrowOutOfMemoryError(LanguageContext ctx, ManagedThread *thread, const PandaString &msg);
+
 void ThrowOutOfMemoryError(const PandaString &msg);
 
 void FindCatchBlockInCallStack(ObjectHeader *exception);
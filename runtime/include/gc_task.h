@@ -33,6 +33,7 @@ class GC;
  */
 enum class GCTaskCause : uint8_t {
     INVALID_CAUSE = 0,
+    RELEASE_IDLE_POOLS_CAUSE,  // return idle freed object pools to os, GC is not run
     YOUNG_GC_CAUSE,  // if young space is full
     PYGOTE_FORK_CAUSE,
     STARTUP_COMPLETE_CAUSE,
@@ -19,6 +19,7 @@
 #include "libpandabase/macros.h"
 #include "libpandafile/class_data_accessor.h"
 #include "runtime/include/class-inl.h"
+#include "runtime/include/mem/panda_containers.h"
 #include "runtime/include/mem/panda_smart_pointers.h"
 
 namespace panda {
@@ -27,15 +28,16 @@ class ClassLinker;
 
 class IMTableBuilder {
 public:
-    static constexpr uint32_t OVERSIZE_MULTIPLE = 2;
-
     void Build(const panda_file::ClassDataAccessor *cda, ITable itable);
 
     void Build(ITable itable, bool is_interface);
 
     void UpdateClass(Class *klass);
 
-    bool AddMethod(panda::Span<panda::Method *> imtable, uint32_t imtable_size, uint32_t id, Method *method);
+    /**
+     * \brief Free the conflict tables of the IMT of the class, they are allocated by UpdateClass
+     */
+    static void FreeConflictTables(Class *klass);
 
     void DumpIMTable(Class *klass);
 
@@ -56,6 +58,9 @@ public:
     NO_MOVE_SEMANTIC(IMTableBuilder);
 
 private:
+    // Returns the method if all interface methods of the slot have the same implementation or a conflict table
+    static Method *CreateSlot(const PandaVector<Class::IMTConflictEntry> &entries);
+
     size_t imt_size = 0;
 };
 
@@ -480,6 +480,16 @@ public:
         use_prealloc_obj_ = use_prealloc_obj;
     }
 
+    size_t GetBytesUntilHeapSample() const
+    {
+        return bytes_until_heap_sample_;
+    }
+
+    void SetBytesUntilHeapSample(size_t bytes)
+    {
+        bytes_until_heap_sample_ = bytes;
+    }
+
     void PrintSuspensionStackIfNeeded();
 
     ThreadId GetId() const
@@ -568,6 +578,9 @@ private:
     size_t throwing_oom_count_ {0};
     // CODECHECK-NOLINTNEXTLINE(C_RULE_ID_GLOBAL_VAR_AS_INTERFACE)
     bool use_prealloc_obj_ {false};
+    // Bytes to allocate before the next allocation sample is taken, 0 means the thread has not started sampling yet
+    // CODECHECK-NOLINTNEXTLINE(C_RULE_ID_GLOBAL_VAR_AS_INTERFACE)
+    size_t bytes_until_heap_sample_ {0};
 
     // remove ctx in thread later
     // CODECHECK-NOLINTNEXTLINE(C_RULE_ID_GLOBAL_VAR_AS_INTERFACE)
@@ -355,6 +355,34 @@ public:
      */
     virtual size_t VerifyAllocatorStatus() = 0;
 
+    /**
+     * \brief Get fragmentation of the tenured space which can be compacted by GC.
+     * @return value from 0.0 (free memory can't be coalesced by compaction) to 1.0
+     */
+    virtual double GetCompactableSpaceFragmentation()
+    {
+        return 0.0;
+    }
+
+    /**
+     * \brief Calculate new addresses of objects in the compactable tenured space.
+     * Dead objects must be collected before this call.
+     * @param forward_visitor - called for each object which will be moved
+     */
+    virtual void CalculateCompactedAddresses([[maybe_unused]] const ObjectForwardVisitor &forward_visitor)
+    {
+        LOG(FATAL, ALLOC) << "ObjectAllocatorBase: CalculateCompactedAddresses not supported";
+    }
+
+    /**
+     * \brief Move objects of the compactable tenured space to addresses calculated by CalculateCompactedAddresses.
+     * @param moved_visitor - called for each moved object at its new address
+     */
+    virtual void CompactTenuredSpace([[maybe_unused]] const ObjectVisitor &moved_visitor)
+    {
+        LOG(FATAL, ALLOC) << "ObjectAllocatorBase: CompactTenuredSpace not supported";
+    }
+
     using PygoteAllocator = PygoteSpaceAllocator<ObjectAllocConfig>;  // Allocator for pygote space
     PygoteAllocator *GetPygoteSpaceAllocator()
     {
@@ -775,6 +803,16 @@ public:
         return fail_count;
     }
 
+    /**
+     * Only the movable large object space is compacted,
+     * run slots, humongous and non-movable spaces keep their objects in place.
+     */
+    double GetCompactableSpaceFragmentation() final;
+
+    void CalculateCompactedAddresses(const ObjectForwardVisitor &forward_visitor) final;
+
+    void CompactTenuredSpace(const ObjectVisitor &moved_visitor) final;
+
     [[nodiscard]] void *AllocateLocal(size_t /* size */, Alignment /* align */,
                                       panda::ManagedThread * /* thread */) final
     {
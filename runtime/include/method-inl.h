@@ -264,8 +264,7 @@ void Method::EnumerateTryBlocks(Callback callback) const
 {
     ASSERT(!IsAbstract());
 
-    panda_file::MethodDataAccessor mda(*panda_file_, file_id_);
-    panda_file::CodeDataAccessor cda(*panda_file_, mda.GetCodeId().value());
+    panda_file::CodeDataAccessor cda(*panda_file_, code_id_);
 
     cda.EnumerateTryBlocks(callback);
 }
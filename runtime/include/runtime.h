@@ -284,6 +284,12 @@ public:
 
     void DumpForSigQuit(std::ostream &os);
 
+    /**
+     * \brief Write the profile of the heap profiler to the file from heap-sampling-profile option
+     * @return true if heap sampling is enabled and the profile was written successfully
+     */
+    bool DumpHeapSamplingProfile();
+
     bool IsDumpNativeCrash()
     {
         return is_dump_native_crash_;
@@ -329,12 +335,21 @@ public:
 
     PandaString GetMemoryStatistics();
     PandaString GetFinalStatistics();
+    PandaString GetPandaCacheStatistics();
 
     Expected<LanguageContext, Error> ExtractLanguageContext(const panda_file::File *pf, std::string_view entry_point);
 
 private:
     void NotifyAboutLoadedModules();
 
+    ClassLinkerContext *GetAppOrBootContext();
+
+    void PreloadClasses();
+
+    void RestoreSnapshot();
+
+    void WriteSnapshot();
+
     std::optional<Error> CreateApplicationClassLinkerContext(std::string_view filename, std::string_view entry_point);
 
     bool LoadVerificationConfig();
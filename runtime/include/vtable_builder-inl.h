@@ -20,8 +20,8 @@
 
 namespace panda {
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::BuildForInterface(panda_file::ClassDataAccessor *cda)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::BuildForInterface(panda_file::ClassDataAccessor *cda)
 {
     ASSERT(cda->IsInterface());
     cda->EnumerateMethods([this](panda_file::MethodDataAccessor &mda) {
@@ -37,8 +37,8 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::BuildForInterface(panda
     });
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::BuildForInterface(Span<Method> methods)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::BuildForInterface(Span<Method> methods)
 {
     for (const auto &method : methods) {
         if (method.IsStatic()) {
@@ -53,8 +53,8 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::BuildForInterface(Span<
     }
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::AddBaseMethods(Class *base_class)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::AddBaseMethods(Class *base_class)
 {
     if (base_class != nullptr) {
         auto base_class_vtable = base_class->GetVTable();
@@ -65,9 +65,9 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::AddBaseMethods(Class *b
     }
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::AddClassMethods(panda_file::ClassDataAccessor *cda,
-                                                                         ClassLinkerContext *ctx)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::AddClassMethods(panda_file::ClassDataAccessor *cda,
+                                                                                   ClassLinkerContext *ctx)
 {
     cda->EnumerateMethods([this, ctx](panda_file::MethodDataAccessor &mda) {
         if (mda.IsStatic()) {
@@ -83,8 +83,8 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::AddClassMethods(panda_f
     });
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::AddClassMethods(Span<Method> methods)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::AddClassMethods(Span<Method> methods)
 {
     for (auto &method : methods) {
         if (method.IsStatic()) {
@@ -100,8 +100,8 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::AddClassMethods(Span<Me
     }
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::AddDefaultInterfaceMethods(ITable itable)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::AddDefaultInterfaceMethods(ITable itable)
 {
     for (size_t i = itable.Size(); i > 0; i--) {
         auto entry = itable[i - 1];
@@ -123,9 +123,10 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::AddDefaultInterfaceMeth
     }
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::Build(panda_file::ClassDataAccessor *cda, Class *base_class,
-                                                               ITable itable, ClassLinkerContext *ctx)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::Build(panda_file::ClassDataAccessor *cda,
+                                                                         Class *base_class, ITable itable,
+                                                                         ClassLinkerContext *ctx)
 {
     if (cda->IsInterface()) {
         return BuildForInterface(cda);
@@ -136,9 +137,9 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::Build(panda_file::Class
     AddDefaultInterfaceMethods(itable);
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::Build(Span<Method> methods, Class *base_class, ITable itable,
-                                                               bool is_interface)
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::Build(Span<Method> methods, Class *base_class,
+                                                                         ITable itable, bool is_interface)
 {
     if (is_interface) {
         return BuildForInterface(methods);
@@ -149,8 +150,8 @@ void VTableBuilderImpl<SearchBySignature, OverridePred>::Build(Span<Method> meth
     AddDefaultInterfaceMethods(itable);
 }
 
-template <class SearchBySignature, class OverridePred>
-void VTableBuilderImpl<SearchBySignature, OverridePred>::UpdateClass(Class *klass) const
+template <class SearchBySignature, class OverridePred, class HashPred>
+void VTableBuilderImpl<SearchBySignature, OverridePred, HashPred>::UpdateClass(Class *klass) const
 {
     if (klass->IsInterface()) {
         if (has_default_methods_) {
@@ -46,6 +46,13 @@ public:
 
         bool IsEqualBySignatureAndReturnType(const Proto &other) const;
 
+        /**
+         * \brief Hash of the number of arguments and of the types in the shorty.
+         * Names of the reference types are not hashed, so protos equal by IsEqualBySignatureAndReturnType
+         * have equal hashes
+         */
+        uint32_t GetShortyHash() const;
+
         panda_file::ProtoDataAccessor &GetProtoDataAccessor()
         {
             return pda_;
@@ -78,6 +85,22 @@ public:
     NO_COPY_OPERATOR(MethodInfo);
     NO_MOVE_OPERATOR(MethodInfo);
 
+    struct HashByName {
+        uint32_t operator()(const MethodInfo &method_info) const
+        {
+            return GetHash32String(method_info.GetName().data);
+        }
+    };
+
+    // Can be used only with search predicates which compare signatures of methods
+    struct HashByNameAndSignature {
+        uint32_t operator()(const MethodInfo &method_info) const
+        {
+            auto hash = merge_hashes(GetHash32String(method_info.GetName().data), method_info.proto_.GetShortyHash());
+            return static_cast<uint32_t>(hash);
+        }
+    };
+
     bool IsEqualByNameAndSignature(const MethodInfo &other) const
     {
         return GetName() == other.GetName() && proto_.IsEqualBySignatureAndReturnType(other.proto_);
@@ -177,7 +200,7 @@ private:
     bool is_base_ {false};
 };
 
-template <class SearchPred, class OverridePred>
+template <class SearchPred, class OverridePred, class HashPred = MethodInfo::HashByName>
 class VTable {
 public:
     void AddBaseMethod(const MethodInfo &info)
@@ -209,7 +232,7 @@ public:
     {
         auto vtable = klass->GetVTable();
 
-        for (const auto [method_info, idx] : methods_) {
+        for (const auto &[method_info, idx] : methods_) {
             Method *method = method_info.GetMethod();
             if (method == nullptr) {
                 method = &klass->GetVirtualMethods()[method_info.GetIndex()];
@@ -245,14 +268,7 @@ public:
     }
 
 private:
-    struct HashByName {
-        uint32_t operator()(const MethodInfo &method_info) const
-        {
-            return GetHash32String(method_info.GetName().data);
-        }
-    };
-
-    PandaUnorderedMultiMap<MethodInfo, size_t, HashByName, SearchPred> methods_;
+    PandaUnorderedMultiMap<MethodInfo, size_t, HashPred, SearchPred> methods_;
 };
 
 class VTableBuilder {
@@ -278,7 +294,7 @@ public:
     NO_MOVE_SEMANTIC(VTableBuilder);
 };
 
-template <class SearchBySignature, class OverridePred>
+template <class SearchBySignature, class OverridePred, class HashPred = MethodInfo::HashByName>
 class VTableBuilderImpl : public VTableBuilder {
     void Build(panda_file::ClassDataAccessor *cda, Class *base_class, ITable itable, ClassLinkerContext *ctx) override;
 
@@ -314,7 +330,7 @@ private:
 
     void AddDefaultInterfaceMethods(ITable itable);
 
-    VTable<SearchBySignature, OverridePred> vtable_;
+    VTable<SearchBySignature, OverridePred, HashPred> vtable_;
     size_t num_vmethods_ {0};
     bool has_default_methods_ {false};
     PandaVector<Method *> copied_methods_;
@@ -15,8 +15,10 @@
 
 #include "intrinsics.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <string_view>
@@ -28,14 +30,18 @@
 #include "libpandabase/utils/time.h"
 #include "runtime/include/exceptions.h"
 #include "runtime/include/class_linker.h"
-#include "runtime/include/coretypes/array.h"
+#include "runtime/include/coretypes/array-inl.h"
 #include "runtime/include/coretypes/string.h"
+#include "runtime/include/coretypes/string_builder.h"
 #include "runtime/include/panda_vm.h"
 #include "runtime/include/runtime.h"
 #include "runtime/include/thread.h"
 #include "runtime/include/thread_status.h"
 #include "runtime/interpreter/frame.h"
+#include "runtime/mem/gc/gc.h"
+#include "runtime/mem/gc/gc_barrier_set.h"
 #include "utils/math_helpers.h"
+#include "utils/number_parsers.h"
 
 namespace panda::intrinsics {
 
@@ -172,6 +178,10 @@ void PrintW(T v)
 template <bool is_err>
 void PrintStringInternal(coretypes::String *v)
 {
+    v = coretypes::String::Flatten(v);
+    if (v == nullptr) {
+        return;
+    }
     if (v->IsUtf16()) {
         Span<const char16_t> sp(reinterpret_cast<const char16_t *>(v->GetDataUtf16()), v->GetLength());
         for (wchar_t c : sp) {
@@ -246,34 +256,288 @@ void AssertPrint(uint8_t cond, coretypes::String *s)
     }
 }
 
+/**
+ * Parse the number from the characters of the string in place, without a copy to PandaString
+ */
+template <class R, class Parser>
+static R ParseStringNumber(coretypes::String *s, Parser parser)
+{
+    ASSERT(s != nullptr);
+    // Flattening of a rope allocates, on failure OutOfMemoryError is pending and it is thrown on return to the
+    // caller, the returned value is ignored then
+    s = coretypes::String::Flatten(s);
+    if (UNLIKELY(s == nullptr)) {
+        ASSERT(ManagedThread::GetCurrent()->HasPendingException());
+        return R(0);
+    }
+    if (s->IsUtf16()) {
+        return static_cast<R>(parser(s->GetDataUtf16(), s->GetLength()));
+    }
+    return static_cast<R>(parser(s->GetDataMUtf8(), s->GetLength()));
+}
+
 int32_t ConvertStringToI32(coretypes::String *s)
 {
-    return static_cast<int32_t>(PandaStringToLL(ConvertToString(s)));
+    return ParseStringNumber<int32_t>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseInt64(data, length);
+    });
 }
 
 uint32_t ConvertStringToU32(coretypes::String *s)
 {
-    return static_cast<uint32_t>(PandaStringToULL(ConvertToString(s)));
+    return ParseStringNumber<uint32_t>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseUint64(data, length);
+    });
 }
 
 int64_t ConvertStringToI64(coretypes::String *s)
 {
-    return static_cast<int64_t>(PandaStringToLL(ConvertToString(s)));
+    return ParseStringNumber<int64_t>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseInt64(data, length);
+    });
 }
 
 uint64_t ConvertStringToU64(coretypes::String *s)
 {
-    return static_cast<uint64_t>(PandaStringToULL(ConvertToString(s)));
+    return ParseStringNumber<uint64_t>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseUint64(data, length);
+    });
 }
 
 float ConvertStringToF32(coretypes::String *s)
 {
-    return PandaStringToF(ConvertToString(s));
+    return ParseStringNumber<float>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseFloat(data, length);
+    });
 }
 
 double ConvertStringToF64(coretypes::String *s)
 {
-    return PandaStringToD(ConvertToString(s));
+    return ParseStringNumber<double>(s, [](auto *data, size_t length) {
+        return number_parsers::ParseDouble(data, length);
+    });
+}
+
+/**
+ * Check that [pos, pos + count) is a range of the array, otherwise throw ArrayIndexOutOfBoundsException
+ */
+static bool CheckArrayRange(const coretypes::Array *array, int32_t pos, int32_t count)
+{
+    auto length = array->GetLength();
+    if (count < 0) {
+        panda::ThrowArrayIndexOutOfBoundsException(count, length);
+        return false;
+    }
+    if (pos < 0 || static_cast<int64_t>(pos) + count > length) {
+        // Report the first index which would be accessed out of the array
+        auto idx = pos < 0 ? pos : std::max<int64_t>(pos, length);
+        panda::ThrowArrayIndexOutOfBoundsException(static_cast<coretypes::array_ssize_t>(idx), length);
+        return false;
+    }
+    return true;
+}
+
+static void *GetArrayElementAddr(coretypes::Array *array, int32_t pos, size_t elem_size)
+{
+    return ToVoidPtr(ToUintPtr(array->GetData()) + static_cast<size_t>(pos) * elem_size);
+}
+
+/**
+ * Issue the pre barriers for the references which are going to be overwritten in [pos, pos + count)
+ */
+static void PreBarrierArrayRange(mem::GCBarrierSet *barrier_set, coretypes::Array *array, int32_t pos, int32_t count)
+{
+    if (mem::IsEmptyBarrier(barrier_set->GetPreType())) {
+        return;
+    }
+    for (int32_t i = pos; i < pos + count; i++) {
+        auto *pre_val = array->Get<ObjectHeader *>(i);
+        if (pre_val != nullptr) {
+            barrier_set->PreBarrier(GetArrayElementAddr(array, i, sizeof(object_pointer_type)), pre_val);
+        }
+    }
+}
+
+static void PostBarrierArrayRange(mem::GCBarrierSet *barrier_set, coretypes::Array *array)
+{
+    if (!mem::IsEmptyBarrier(barrier_set->GetPostType())) {
+        barrier_set->PostBarrierArrayWrite(array, array->ObjectSize());
+    }
+}
+
+void ArrayCopy(ObjectHeader *src, int32_t src_pos, ObjectHeader *dst, int32_t dst_pos, int32_t count)
+{
+    if (src == nullptr || dst == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    auto *src_class = src->ClassAddr<Class>();
+    auto *dst_class = dst->ClassAddr<Class>();
+    if (!src_class->IsArrayClass() || !dst_class->IsArrayClass() ||
+        src_class->IsObjectArrayClass() != dst_class->IsObjectArrayClass() ||
+        (!src_class->IsObjectArrayClass() && src_class != dst_class)) {
+        panda::ThrowArrayStoreException(dst_class, src_class);
+        return;
+    }
+    auto *src_array = static_cast<coretypes::Array *>(src);
+    auto *dst_array = static_cast<coretypes::Array *>(dst);
+    if (!CheckArrayRange(src_array, src_pos, count) || !CheckArrayRange(dst_array, dst_pos, count) || count == 0) {
+        return;
+    }
+
+    size_t elem_size = src_class->GetComponentSize();
+    if (!src_class->IsObjectArrayClass()) {
+        (void)memmove(GetArrayElementAddr(dst_array, dst_pos, elem_size),
+                      GetArrayElementAddr(src_array, src_pos, elem_size), static_cast<size_t>(count) * elem_size);
+        return;
+    }
+
+    auto *barrier_set = ManagedThread::GetCurrent()->GetVM()->GetGC()->GetBarrierSet();
+    auto *dst_component = dst_class->GetComponentType();
+    PreBarrierArrayRange(barrier_set, dst_array, dst_pos, count);
+    if (dst_component->IsAssignableFrom(src_class->GetComponentType())) {
+        (void)memmove(GetArrayElementAddr(dst_array, dst_pos, elem_size),
+                      GetArrayElementAddr(src_array, src_pos, elem_size), static_cast<size_t>(count) * elem_size);
+        PostBarrierArrayRange(barrier_set, dst_array);
+        return;
+    }
+
+    // Arrays are different here, so they don't overlap. Elements before the first one failed the store check are copied
+    int32_t copied = 0;
+    ObjectHeader *elem = nullptr;
+    for (; copied < count; copied++) {
+        elem = src_array->Get<ObjectHeader *>(src_pos + copied);
+        if (elem != nullptr && !dst_component->IsAssignableFrom(elem->ClassAddr<Class>())) {
+            break;
+        }
+        dst_array->Set<ObjectHeader *, false>(dst_pos + copied, elem);
+    }
+    if (copied > 0) {
+        PostBarrierArrayRange(barrier_set, dst_array);
+    }
+    if (copied < count) {
+        panda::ThrowArrayStoreException(dst_class, elem->ClassAddr<Class>());
+    }
+}
+
+uint8_t ArrayEquals(ObjectHeader *lhs, int32_t lhs_pos, ObjectHeader *rhs, int32_t rhs_pos, int32_t count)
+{
+    if (lhs == nullptr || rhs == nullptr) {
+        panda::ThrowNullPointerException();
+        return 0;
+    }
+    auto *lhs_class = lhs->ClassAddr<Class>();
+    auto *rhs_class = rhs->ClassAddr<Class>();
+    if (!lhs_class->IsArrayClass() || !rhs_class->IsArrayClass()) {
+        panda::ThrowIllegalArgumentException("Argument is not an array");
+        return 0;
+    }
+    auto *lhs_array = static_cast<coretypes::Array *>(lhs);
+    auto *rhs_array = static_cast<coretypes::Array *>(rhs);
+    if (!CheckArrayRange(lhs_array, lhs_pos, count) || !CheckArrayRange(rhs_array, rhs_pos, count)) {
+        return 0;
+    }
+    // Reference arrays of different types may hold the same references, primitive arrays must have the same type
+    if (lhs_class->IsObjectArrayClass() != rhs_class->IsObjectArrayClass() ||
+        (!lhs_class->IsObjectArrayClass() && lhs_class != rhs_class)) {
+        return 0;
+    }
+    // Elements are compared by their representation: references by identity, floating-point values bitwise
+    size_t elem_size = lhs_class->GetComponentSize();
+    return static_cast<uint8_t>(memcmp(GetArrayElementAddr(lhs_array, lhs_pos, elem_size),
+                                       GetArrayElementAddr(rhs_array, rhs_pos, elem_size),
+                                       static_cast<size_t>(count) * elem_size) == 0);
+}
+
+/**
+ * Check that the array has the expected component type, otherwise throw ArrayStoreException. Managed code is not
+ * verified, so it may pass an array of another type or an object which is not an array at all.
+ */
+static bool CheckArrayComponentType(coretypes::Array *array, panda_file::Type::TypeId component_type)
+{
+    auto *array_class = array->ClassAddr<Class>();
+    if (UNLIKELY(!array_class->IsArrayClass() ||
+                 array_class->GetComponentType()->GetType().GetId() != component_type)) {
+        panda::ThrowArrayStoreException("Array component type does not match the type of the filled value");
+        return false;
+    }
+    return true;
+}
+
+template <panda_file::Type::TypeId component_type, class T>
+static void ArrayFill(coretypes::Array *array, T value, int32_t pos, int32_t count)
+{
+    if (array == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    if (!CheckArrayComponentType(array, component_type)) {
+        return;
+    }
+    ASSERT(array->ClassAddr<Class>()->GetComponentSize() == sizeof(T));
+    if (!CheckArrayRange(array, pos, count)) {
+        return;
+    }
+    std::fill_n(static_cast<T *>(GetArrayElementAddr(array, pos, sizeof(T))), count, value);
+}
+
+void ArrayFillI8(coretypes::Array *array, int8_t value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::I8>(array, value, pos, count);
+}
+
+void ArrayFillI16(coretypes::Array *array, int16_t value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::I16>(array, value, pos, count);
+}
+
+void ArrayFillU16(coretypes::Array *array, uint16_t value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::U16>(array, value, pos, count);
+}
+
+void ArrayFillI32(coretypes::Array *array, int32_t value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::I32>(array, value, pos, count);
+}
+
+void ArrayFillI64(coretypes::Array *array, int64_t value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::I64>(array, value, pos, count);
+}
+
+void ArrayFillF32(coretypes::Array *array, float value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::F32>(array, value, pos, count);
+}
+
+void ArrayFillF64(coretypes::Array *array, double value, int32_t pos, int32_t count)
+{
+    ArrayFill<panda_file::Type::TypeId::F64>(array, value, pos, count);
+}
+
+void ArrayFillObject(coretypes::Array *array, ObjectHeader *value, int32_t pos, int32_t count)
+{
+    if (array == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    if (!CheckArrayComponentType(array, panda_file::Type::TypeId::REFERENCE)) {
+        return;
+    }
+    auto *array_class = array->ClassAddr<Class>();
+    if (value != nullptr && !array_class->GetComponentType()->IsAssignableFrom(value->ClassAddr<Class>())) {
+        panda::ThrowArrayStoreException(array_class, value->ClassAddr<Class>());
+        return;
+    }
+    if (!CheckArrayRange(array, pos, count) || count == 0) {
+        return;
+    }
+    auto *barrier_set = ManagedThread::GetCurrent()->GetVM()->GetGC()->GetBarrierSet();
+    PreBarrierArrayRange(barrier_set, array, pos, count);
+    std::fill_n(static_cast<object_pointer_type *>(GetArrayElementAddr(array, pos, sizeof(object_pointer_type))),
+                count, ToObjPtrType(value));
+    PostBarrierArrayRange(barrier_set, array);
 }
 
 // Need for java.lang.Runtime
@@ -288,6 +552,56 @@ void SystemExit(int32_t status)
     RuntimeExit(status);
 }
 
+static LanguageContext GetCoreLanguageContext()
+{
+    return Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+}
+
+void StringBuilderAppendChar(coretypes::StringBuilder *builder, uint16_t c)
+{
+    if (builder == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    coretypes::StringBuilder::AppendChar(builder, c, GetCoreLanguageContext(), ManagedThread::GetCurrent()->GetVM());
+}
+
+void StringBuilderAppendString(coretypes::StringBuilder *builder, coretypes::String *s)
+{
+    if (builder == nullptr || s == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    coretypes::StringBuilder::AppendString(builder, s, GetCoreLanguageContext(), ManagedThread::GetCurrent()->GetVM());
+}
+
+void StringBuilderAppendI64(coretypes::StringBuilder *builder, int64_t v)
+{
+    if (builder == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    coretypes::StringBuilder::AppendI64(builder, v, GetCoreLanguageContext(), ManagedThread::GetCurrent()->GetVM());
+}
+
+void StringBuilderAppendF64(coretypes::StringBuilder *builder, double v)
+{
+    if (builder == nullptr) {
+        panda::ThrowNullPointerException();
+        return;
+    }
+    coretypes::StringBuilder::AppendF64(builder, v, GetCoreLanguageContext(), ManagedThread::GetCurrent()->GetVM());
+}
+
+coretypes::String *StringBuilderToString(coretypes::StringBuilder *builder)
+{
+    if (builder == nullptr) {
+        panda::ThrowNullPointerException();
+        return nullptr;
+    }
+    return coretypes::StringBuilder::ToString(builder, GetCoreLanguageContext(), ManagedThread::GetCurrent()->GetVM());
+}
+
 void ObjectMonitorEnter(ObjectHeader *header)
 {
     if (header == nullptr) {
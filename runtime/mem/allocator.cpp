@@ -380,6 +380,24 @@ void ObjectAllocatorGen<MTMode>::Collect(const GCObjectVisitor &gc_object_visito
     }
 }
 
+template <MTModeT MTMode>
+double ObjectAllocatorGen<MTMode>::GetCompactableSpaceFragmentation()
+{
+    return large_object_allocator_->GetFragmentation();
+}
+
+template <MTModeT MTMode>
+void ObjectAllocatorGen<MTMode>::CalculateCompactedAddresses(const ObjectForwardVisitor &forward_visitor)
+{
+    large_object_allocator_->CalculateCompactedAddresses(forward_visitor);
+}
+
+template <MTModeT MTMode>
+void ObjectAllocatorGen<MTMode>::CompactTenuredSpace(const ObjectVisitor &moved_visitor)
+{
+    large_object_allocator_->Compact(moved_visitor);
+}
+
 template <MTModeT MTMode>
 size_t ObjectAllocatorNoGen<MTMode>::GetRegularObjectMaxSize()
 {
@@ -16,6 +16,8 @@
 #ifndef PANDA_RUNTIME_MEM_FREELIST_ALLOCATOR_INL_H_
 #define PANDA_RUNTIME_MEM_FREELIST_ALLOCATOR_INL_H_
 
+#include <securec.h>
+
 #include "libpandabase/utils/logger.h"
 #include "runtime/mem/alloc_config.h"
 #include "runtime/mem/freelist_allocator.h"
@@ -346,7 +348,7 @@ void FreeListAllocator<AllocConfigT, LockConfigT>::VisitAndRemoveFreePools(const
                 << " bytes with the first block at addr " << std::hex << first_block << " and size " << std::dec
                 << first_block->GetSize();
             auto free_header = static_cast<FreeListHeader *>(first_block);
-            free_header->PopFromFreeList();
+            segregated_list_.RemoveMemoryBlock(free_header);
             MemoryPoolHeader *next = current_pool->GetNext();
             MemoryPoolHeader *prev = current_pool->GetPrev();
             if (next != nullptr) {
@@ -375,6 +377,123 @@ void FreeListAllocator<AllocConfigT, LockConfigT>::VisitAndRemoveFreePools(const
     segregated_list_.ReleaseFreeMemoryBlocks();
 }
 
+template <typename AllocConfigT, typename LockConfigT>
+double FreeListAllocator<AllocConfigT, LockConfigT>::GetFragmentation()
+{
+    os::memory::ReadLockHolder rlock(alloc_free_lock_);
+    size_t free_size = 0;
+    size_t compactable_free_size = 0;
+    for (MemoryPoolHeader *pool = mempool_head_; pool != nullptr; pool = pool->GetNext()) {
+        size_t pool_free_size = 0;
+        size_t largest_free_block_size = 0;
+        for (MemoryBlockHeader *block = pool->GetFirstMemoryHeader(); block != nullptr;
+             block = block->GetNextHeader()) {
+            if (!block->IsUsed()) {
+                pool_free_size += block->GetSize();
+                largest_free_block_size = std::max(largest_free_block_size, block->GetSize());
+            }
+        }
+        free_size += pool_free_size;
+        compactable_free_size += pool_free_size - largest_free_block_size;
+    }
+    if (free_size == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(compactable_free_size) / free_size;
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+template <typename ObjectForwardVisitor>
+void FreeListAllocator<AllocConfigT, LockConfigT>::CalculateCompactedAddresses(
+    const ObjectForwardVisitor &forward_visitor)
+{
+    LOG_FREELIST_ALLOCATOR(DEBUG) << "Calculating compacted addresses started";
+    os::memory::WriteLockHolder wlock(alloc_free_lock_);
+    for (MemoryPoolHeader *pool = mempool_head_; pool != nullptr; pool = pool->GetNext()) {
+        // The address where the next used block will be slid to
+        uintptr_t compacted_addr = ToUintPtr(pool->GetFirstMemoryHeader());
+        for (MemoryBlockHeader *block = pool->GetFirstMemoryHeader(); block != nullptr;
+             block = block->GetNextHeader()) {
+            if (!block->IsUsed()) {
+                continue;
+            }
+            if (!IsBlockPinned(block) && compacted_addr != ToUintPtr(block)) {
+                forward_visitor(static_cast<ObjectHeader *>(block->GetMemory()),
+                                ToNativePtr<ObjectHeader>(compacted_addr + sizeof(MemoryBlockHeader)));
+            } else {
+                compacted_addr = ToUintPtr(block);
+            }
+            compacted_addr += sizeof(MemoryBlockHeader) + block->GetSize();
+        }
+    }
+    LOG_FREELIST_ALLOCATOR(DEBUG) << "Calculating compacted addresses finished";
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+template <typename ObjectVisitor>
+void FreeListAllocator<AllocConfigT, LockConfigT>::Compact(const ObjectVisitor &moved_visitor)
+{
+    LOG_FREELIST_ALLOCATOR(DEBUG) << "Compaction started";
+    os::memory::WriteLockHolder wlock(alloc_free_lock_);
+    for (MemoryPoolHeader *pool = mempool_head_; pool != nullptr; pool = pool->GetNext()) {
+        // Free blocks are created again from the gaps between slid blocks,
+        // so remove them from segregated list before they are overwritten
+        for (MemoryBlockHeader *block = pool->GetFirstMemoryHeader(); block != nullptr;
+             block = block->GetNextHeader()) {
+            if (!block->IsUsed()) {
+                segregated_list_.RemoveMemoryBlock(static_cast<FreeListHeader *>(block));
+            }
+        }
+        AllocConfigT::RemoveCrossingMapForMemory(pool, pool->GetSize());
+        AllocConfigT::InitializeCrossingMapForMemory(pool, pool->GetSize());
+
+        MemoryBlockHeader *prev_block = nullptr;
+        uintptr_t compacted_addr = ToUintPtr(pool->GetFirstMemoryHeader());
+        MemoryBlockHeader *block = pool->GetFirstMemoryHeader();
+        while (block != nullptr) {
+            // Read the next header before the current block is overwritten
+            MemoryBlockHeader *next_block = block->GetNextHeader();
+            if (!block->IsUsed()) {
+                block = next_block;
+                continue;
+            }
+            MemoryBlockHeader *new_block = block;
+            if (IsBlockPinned(block) || compacted_addr == ToUintPtr(block)) {
+                if (compacted_addr != ToUintPtr(block)) {
+                    prev_block = CreateFreeMemoryBlock(compacted_addr, ToUintPtr(block), prev_block);
+                }
+                block->SetPrevHeader(prev_block);
+            } else {
+                size_t block_size = block->GetSize();
+                void *old_memory = block->GetMemory();
+                // The gap before the block is at least as big as a memory block header,
+                // so the new header doesn't overlap with the moved memory
+                new_block = ToNativePtr<MemoryBlockHeader>(compacted_addr);
+                new_block->Initialize(block_size, prev_block);
+                new_block->SetUsed();
+                ASAN_UNPOISON_MEMORY_REGION(old_memory, block_size);
+                ASAN_UNPOISON_MEMORY_REGION(new_block->GetMemory(), block_size);
+                (void)memmove_s(new_block->GetMemory(), block_size, old_memory, block_size);
+            }
+            void *memory = new_block->GetMemory();
+            size_t memory_size = ToUintPtr(new_block) + new_block->GetSize() + sizeof(MemoryBlockHeader) -
+                                 ToUintPtr(memory);
+            AllocConfigT::AddToCrossingMap(memory, memory_size);
+            if (new_block != block) {
+                moved_visitor(static_cast<ObjectHeader *>(memory));
+            }
+            compacted_addr = ToUintPtr(new_block) + sizeof(MemoryBlockHeader) + new_block->GetSize();
+            prev_block = new_block;
+            block = next_block;
+        }
+        uintptr_t pool_end = ToUintPtr(pool) + pool->GetSize();
+        if (compacted_addr != pool_end) {
+            CreateFreeMemoryBlock(compacted_addr, pool_end, prev_block)->SetLastBlockInPool();
+        }
+    }
+    LOG_FREELIST_ALLOCATOR(DEBUG) << "Compaction finished";
+}
+
 template <typename AllocConfigT, typename LockConfigT>
 template <typename MemVisitor>
 void FreeListAllocator<AllocConfigT, LockConfigT>::IterateOverObjectsInRange(const MemVisitor &mem_visitor,
@@ -474,6 +593,18 @@ freelist::MemoryBlockHeader *FreeListAllocator<AllocConfigT, LockConfigT>::Split
     return second_block;
 }
 
+template <typename AllocConfigT, typename LockConfigT>
+freelist::MemoryBlockHeader *FreeListAllocator<AllocConfigT, LockConfigT>::CreateFreeMemoryBlock(
+    uintptr_t begin, uintptr_t end, MemoryBlockHeader *prev_header)
+{
+    ASSERT(end - begin >= FREELIST_ALLOCATOR_MIN_SIZE + sizeof(MemoryBlockHeader));
+    auto free_block = ToNativePtr<MemoryBlockHeader>(begin);
+    free_block->Initialize(end - begin - sizeof(MemoryBlockHeader), prev_header);
+    ASAN_POISON_MEMORY_REGION(free_block, end - begin);
+    AddToSegregatedList(static_cast<FreeListHeader *>(free_block));
+    return free_block;
+}
+
 template <typename AllocConfigT, typename LockConfigT>
 freelist::MemoryBlockHeader *FreeListAllocator<AllocConfigT, LockConfigT>::GetFreeListMemoryHeader(void *mem)
 {
@@ -524,7 +655,7 @@ freelist::FreeListHeader *FreeListAllocator<AllocConfigT, LockConfigT>::TryToCoa
         LOG_FREELIST_ALLOCATOR(DEBUG) << "Coalesce with next block";
         auto next_free_list = static_cast<FreeListHeader *>(memory_header->GetNextHeader());
         // Pop this free list element from the list
-        next_free_list->PopFromFreeList();
+        segregated_list_.RemoveMemoryBlock(next_free_list);
         // Combine these two blocks together
         CoalesceMemoryBlocks(memory_header, static_cast<MemoryBlockHeader *>(next_free_list));
     }
@@ -533,7 +664,7 @@ freelist::FreeListHeader *FreeListAllocator<AllocConfigT, LockConfigT>::TryToCoa
         LOG_FREELIST_ALLOCATOR(DEBUG) << "Coalesce with prev block";
         auto prev_free_list = static_cast<FreeListHeader *>(memory_header->GetPrevHeader());
         // Pop this free list element from the list
-        prev_free_list->PopFromFreeList();
+        segregated_list_.RemoveMemoryBlock(prev_free_list);
         // Combine these two blocks together
         CoalesceMemoryBlocks(static_cast<MemoryBlockHeader *>(prev_free_list), memory_header);
         memory_header = static_cast<MemoryBlockHeader *>(prev_free_list);
@@ -563,7 +694,7 @@ freelist::MemoryBlockHeader *FreeListAllocator<AllocConfigT, LockConfigT>::GetFr
     }
     FreeListHeader *mem_block = segregated_list_.FindMemoryBlock(aligned_size);
     if (mem_block != nullptr) {
-        mem_block->PopFromFreeList();
+        segregated_list_.RemoveMemoryBlock(mem_block);
         ASSERT((AlignUp(ToUintPtr(mem_block->GetMemory()), GetAlignmentInBytes(align)) -
                 ToUintPtr(mem_block->GetMemory()) + size) <= mem_block->GetSize());
     }
@@ -586,90 +717,36 @@ ATTRIBUTE_NO_SANITIZE_ADDRESS void FreeListAllocator<AllocConfigT, LockConfigT>:
 template <typename AllocConfigT, typename LockConfigT>
 void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::AddMemoryBlock(FreeListHeader *freelist_header)
 {
-    size_t size = freelist_header->GetSize();
-    size_t index = GetIndex(size);
-    if (SEGREGATED_LIST_FAST_INSERT) {
-        free_memory_blocks_[index].InsertNext(freelist_header);
-    } else {
-        FreeListHeader *most_suitable = FindTheMostSuitableBlockInOrderedList(index, size);
-        // The most suitable block with such must be equal to this size,
-        // or the last with the bigger size in the ordered list,
-        // or nullptr
-        if (most_suitable == nullptr) {
-            free_memory_blocks_[index].InsertNext(freelist_header);
-        } else {
-            most_suitable->InsertNext(freelist_header);
-        }
+    size_t index = GetIndex(freelist_header->GetSize());
+    free_memory_blocks_[index].InsertNext(freelist_header);
+    MarkListAsNonEmpty(index);
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::RemoveMemoryBlock(FreeListHeader *freelist_header)
+{
+    // The block size must not be changed since this block has been added into the list
+    size_t index = GetIndex(freelist_header->GetSize());
+    freelist_header->PopFromFreeList();
+    if (GetFirstBlock(index) == nullptr) {
+        MarkListAsEmpty(index);
     }
 }
 
 template <typename AllocConfigT, typename LockConfigT>
 freelist::FreeListHeader *FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::FindMemoryBlock(size_t size)
 {
-    size_t index = GetIndex(size);
-    FreeListHeader *head = GetFirstBlock(index);
+    // All blocks from the lists starting from this index are suitable for this size,
+    // so we just take the first block from the first non-empty list.
+    size_t index = FindNonEmptyList(GetIndexRoundedUp(size));
     FreeListHeader *suitable_block = nullptr;
-    if (head != nullptr) {
-        // We have some memory in this range. Try to find suitable block.
-        if (SEGREGATED_LIST_FAST_INSERT) {
-            // We don't have any order in inserting blocks,
-            // and we need to iterate over the whole list
-            FreeListHeader *current = head;
-            while (current != nullptr) {
-                if (current->GetSize() < size) {
-                    current = current->GetNextFree();
-                    continue;
-                }
-
-                if (SEGREGATED_LIST_FAST_EXTRACT) {
-                    suitable_block = current;
-                    break;
-                }
-
-                if (suitable_block != nullptr) {
-                    suitable_block = current;
-                } else {
-                    if (suitable_block->GetSize() > current->GetSize()) {
-                        suitable_block = current;
-                    }
-                }
-
-                if (suitable_block->GetSize() == size) {
-                    break;
-                }
-                current = current->GetNextFree();
-            }
-        } else {
-            // All blocks in this list are in descending order.
-            // We can check the first one to determine if we have a block
-            // with this size or not.
-            if (head->GetSize() >= size) {
-                if (SEGREGATED_LIST_FAST_EXTRACT) {
-                    // Just get the first element
-                    suitable_block = head;
-                } else {
-                    // Try to find the mist suitable memory for this size.
-                    suitable_block = FindTheMostSuitableBlockInOrderedList(index, size);
-                }
-            }
-        }
+    if (index < SEGREGATED_LIST_SIZE) {
+        // The last list can contain blocks with size less than required one
+        suitable_block = FindSuitableBlockInList(index, size);
     }
-
     if (suitable_block == nullptr) {
-        // We didn't find the block in the head list. Try to find block in other lists.
-        index++;
-        while (index < SEGREGATED_LIST_SIZE) {
-            if (GetFirstBlock(index) != nullptr) {
-                if (SEGREGATED_LIST_FAST_INSERT || SEGREGATED_LIST_FAST_EXTRACT) {
-                    // Just get the first one
-                    suitable_block = GetFirstBlock(index);
-                } else {
-                    suitable_block = FindTheMostSuitableBlockInOrderedList(index, size);
-                }
-                break;
-            }
-            index++;
-        }
+        // The list for this size can still contain a suitable block
+        suitable_block = FindSuitableBlockInList(GetIndex(size), size);
     }
 
     if (suitable_block != nullptr) {
@@ -682,7 +759,7 @@ freelist::FreeListHeader *FreeListAllocator<AllocConfigT, LockConfigT>::Segregat
 template <typename AllocConfigT, typename LockConfigT>
 void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::ReleaseFreeMemoryBlocks()
 {
-    for (size_t index = 0; index < SEGREGATED_LIST_SIZE; index++) {
+    for (size_t index = FindNonEmptyList(0); index < SEGREGATED_LIST_SIZE; index = FindNonEmptyList(index + 1)) {
         FreeListHeader *current = GetFirstBlock(index);
         while (current != nullptr) {
             size_t block_size = current->GetSize();
@@ -700,43 +777,83 @@ void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::ReleaseFreeMe
 }
 
 template <typename AllocConfigT, typename LockConfigT>
-freelist::FreeListHeader *
-FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::FindTheMostSuitableBlockInOrderedList(size_t index,
-                                                                                                    size_t size)
+freelist::FreeListHeader *FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::FindSuitableBlockInList(
+    size_t index, size_t size)
 {
-    static_assert(!SEGREGATED_LIST_FAST_INSERT);
     FreeListHeader *current = GetFirstBlock(index);
-    if (current == nullptr) {
-        return nullptr;
+    while ((current != nullptr) && (current->GetSize() < size)) {
+        current = current->GetNextFree();
     }
-    size_t current_size = current->GetSize();
-    if (current_size < size) {
-        return nullptr;
-    }
-    while (current_size != size) {
-        FreeListHeader *next = current->GetNextFree();
-        if (next == nullptr) {
-            // the current free list header is the last in the list.
-            break;
-        }
-        size_t next_size = next->GetSize();
-        if (next_size < size) {
-            // the next free list header is less than size,
-            // so we don't need to iterate anymore.
-            break;
+    return current;
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+ATTRIBUTE_NO_SANITIZE_ADDRESS size_t
+FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::FindNonEmptyList(size_t start_index)
+{
+    if (start_index >= SEGREGATED_LIST_SIZE) {
+        return SEGREGATED_LIST_SIZE;
+    }
+    size_t first_level = start_index / SECOND_LEVEL_LISTS_COUNT;
+    size_t second_level = start_index % SECOND_LEVEL_LISTS_COUNT;
+    uint32_t second_level_map = second_level_bitmaps_[first_level] & (~0U << second_level);
+    if (second_level_map == 0) {
+        uint32_t first_level_map = first_level_bitmap_ & (~0U << (first_level + 1U));
+        if (first_level_map == 0) {
+            return SEGREGATED_LIST_SIZE;
         }
-        current = next;
-        current_size = next_size;
+        first_level = static_cast<size_t>(Ctz(first_level_map));
+        second_level_map = second_level_bitmaps_[first_level];
+        ASSERT(second_level_map != 0);
+    }
+    return first_level * SECOND_LEVEL_LISTS_COUNT + static_cast<size_t>(Ctz(second_level_map));
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+ATTRIBUTE_NO_SANITIZE_ADDRESS void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::MarkListAsNonEmpty(
+    size_t index)
+{
+    ASSERT(index < SEGREGATED_LIST_SIZE);
+    size_t first_level = index / SECOND_LEVEL_LISTS_COUNT;
+    second_level_bitmaps_[first_level] |= 1U << (index % SECOND_LEVEL_LISTS_COUNT);
+    first_level_bitmap_ |= 1U << first_level;
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+ATTRIBUTE_NO_SANITIZE_ADDRESS void FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::MarkListAsEmpty(
+    size_t index)
+{
+    ASSERT(index < SEGREGATED_LIST_SIZE);
+    size_t first_level = index / SECOND_LEVEL_LISTS_COUNT;
+    second_level_bitmaps_[first_level] &= ~(1U << (index % SECOND_LEVEL_LISTS_COUNT));
+    if (second_level_bitmaps_[first_level] == 0) {
+        first_level_bitmap_ &= ~(1U << first_level);
     }
-    return current;
 }
 
 template <typename AllocConfigT, typename LockConfigT>
 size_t FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::GetIndex(size_t size)
 {
     ASSERT(size >= FREELIST_ALLOCATOR_MIN_SIZE);
-    size_t index = (size - FREELIST_ALLOCATOR_MIN_SIZE) / SEGREGATED_LIST_FREE_BLOCK_RANGE;
-    return index < SEGREGATED_LIST_SIZE ? index : SEGREGATED_LIST_SIZE - 1;
+    size_t first_level = static_cast<size_t>(std::numeric_limits<size_t>::digits - 1 - Clz(size));
+    if (first_level > FIRST_LEVEL_MAX_POWER) {
+        return SEGREGATED_LIST_SIZE - 1;
+    }
+    size_t second_level = (size >> (first_level - SECOND_LEVEL_BITS)) & (SECOND_LEVEL_LISTS_COUNT - 1U);
+    return (first_level - FIRST_LEVEL_MIN_POWER) * SECOND_LEVEL_LISTS_COUNT + second_level;
+}
+
+template <typename AllocConfigT, typename LockConfigT>
+size_t FreeListAllocator<AllocConfigT, LockConfigT>::SegregatedList::GetIndexRoundedUp(size_t size)
+{
+    ASSERT(size >= FREELIST_ALLOCATOR_MIN_SIZE);
+    size_t first_level = static_cast<size_t>(std::numeric_limits<size_t>::digits - 1 - Clz(size));
+    if (first_level > FIRST_LEVEL_MAX_POWER) {
+        return SEGREGATED_LIST_SIZE - 1;
+    }
+    // Round the size up to the lower bound of the next list
+    size_t list_range = 1U << (first_level - SECOND_LEVEL_BITS);
+    return GetIndex(size + list_range - 1U);
 }
 
 template <typename AllocConfigT, typename LockConfigT>
@@ -21,6 +21,8 @@
 #include "libpandabase/mem/mem.h"
 #include "libpandabase/mem/space.h"
 #include "libpandabase/os/mutex.h"
+#include "libpandabase/utils/bit_utils.h"
+#include "libpandabase/utils/math_helpers.h"
 #include "runtime/mem/freelist.h"
 #include "runtime/mem/runslots.h"
 #include "runtime/mem/lock_config_helper.h"
@@ -29,9 +31,8 @@ namespace panda::mem {
 
 // Minimal size of this allocator is a max size of RunSlots allocator.
 static constexpr size_t PANDA_FREELIST_ALLOCATOR_MIN_SIZE = RunSlots<>::MaxSlotSize();
-static constexpr size_t PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_SIZE = 16;
-static constexpr bool PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_FAST_INSERT = false;
-static constexpr bool PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_FAST_EXTRACT = false;
+// Each power of two range of block sizes is divided into 2^SECOND_LEVEL_BITS segregated lists.
+static constexpr size_t PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_SECOND_LEVEL_BITS = 4;
 
 static constexpr Alignment FREELIST_DEFAULT_ALIGNMENT = DEFAULT_ALIGNMENT;
 
@@ -144,6 +145,35 @@ public:
     template <typename MemVisitor>
     void IterateOverObjectsInRange(const MemVisitor &mem_visitor, void *left_border, void *right_border);
 
+    /**
+     * \brief Returns the part of free memory which can be coalesced into bigger blocks by sliding compaction,
+     * i.e. the part of free memory in each pool which is not inside the largest free block of this pool.
+     * @return value from 0.0 (no fragmentation) to 1.0
+     */
+    double GetFragmentation();
+
+    /**
+     * \brief Calculates new addresses of objects for sliding compaction.
+     * Each object is slid to the lowest free address of its pool preserving the order of objects.
+     * Objects with alignment padding are pinned and never moved.
+     * Objects must not be allocated or freed until Compact call.
+     * @tparam ObjectForwardVisitor
+     * @param forward_visitor - function pointer or functor, which is called with an object and its new address
+     * for each object which will be moved
+     */
+    template <typename ObjectForwardVisitor>
+    void CalculateCompactedAddresses(const ObjectForwardVisitor &forward_visitor);
+
+    /**
+     * \brief Slides objects to the addresses calculated by CalculateCompactedAddresses
+     * and rebuilds free blocks and crossing map of each pool.
+     * @tparam ObjectVisitor
+     * @param moved_visitor - function pointer or functor, which is called for each moved object
+     * at its new address in the same order as forward_visitor in CalculateCompactedAddresses
+     */
+    template <typename ObjectVisitor>
+    void Compact(const ObjectVisitor &moved_visitor);
+
     FreeListAllocatorAdapter<void, AllocConfigT, LockConfigT> Adapter();
 
     /**
@@ -246,23 +276,34 @@ private:
     static constexpr size_t FREELIST_MAX_ALLOC_SIZE =
         ((FREELIST_DEFAULT_MEMORY_POOL_SIZE - sizeof(MemoryPoolHeader)) / 2) - sizeof(MemoryBlockHeader);
 
+    // Two-level segregated fit lists (TLSF-like).
+    // The first level splits block sizes into power of two ranges,
+    // the second level splits each range into SECOND_LEVEL_LISTS_COUNT lists of the same width.
+    // Non-empty lists are tracked in bitmaps, so a suitable list is found in O(1).
     class SegregatedList {
     public:
         void AddMemoryBlock(FreeListHeader *freelist_header);
+        void RemoveMemoryBlock(FreeListHeader *freelist_header);
         FreeListHeader *FindMemoryBlock(size_t size);
         void ReleaseFreeMemoryBlocks();
 
     private:
-        static constexpr size_t SEGREGATED_LIST_SIZE = PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_SIZE;
-        static constexpr size_t SEGREGATED_LIST_FREE_BLOCK_RANGE =
-            (FREELIST_MAX_ALLOC_SIZE - FREELIST_ALLOCATOR_MIN_SIZE) / SEGREGATED_LIST_SIZE;
-        // If it is off, we insert memory in the list in the descending order.
-        static constexpr bool SEGREGATED_LIST_FAST_INSERT = PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_FAST_INSERT;
-        // If it is off, we try to find the most suitable block in the list.
-        static constexpr bool SEGREGATED_LIST_FAST_EXTRACT = PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_FAST_EXTRACT;
-        static_assert(((FREELIST_MAX_ALLOC_SIZE - FREELIST_ALLOCATOR_MIN_SIZE) % SEGREGATED_LIST_SIZE) == 0);
-
-        size_t GetIndex(size_t size);
+        static constexpr size_t SECOND_LEVEL_BITS = PANDA_FREELIST_ALLOCATOR_SEGREGATED_LIST_SECOND_LEVEL_BITS;
+        static constexpr size_t SECOND_LEVEL_LISTS_COUNT = 1U << SECOND_LEVEL_BITS;
+        // Blocks with size less than 2^(FIRST_LEVEL_MIN_POWER + 1) are placed in the first range
+        static constexpr size_t FIRST_LEVEL_MIN_POWER = helpers::math::GetIntLog2(FREELIST_ALLOCATOR_MIN_SIZE);
+        // The biggest free block is a whole memory pool, bigger blocks are placed in the last list
+        static constexpr size_t FIRST_LEVEL_MAX_POWER = helpers::math::GetIntLog2(FREELIST_DEFAULT_MEMORY_POOL_SIZE);
+        static constexpr size_t FIRST_LEVEL_LISTS_COUNT = FIRST_LEVEL_MAX_POWER - FIRST_LEVEL_MIN_POWER + 1;
+        static constexpr size_t SEGREGATED_LIST_SIZE = FIRST_LEVEL_LISTS_COUNT * SECOND_LEVEL_LISTS_COUNT;
+        static_assert(FIRST_LEVEL_MIN_POWER >= SECOND_LEVEL_BITS);
+        static_assert(FIRST_LEVEL_LISTS_COUNT < std::numeric_limits<uint32_t>::digits);
+        static_assert(SECOND_LEVEL_LISTS_COUNT <= std::numeric_limits<uint32_t>::digits);
+
+        static size_t GetIndex(size_t size);
+
+        // Get the first list index which contains blocks with size not less than the required size only.
+        static size_t GetIndexRoundedUp(size_t size);
 
         FreeListHeader *GetFirstBlock(size_t index)
         {
@@ -270,19 +311,27 @@ private:
             return free_memory_blocks_[index].GetNextFree();
         }
 
-        void SetFirstBlock(size_t index, FreeListHeader *new_head)
-        {
-            ASSERT(index < SEGREGATED_LIST_SIZE);
-            free_memory_blocks_[index].SetNextFree(new_head);
-        }
+        // Find the first non-empty list with index not less than the start index.
+        // Returns SEGREGATED_LIST_SIZE if all such lists are empty.
+        size_t FindNonEmptyList(size_t start_index);
 
-        FreeListHeader *FindTheMostSuitableBlockInOrderedList(size_t index, size_t size);
+        void MarkListAsNonEmpty(size_t index);
+
+        void MarkListAsEmpty(size_t index);
+
+        // Find the first block with size not less than the required size in the list.
+        FreeListHeader *FindSuitableBlockInList(size_t index, size_t size);
 
         // Each element of this array consists of memory blocks with size
-        // from (FREELIST_ALLOCATOR_MIN_SIZE + SEGREGATED_LIST_FREE_BLOCK_RANGE * (N))
-        // to   (FREELIST_ALLOCATOR_MIN_SIZE + SEGREGATED_LIST_FREE_BLOCK_RANGE * (N + 1)) (not inclusive)
-        // where N is the element number in this array.
+        // from (2^FL + 2^(FL - SECOND_LEVEL_BITS) * SL)
+        // to   (2^FL + 2^(FL - SECOND_LEVEL_BITS) * (SL + 1)) (not inclusive)
+        // where FL = FIRST_LEVEL_MIN_POWER + N / SECOND_LEVEL_LISTS_COUNT, SL = N % SECOND_LEVEL_LISTS_COUNT
+        // and N is the element number in this array.
         std::array<FreeListHeader, SEGREGATED_LIST_SIZE> free_memory_blocks_;
+        // Bit N is set if there is a non-empty list with first level index N
+        uint32_t first_level_bitmap_ {0};
+        // Bit M of element N is set if the list with index (N * SECOND_LEVEL_LISTS_COUNT + M) is non-empty
+        std::array<uint32_t, FIRST_LEVEL_LISTS_COUNT> second_level_bitmaps_ {};
     };
 
     MemoryBlockHeader *GetFreeListMemoryHeader(void *mem);
@@ -315,6 +364,20 @@ private:
 
     void FreeUnsafe(void *mem);
 
+    // Blocks with alignment padding are not moved by compaction to keep the object alignment
+    static bool IsBlockPinned(MemoryBlockHeader *memory_block)
+    {
+        return memory_block->IsPaddingHeaderStoredAfterHeader() || memory_block->IsPaddingSizeStoredAfterHeader();
+    }
+
+    /**
+     * \brief Create a free memory block in the range [begin, end) and add it into segregated list.
+     * @param begin - address of the block header, end - address of the next block header,
+     * prev_header - the previous memory block in the pool
+     * @return the created memory block header
+     */
+    MemoryBlockHeader *CreateFreeMemoryBlock(uintptr_t begin, uintptr_t end, MemoryBlockHeader *prev_header);
+
     SegregatedList segregated_list_;
 
     // Links to head and tail of the memory pool headers
@@ -236,6 +236,9 @@ void GC::RunPhases(const GCTask &task)
         }
     }
     last_gc_reclaimed_bytes.store(vm_->GetGCStats()->GetObjectsFreedBytes());
+    // Return object pools which haven't been reused for a long time to os
+    PoolManager::GetMmapMemPool()->ReleaseIdleFreePools();
+    ScheduleReleaseIdlePools();
 
     LOG(INFO, GC) << task.reason_ << " " << GetPandaVm()->GetGCStats()->GetStatistics();
     if (gc_settings_.is_dump_heap) {
@@ -328,6 +331,14 @@ void GC::AddReference(ObjectHeader *object)
     }
 }
 
+void GC::SweepHeapSampler(const GCObjectVisitor &gc_object_visitor)
+{
+    HeapSampler *heap_sampler = GetPandaVm()->GetHeapManager()->GetHeapSampler();
+    if (heap_sampler != nullptr) {
+        heap_sampler->Sweep(gc_object_visitor);
+    }
+}
+
 /* static */
 // NOLINTNEXTLINE(performance-unnecessary-value-param)
 void GC::ProcessReferences(GCPhase gc_phase, const GCTask &task)
@@ -423,6 +434,45 @@ public:
     NO_MOVE_SEMANTIC(PostForkGCTask);
 };
 
+/**
+ * Returns freed object pools to os on the GC thread once they have been idle long enough, so they are released
+ * even if the next GC comes much later. The task is not a GC cycle.
+ */
+class GC::ReleaseIdlePoolsTask : public GCTask {
+public:
+    explicit ReleaseIdlePoolsTask(uint64_t target_time) : GCTask(GCTaskCause::RELEASE_IDLE_POOLS_CAUSE, target_time)
+    {
+    }
+
+    void Run(mem::GC &gc) override
+    {
+        PoolManager::GetMmapMemPool()->ReleaseIdleFreePools();
+        gc.release_idle_pools_scheduled_.store(false);
+        // Pools which were freed after the task had been scheduled may be not idle yet
+        gc.ScheduleReleaseIdlePools();
+    }
+
+    ~ReleaseIdlePoolsTask() override = default;
+
+    NO_COPY_SEMANTIC(ReleaseIdlePoolsTask);
+    NO_MOVE_SEMANTIC(ReleaseIdlePoolsTask);
+};
+
+void GC::ScheduleReleaseIdlePools()
+{
+    // Without the GC thread idle pools are released only at the end of GC cycles
+    if (gc_settings_.run_gc_in_place || !PoolManager::GetMmapMemPool()->HasFreePoolsToRelease()) {
+        return;
+    }
+    bool expect = false;
+    if (!release_idle_pools_scheduled_.compare_exchange_strong(expect, true)) {
+        return;
+    }
+    constexpr uint64_t NANOSECONDS_PER_MILLISECOND = 1000U * 1000U;
+    uint64_t delay = PoolManager::GetMmapMemPool()->GetFreePoolIdleTimeMs() * NANOSECONDS_PER_MILLISECOND;
+    AddGCTask(false, MakePandaUnique<ReleaseIdlePoolsTask>(time::GetCurrentTimeInNanos() + delay), false);
+}
+
 void GC::PreStartup()
 {
     // Add a delay GCTask.
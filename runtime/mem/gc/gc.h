@@ -133,7 +133,9 @@ struct GCSettings {
     bool pre_gc_heap_verification = false;                /// true if heap verification before GC enabled
     bool post_gc_heap_verification = false;               /// true if heap verification after GC enabled
     bool fail_on_heap_verification = false;  /// if true then fail execution if heap verifier found heap corruption
-    uint64_t young_space_size = 0;           /// size of young-space for gen-gc
+    bool tenured_compaction_enabled = false;    /// true if gen-gc compacts tenured space when it is fragmented
+    uint32_t tenured_compaction_threshold = 0;  /// fragmentation of tenured space (in percents) to run compaction
+    uint64_t young_space_size = 0;              /// size of young-space for gen-gc
 };
 
 class GCExtensionData;
@@ -634,6 +636,12 @@ protected:
      */
     void AddReference(ObjectHeader *object);
 
+    /**
+     * Remove dead objects from the samples of the heap profiler
+     * @param gc_object_visitor - visitor which returns status of the object
+     */
+    void SweepHeapSampler(const GCObjectVisitor &gc_object_visitor);
+
     /**
      * Mark all references which we added by AddReference method
      */
@@ -745,6 +753,11 @@ private:
     void JoinWorker();
     void CreateWorker();
 
+    /**
+     * Add a task which returns freed object pools to os after they become idle, if some of them should be returned
+     */
+    void ScheduleReleaseIdlePools();
+
     /**
      * Move small objects to pygote space at first pygote fork
      */
@@ -775,12 +788,14 @@ private:
     std::thread *worker_ = nullptr;
     std::atomic_bool gc_running_ = false;
     std::atomic<bool> can_add_gc_task_ = true;
+    std::atomic<bool> release_idle_pools_scheduled_ = false;
     bool tlabs_supported_ = false;
 
     // Additional data for extensions
     GCExtensionData *extension_data_ {nullptr};
 
     class PostForkGCTask;
+    class ReleaseIdlePoolsTask;
 
     friend class java::ReferenceQueue;
     friend class java::JavaReferenceProcessor;
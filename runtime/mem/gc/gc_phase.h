@@ -27,6 +27,7 @@ enum class GCPhase {
     GC_PHASE_MARK_YOUNG,
     GC_PHASE_REMARK,
     GC_PHASE_COLLECT_YOUNG_AND_MOVE,
+    GC_PHASE_COMPACT_TENURED,
     GC_PHASE_SWEEP_STRING_TABLE,
     GC_PHASE_SWEEP_STRING_TABLE_YOUNG,
     GC_PHASE_SWEEP,
@@ -55,6 +55,8 @@ public:
                 return "YoungRemark()";
             case GCPhase::GC_PHASE_COLLECT_YOUNG_AND_MOVE:
                 return "CollectYoungAndMove()";
+            case GCPhase::GC_PHASE_COMPACT_TENURED:
+                return "CompactTenured()";
             case GCPhase::GC_PHASE_SWEEP_STRING_TABLE:
                 return "SweepStringTable()";
             case GCPhase::GC_PHASE_SWEEP_STRING_TABLE_YOUNG:
@@ -87,6 +89,8 @@ public:
                 return "YRemark";
             case GCPhase::GC_PHASE_COLLECT_YOUNG_AND_MOVE:
                 return "ColYAndMove";
+            case GCPhase::GC_PHASE_COMPACT_TENURED:
+                return "CompactT";
             case GCPhase::GC_PHASE_SWEEP_STRING_TABLE:
                 return "SweepStrT";
             case GCPhase::GC_PHASE_SWEEP_STRING_TABLE_YOUNG:
@@ -31,6 +31,7 @@
 namespace panda::mem {
 
 constexpr bool LOG_DETAILED_GC_INFO = true;
+constexpr double PERCENT_100 = 100.0;
 
 void PreStoreInBuff([[maybe_unused]] void *object_header) {}
 
@@ -347,12 +348,16 @@ void GenGC<LanguageConfig>::SweepStringTableYoung()
     GCScopedPhase scoped_phase(this->GetPandaVm()->GetMemStats(), this, GCPhase::GC_PHASE_SWEEP_STRING_TABLE_YOUNG);
 
     auto young_mem_range = this->GetObjectAllocator()->GetYoungSpaceMemRange();
-    string_table->Sweep(static_cast<GCObjectVisitor>([&young_mem_range](ObjectHeader *object_header) {
+    auto gc_object_visitor = static_cast<GCObjectVisitor>([&young_mem_range](ObjectHeader *object_header) {
         if (young_mem_range.IsAddressInRange(ToUintPtr(object_header))) {
             return ObjectStatus::DEAD_OBJECT;
         }
         return ObjectStatus::ALIVE_OBJECT;
-    }));
+    });
+    // Strings which are in the young space now are interned after the previous young GC
+    string_table->SweepNew(gc_object_visitor);
+    // Samples of the heap profiler are weak references as well
+    this->SweepHeapSampler(gc_object_visitor);
 }
 
 template <class LanguageConfig>
@@ -363,12 +368,15 @@ void GenGC<LanguageConfig>::SweepStringTable()
 
     // New strings may be created in young space during tenured gc, we shouldn't collect them
     auto young_mem_range = this->GetObjectAllocator()->GetYoungSpaceMemRange();
-    this->GetPandaVm()->GetStringTable()->Sweep([this, &young_mem_range](ObjectHeader *object) {
+    auto gc_object_visitor = static_cast<GCObjectVisitor>([this, &young_mem_range](ObjectHeader *object) {
         if (young_mem_range.IsAddressInRange(ToUintPtr(object))) {
             return ObjectStatus::ALIVE_OBJECT;
         }
         return this->marker_.MarkChecker(object);
     });
+    this->GetPandaVm()->GetStringTable()->Sweep(gc_object_visitor);
+    // Samples of the heap profiler are weak references as well
+    this->SweepHeapSampler(gc_object_visitor);
 }
 
 template <class LanguageConfig>
@@ -421,11 +429,86 @@ void GenGC<LanguageConfig>::RunTenuredGC(const GCTask &task)
     ASSERT(objects_stack.empty());
     this->GetObjectAllocator()->IterateOverYoungObjects([this](ObjectHeader *obj) { this->marker_.UnMark(obj); });
     SweepStringTable();
+    if (ShouldCompactTenured()) {
+        CompactTenured();
+    }
     Sweep();
     this->GetPandaVm()->GetMemStats()->RecordGCPauseEnd();
     LOG_DEBUG_GC << "GC tenured end";
 }
 
+template <class LanguageConfig>
+bool GenGC<LanguageConfig>::ShouldCompactTenured()
+{
+    if (!this->GetSettings()->tenured_compaction_enabled) {
+        return false;
+    }
+    double fragmentation = this->GetObjectAllocator()->GetCompactableSpaceFragmentation();
+    LOG_DEBUG_GC << "Tenured space fragmentation: " << fragmentation;
+    return fragmentation * PERCENT_100 >= this->GetSettings()->tenured_compaction_threshold;
+}
+
+template <class LanguageConfig>
+void GenGC<LanguageConfig>::CompactTenured()
+{
+    trace::ScopedTrace scoped_trace(__FUNCTION__);
+    GCScopedPhase scoped_phase(this->GetPandaVm()->GetMemStats(), this, GCPhase::GC_PHASE_COMPACT_TENURED);
+    ScopedTiming t(__FUNCTION__, *this->GetTiming());
+    auto object_allocator = this->GetObjectAllocator();
+
+    // Collect dead objects here instead of Sweep, so only live objects are slid and have references to update
+    auto young_mr = object_allocator->GetYoungSpaceMemRange();
+    this->GetPandaVm()->GetMonitorPool()->DeflateMonitorsWithCallBack([&young_mr, this](Monitor *monitor) {
+        ObjectHeader *object_header = monitor->GetObject();
+        return (!IsMarked(object_header)) && (!young_mr.IsAddressInRange(ToUintPtr(object_header)));
+    });
+    size_t freed_object_size = 0U;
+    size_t freed_object_count = 0U;
+    object_allocator->Collect(
+        [this, &freed_object_size, &freed_object_count](ObjectHeader *object) {
+            auto status = this->marker_.MarkChecker(object);
+            if (status == ObjectStatus::DEAD_OBJECT) {
+                freed_object_size += GetAlignedObjectSize(GetObjectSize(object));
+                freed_object_count++;
+            }
+            return status;
+        },
+        GCCollectMode::GC_ALL);
+    this->mem_stats_.RecordSizeFreedTenured(freed_object_size);
+    this->mem_stats_.RecordCountFreedTenured(freed_object_count);
+
+    // Forwarding address overwrites the mark word, so save it to restore after moving
+    PandaVector<MarkWord> moved_objects_marks;
+    size_t moved_size = 0U;
+    object_allocator->CalculateCompactedAddresses(
+        [this, &moved_objects_marks, &moved_size](ObjectHeader *object, ObjectHeader *new_address) {
+            // Dynamic classes require updating the object itself in SetForwardAddress, it is not supported here
+            ASSERT(!object->ClassAddr<BaseClass>()->IsDynamicClass());
+            moved_objects_marks.push_back(object->AtomicGetMark());
+            moved_size += GetAlignedObjectSize(GetObjectSize(object));
+            this->SetForwardAddress(object, new_address);
+        });
+    if (moved_objects_marks.empty()) {
+        return;
+    }
+    // Only live objects are left in the heap, so update references in all of them
+    this->CommonUpdateRefsToMovedObjects([&object_allocator](const UpdateRefInObject &update_refs_in_object) {
+        object_allocator->IterateOverObjects(update_refs_in_object);
+    });
+    size_t moved_index = 0U;
+    object_allocator->CompactTenuredSpace([this, &moved_objects_marks, &moved_index](ObjectHeader *object) {
+        ASSERT(moved_index < moved_objects_marks.size());
+        object->SetMark(moved_objects_marks[moved_index++]);
+        // Moved object can have references to young space
+        card_table_->MarkCard(ToUintPtr(object));
+    });
+    ASSERT(moved_index == moved_objects_marks.size());
+    LOG_DEBUG_GC << "Tenured compaction moved " << moved_objects_marks.size() << " objects, " << moved_size
+                 << " bytes";
+    this->GetStats()->AddMemoryValue(moved_size, MemoryTypeStats::MOVED_BYTES);
+    this->GetStats()->AddObjectsValue(moved_objects_marks.size(), ObjectTypeStats::MOVED_OBJECTS);
+}
+
 template <class LanguageConfig>
 void GenGC<LanguageConfig>::MarkRoots(PandaStackTL<ObjectHeader *> *objects_stack,
                                       CardTableVisitFlag visit_card_table_roots, VisitGCRootFlags flags)
@@ -117,12 +117,12 @@ private:
     bool CollectYoungAndMove(const GCTask &task);
 
     /**
-     * Sweeps string table from about to become dangled pointers to young generation
+     * Sweeps string table and heap profiler samples from about to become dangled pointers to young generation
      */
     void SweepStringTableYoung();
 
     /**
-     * Remove dead strings from string table
+     * Remove dead strings from string table and dead samples of the heap profiler
      */
     void SweepStringTable();
 
@@ -131,6 +131,16 @@ private:
      */
     void UpdateRefsToMovedObjects(PandaVector<ObjectHeader *> *moved_objects);
 
+    /**
+     * Check if tenured space is fragmented enough to be compacted
+     */
+    bool ShouldCompactTenured();
+
+    /**
+     * Collect dead tenured objects and slide live objects of the compactable tenured space. Runs with STW.
+     */
+    void CompactTenured();
+
     void Sweep();
 
     bool IsMarked(const ObjectHeader *object) const override;
@@ -15,6 +15,7 @@
 
 #include "runtime/include/panda_vm.h"
 #include "runtime/mem/gc/lang/gc_lang.h"
+#include "runtime/mem/heap_manager.h"
 #include "runtime/mem/object_helpers-inl.h"
 #include "runtime/mem/gc/dynamic/gc_dynamic_data.h"
 
@@ -87,6 +88,11 @@ void GCLang<LanguageConfig>::CommonUpdateRefsToMovedObjects(const UpdateRefInAll
     }
     // Update string table
     GetPandaVm()->GetStringTable()->UpdateMoved();
+    // Update samples of the heap profiler
+    HeapSampler *heap_sampler = GetPandaVm()->GetHeapManager()->GetHeapSampler();
+    if (heap_sampler != nullptr) {
+        heap_sampler->UpdateMoved();
+    }
 
     // Update thread locals
     UpdateThreadLocals();
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include "runtime/include/coretypes/string.h"
 #include "runtime/include/panda_vm.h"
 #include "runtime/mem/gc/gc.h"
 
@@ -24,6 +25,18 @@ void GC::HandleObject<LANG_TYPE_STATIC, false>(PandaStackTL<ObjectHeader *> *obj
 {
     ASSERT(!base_cls->IsDynamicClass());
     auto cls = static_cast<Class *>(base_cls);
+    if (UNLIKELY(cls->IsStringClass())) {
+        // Strings have no fields, but ropes refer to their parts
+        if (static_cast<const coretypes::String *>(object)->IsRope()) {
+            for (uint32_t offset : {coretypes::String::GetRopeLeftOffset(), coretypes::String::GetRopeRightOffset()}) {
+                auto *part = object->GetFieldObject<true>(offset);
+                if (part != nullptr && MarkObjectIfNotMarked(part)) {
+                    AddToStack(objects_stack, part);
+                }
+            }
+        }
+        return;
+    }
     while (cls != nullptr) {
         // Iterate over instance fields
         uint32_t ref_num = cls->GetRefFieldsNum<false>();
@@ -124,13 +124,17 @@ void StwGC<LanguageConfig>::SweepStringTable()
     auto string_table = this->GetPandaVm()->GetStringTable();
     GCScopedPhase scoped_phase(this->GetPandaVm()->GetMemStats(), this, GCPhase::GC_PHASE_SWEEP_STRING_TABLE);
 
+    GCObjectVisitor gc_object_visitor;
     if (!reversed_mark_) {
         LOG_DEBUG_GC << "SweepStringTable with MarkChecker";
-        string_table->Sweep([this](ObjectHeader *object) { return this->marker_.MarkChecker(object); });
+        gc_object_visitor = [this](ObjectHeader *object) { return this->marker_.MarkChecker(object); };
     } else {
         LOG_DEBUG_GC << "SweepStringTable with ReverseMarkChecker";
-        string_table->Sweep([this](ObjectHeader *object) { return this->marker_.template MarkChecker<true>(object); });
+        gc_object_visitor = [this](ObjectHeader *object) { return this->marker_.template MarkChecker<true>(object); };
     }
+    string_table->Sweep(gc_object_visitor);
+    // Samples of the heap profiler are weak references as well
+    this->SweepHeapSampler(gc_object_visitor);
 }
 
 template <class LanguageConfig>
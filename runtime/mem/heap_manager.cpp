@@ -86,6 +86,10 @@ void HeapManager::SetPandaVM(PandaVM *vm)
 
 bool HeapManager::Finalize()
 {
+    if (heap_sampler_ != nullptr) {
+        internalAllocator_->Delete(heap_sampler_);
+        heap_sampler_ = nullptr;
+    }
     delete codeAllocator_;
     objectAllocator_->VisitAndRemoveAllPools(
         [](void *mem, [[maybe_unused]] size_t size) { PoolManager::GetMmapMemPool()->FreePool(mem, size); });
@@ -123,6 +127,9 @@ ObjectHeader *HeapManager::AllocateObject(BaseClass *cls, size_t size, Alignment
         GetNotificationManager()->ObjectAllocEvent(cls, handle.GetPtr(), thread, size);
         object = handle.GetPtr();
     }
+    if (UNLIKELY(heap_sampler_ != nullptr)) {
+        heap_sampler_->OnAllocation(thread, object, size);
+    }
     return object;
 }
 
@@ -217,6 +224,14 @@ ObjectHeader *HeapManager::AllocateNonMovableObject(BaseClass *cls, size_t size,
         RegisterFinalizedObject(object, cls, is_object_finalizable);
         GetNotificationManager()->ObjectAllocEvent(cls, object, thread, size);
     }
+    if (UNLIKELY(heap_sampler_ != nullptr)) {
+        if (thread == nullptr) {
+            thread = ManagedThread::GetCurrent();
+        }
+        if (thread != nullptr) {
+            heap_sampler_->OnAllocation(thread, object, size);
+        }
+    }
     return object;
 }
 
@@ -339,6 +354,16 @@ void HeapManager::DumpHeap(PandaOStringStream *o_string_stream)
     *o_string_stream << "Total dumped " << obj_cnt << std::endl;
 }
 
+void HeapManager::EnableHeapSampling(size_t sampling_interval)
+{
+    ASSERT(sampling_interval != 0);
+    ASSERT(heap_sampler_ == nullptr);
+    heap_sampler_ = internalAllocator_->New<HeapSampler>(sampling_interval);
+    if (heap_sampler_ == nullptr) {
+        LOG(ERROR, RUNTIME) << "Failed to allocate HeapSampler";
+    }
+}
+
 /**
  * \brief Check whether the given object is an instance of the given class.
  * @param obj - ObjectHeader pointer
@@ -26,6 +26,7 @@
 #include "runtime/include/object_header.h"
 #include "runtime/include/thread.h"
 #include "runtime/mem/frame_allocator-inl.h"
+#include "runtime/mem/heap_sampler.h"
 #include "runtime/mem/heap_verifier.h"
 #include "runtime/mem/tlab.h"
 #include "runtime/mem/gc/crossing_map_singleton.h"
@@ -109,6 +110,17 @@ public:
 
     void DumpHeap(PandaOStringStream *o_string_stream);
 
+    /**
+     * \brief Enable sampling of object allocations for the heap profiler
+     * @param sampling_interval - mean interval in bytes between the sampled allocations
+     */
+    void EnableHeapSampling(size_t sampling_interval);
+
+    HeapSampler *GetHeapSampler() const
+    {
+        return heap_sampler_;
+    }
+
     size_t VerifyHeapReferences()
     {
         trace::ScopedTrace scoped_trace(__FUNCTION__);
@@ -237,6 +249,7 @@ private:
     MemStatsType *mem_stats_ {nullptr};
     mem::GC *gc_ = nullptr;
     RuntimeNotificationManager *notification_manager_ = nullptr;
+    HeapSampler *heap_sampler_ = nullptr;
 };
 
 }  // namespace panda::mem
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/mem/heap_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+#include "libpandabase/utils/logger.h"
+#include "libpandabase/utils/time.h"
+#include "libpandabase/utils/utf.h"
+#include "runtime/include/method.h"
+#include "runtime/include/object_header.h"
+#include "runtime/include/stack_walker.h"
+#include "runtime/mem/object_helpers.h"
+
+namespace panda::mem {
+
+namespace {
+
+/**
+ * Minimal writer of the protobuf wire format, enough to encode the pprof profile.proto message
+ */
+class ProtoWriter {
+public:
+    ProtoWriter() = default;
+    ~ProtoWriter() = default;
+    NO_COPY_SEMANTIC(ProtoWriter);
+    NO_MOVE_SEMANTIC(ProtoWriter);
+
+    void WriteVarint(uint32_t field, uint64_t value)
+    {
+        WriteTag(field, WIRE_TYPE_VARINT);
+        WriteRawVarint(value);
+    }
+
+    void WriteBytes(uint32_t field, const uint8_t *data, size_t size)
+    {
+        WriteTag(field, WIRE_TYPE_LENGTH_DELIMITED);
+        WriteRawVarint(size);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        buffer_.insert(buffer_.end(), data, data + size);
+    }
+
+    void WriteString(uint32_t field, std::string_view str)
+    {
+        WriteBytes(field, reinterpret_cast<const uint8_t *>(str.data()), str.size());
+    }
+
+    void WriteMessage(uint32_t field, const ProtoWriter &message)
+    {
+        WriteBytes(field, message.buffer_.data(), message.buffer_.size());
+    }
+
+    void WritePackedVarints(uint32_t field, const PandaVector<uint64_t> &values)
+    {
+        ProtoWriter packed;
+        for (auto value : values) {
+            packed.WriteRawVarint(value);
+        }
+        WriteMessage(field, packed);
+    }
+
+    const PandaVector<uint8_t> &GetBuffer() const
+    {
+        return buffer_;
+    }
+
+private:
+    static constexpr uint32_t WIRE_TYPE_VARINT = 0;
+    static constexpr uint32_t WIRE_TYPE_LENGTH_DELIMITED = 2;
+    static constexpr uint32_t WIRE_TYPE_BITS = 3;
+    static constexpr uint64_t VARINT_PAYLOAD_BITS = 7;
+    static constexpr uint64_t VARINT_PAYLOAD_MASK = 0x7fU;
+    static constexpr uint64_t VARINT_CONTINUATION_BIT = 0x80U;
+
+    void WriteTag(uint32_t field, uint32_t wire_type)
+    {
+        WriteRawVarint((static_cast<uint64_t>(field) << WIRE_TYPE_BITS) | wire_type);
+    }
+
+    void WriteRawVarint(uint64_t value)
+    {
+        while (value >= VARINT_CONTINUATION_BIT) {
+            buffer_.push_back(static_cast<uint8_t>((value & VARINT_PAYLOAD_MASK) | VARINT_CONTINUATION_BIT));
+            value >>= VARINT_PAYLOAD_BITS;
+        }
+        buffer_.push_back(static_cast<uint8_t>(value));
+    }
+
+    PandaVector<uint8_t> buffer_;
+};
+
+// Field numbers of the pprof profile.proto messages
+constexpr uint32_t PROFILE_SAMPLE_TYPE = 1;
+constexpr uint32_t PROFILE_SAMPLE = 2;
+constexpr uint32_t PROFILE_LOCATION = 4;
+constexpr uint32_t PROFILE_FUNCTION = 5;
+constexpr uint32_t PROFILE_STRING_TABLE = 6;
+constexpr uint32_t PROFILE_TIME_NANOS = 9;
+constexpr uint32_t PROFILE_PERIOD_TYPE = 11;
+constexpr uint32_t PROFILE_PERIOD = 12;
+constexpr uint32_t PROFILE_DEFAULT_SAMPLE_TYPE = 14;
+constexpr uint32_t VALUE_TYPE_TYPE = 1;
+constexpr uint32_t VALUE_TYPE_UNIT = 2;
+constexpr uint32_t SAMPLE_LOCATION_ID = 1;
+constexpr uint32_t SAMPLE_VALUE = 2;
+constexpr uint32_t LOCATION_ID = 1;
+constexpr uint32_t LOCATION_LINE = 4;
+constexpr uint32_t LINE_FUNCTION_ID = 1;
+constexpr uint32_t LINE_LINE = 2;
+constexpr uint32_t FUNCTION_ID = 1;
+constexpr uint32_t FUNCTION_NAME = 2;
+constexpr uint32_t FUNCTION_SYSTEM_NAME = 3;
+constexpr uint32_t FUNCTION_FILENAME = 4;
+
+/**
+ * Collects functions, locations and strings of the profile, they are referenced by ids from the samples
+ */
+class ProfileBuilder {
+public:
+    explicit ProfileBuilder(ProtoWriter *profile) : profile_(profile)
+    {
+        // The first entry of the string table must be an empty string
+        GetStringId("");
+    }
+
+    ~ProfileBuilder() = default;
+    NO_COPY_SEMANTIC(ProfileBuilder);
+    NO_MOVE_SEMANTIC(ProfileBuilder);
+
+    uint64_t GetStringId(std::string_view str)
+    {
+        auto it = string_ids_.find(PandaString(str));
+        if (it != string_ids_.end()) {
+            return it->second;
+        }
+        uint64_t id = strings_.size();
+        strings_.emplace_back(str);
+        string_ids_.emplace(strings_.back(), id);
+        return id;
+    }
+
+    uint64_t GetLocationId(const Method *method, uint32_t bytecode_offset)
+    {
+        auto key = std::make_pair(method, bytecode_offset);
+        auto it = location_ids_.find(key);
+        if (it != location_ids_.end()) {
+            return it->second;
+        }
+        uint64_t id = location_ids_.size() + 1;
+        location_ids_.emplace(key, id);
+
+        int64_t line_num = method != nullptr ? method->GetLineNumFromBytecodeOffset(bytecode_offset) : 0;
+        ProtoWriter line;
+        line.WriteVarint(LINE_FUNCTION_ID, GetFunctionId(method));
+        line.WriteVarint(LINE_LINE, static_cast<uint64_t>(std::max<int64_t>(line_num, 0)));
+        ProtoWriter location;
+        location.WriteVarint(LOCATION_ID, id);
+        location.WriteMessage(LOCATION_LINE, line);
+        profile_->WriteMessage(PROFILE_LOCATION, location);
+        return id;
+    }
+
+    void WriteStringTable()
+    {
+        for (const auto &str : strings_) {
+            profile_->WriteString(PROFILE_STRING_TABLE, str);
+        }
+    }
+
+private:
+    uint64_t GetFunctionId(const Method *method)
+    {
+        auto it = function_ids_.find(method);
+        if (it != function_ids_.end()) {
+            return it->second;
+        }
+        uint64_t id = function_ids_.size() + 1;
+        function_ids_.emplace(method, id);
+
+        uint64_t name_id = 0;
+        uint64_t file_id = 0;
+        if (method == nullptr) {
+            name_id = GetStringId("<unknown>");
+        } else {
+            name_id = GetStringId(method->GetFullName());
+            auto source_file = method->GetClassSourceFile().data;
+            if (source_file != nullptr) {
+                file_id = GetStringId(utf::Mutf8AsCString(source_file));
+            }
+        }
+        ProtoWriter function;
+        function.WriteVarint(FUNCTION_ID, id);
+        function.WriteVarint(FUNCTION_NAME, name_id);
+        function.WriteVarint(FUNCTION_SYSTEM_NAME, name_id);
+        function.WriteVarint(FUNCTION_FILENAME, file_id);
+        profile_->WriteMessage(PROFILE_FUNCTION, function);
+        return id;
+    }
+
+    ProtoWriter *profile_;
+    PandaVector<PandaString> strings_;
+    PandaUnorderedMap<PandaString, uint64_t> string_ids_;
+    PandaUnorderedMap<const Method *, uint64_t> function_ids_;
+    PandaMap<std::pair<const Method *, uint32_t>, uint64_t> location_ids_;
+};
+
+/**
+ * An allocation of the given size is sampled with probability 1 - exp(-size / interval),
+ * so sampled values are scaled back by the inverse of this probability using the average size of the site
+ */
+std::pair<uint64_t, uint64_t> UnsampleValues(uint64_t count, uint64_t bytes, size_t sampling_interval)
+{
+    if (count == 0) {
+        return {0, 0};
+    }
+    double average_size = static_cast<double>(bytes) / count;
+    double scale = 1.0 / (1.0 - std::exp(-average_size / sampling_interval));
+    return {static_cast<uint64_t>(std::llround(count * scale)), static_cast<uint64_t>(std::llround(bytes * scale))};
+}
+
+}  // namespace
+
+HeapSampler::HeapSampler(size_t sampling_interval)
+    : sampling_interval_(sampling_interval), random_state_(time::GetCurrentTimeInNanos()), sites_(SITES_COUNT)
+{
+    ASSERT(sampling_interval_ > 0);
+    // Unknown site keeps samples without managed frames and samples which didn't fit into the table
+    sites_[UNKNOWN_SITE].ready.store(true, std::memory_order_release);
+}
+
+void HeapSampler::SampleAllocation(ManagedThread *thread, ObjectHeader *object, size_t size)
+{
+    size_t bytes_until_sample = thread->GetBytesUntilHeapSample();
+    if (bytes_until_sample == 0) {
+        // The first allocation in the thread, start its sampling process
+        bytes_until_sample = GetNextSampleInterval();
+        if (bytes_until_sample > size) {
+            thread->SetBytesUntilHeapSample(bytes_until_sample - size);
+            return;
+        }
+    }
+    thread->SetBytesUntilHeapSample(GetNextSampleInterval());
+
+    std::array<StackFrame, MAX_STACK_DEPTH> frames {};
+    size_t depth = 0;
+    for (StackWalker stack(thread); stack.HasFrame() && depth < MAX_STACK_DEPTH; stack.NextFrame()) {
+        frames[depth++] = {stack.GetMethod(), static_cast<uint32_t>(stack.GetBytecodePc())};
+    }
+    size_t site_index = FindOrInsertSite(frames.data(), depth);
+    AllocationSite &site = sites_[site_index];
+    site.alloc_count.fetch_add(1, std::memory_order_relaxed);
+    site.alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    site.live_count.fetch_add(1, std::memory_order_relaxed);
+    site.live_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    os::memory::LockHolder lock(live_samples_lock_);
+    live_samples_.push_back({object, site_index, size});
+}
+
+size_t HeapSampler::GetNextSampleInterval()
+{
+    // splitmix64 generator, the state is shared between threads
+    static constexpr uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+    static constexpr uint64_t MUL1 = 0xbf58476d1ce4e5b9ULL;
+    static constexpr uint64_t MUL2 = 0x94d049bb133111ebULL;
+    static constexpr uint64_t SHIFT1 = 30U;
+    static constexpr uint64_t SHIFT2 = 27U;
+    static constexpr uint64_t SHIFT3 = 31U;
+    static constexpr uint64_t MANTISSA_SHIFT = 11U;
+    static constexpr double MANTISSA_SCALE = 1.0 / static_cast<double>(1ULL << 53U);
+
+    uint64_t value = random_state_.fetch_add(GAMMA, std::memory_order_relaxed) + GAMMA;
+    value = (value ^ (value >> SHIFT1)) * MUL1;
+    value = (value ^ (value >> SHIFT2)) * MUL2;
+    value ^= value >> SHIFT3;
+    // Uniform value in (0, 1]
+    double uniform = (static_cast<double>(value >> MANTISSA_SHIFT) + 1.0) * MANTISSA_SCALE;
+    // Intervals between samples of a Poisson process are exponentially distributed
+    auto interval = static_cast<size_t>(-std::log(uniform) * sampling_interval_);
+    return std::max<size_t>(interval, 1U);
+}
+
+size_t HeapSampler::FindOrInsertSite(const StackFrame *frames, size_t depth)
+{
+    static constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+    static constexpr size_t MAX_PROBES = 64;
+
+    if (depth == 0) {
+        return UNKNOWN_SITE;
+    }
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < depth; i++) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        hash = (hash ^ ToUintPtr(frames[i].method)) * FNV_PRIME;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        hash = (hash ^ frames[i].bytecode_offset) * FNV_PRIME;
+    }
+    // Zero hash marks an empty site
+    hash = std::max<uint64_t>(hash, 1U);
+
+    auto frames_equal = [](const StackFrame &lhs, const StackFrame &rhs) {
+        return lhs.method == rhs.method && lhs.bytecode_offset == rhs.bytecode_offset;
+    };
+    for (size_t probe = 0; probe < MAX_PROBES; probe++) {
+        size_t index = UNKNOWN_SITE + 1 + (hash + probe) % (SITES_COUNT - 1);
+        AllocationSite &site = sites_[index];
+        uint64_t site_hash = site.hash.load(std::memory_order_acquire);
+        if (site_hash == 0 && site.hash.compare_exchange_strong(site_hash, hash, std::memory_order_acq_rel)) {
+            site.depth = depth;
+            std::copy_n(frames, depth, site.frames.begin());
+            site.ready.store(true, std::memory_order_release);
+            return index;
+        }
+        // If the site with the same stack is being inserted by another thread right now, we continue probing.
+        // It can create a duplicate of the site, but pprof merges samples with the same stacks.
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (site_hash == hash && site.ready.load(std::memory_order_acquire) && site.depth == depth &&
+            std::equal(frames, frames + depth, site.frames.begin(), frames_equal)) {
+            return index;
+        }
+    }
+    return UNKNOWN_SITE;
+}
+
+void HeapSampler::ReleaseSample(const LiveSample &sample)
+{
+    AllocationSite &site = sites_[sample.site];
+    site.live_count.fetch_sub(1, std::memory_order_relaxed);
+    site.live_bytes.fetch_sub(sample.size, std::memory_order_relaxed);
+}
+
+void HeapSampler::Sweep(const GCObjectVisitor &gc_object_visitor)
+{
+    os::memory::LockHolder lock(live_samples_lock_);
+    size_t alive = 0;
+    for (auto &sample : live_samples_) {
+        if (sample.object->IsForwarded()) {
+            ASSERT(gc_object_visitor(sample.object) != ObjectStatus::DEAD_OBJECT);
+            sample.object = GetForwardAddress(sample.object);
+        } else if (gc_object_visitor(sample.object) == ObjectStatus::DEAD_OBJECT) {
+            ReleaseSample(sample);
+            continue;
+        }
+        live_samples_[alive++] = sample;
+    }
+    live_samples_.resize(alive);
+}
+
+void HeapSampler::UpdateMoved()
+{
+    os::memory::LockHolder lock(live_samples_lock_);
+    for (auto &sample : live_samples_) {
+        if (sample.object->IsForwarded()) {
+            sample.object = GetForwardAddress(sample.object);
+        }
+    }
+}
+
+void HeapSampler::DumpProfile(std::ostream &out)
+{
+    ProtoWriter profile;
+    ProfileBuilder builder(&profile);
+
+    static constexpr std::array<std::pair<std::string_view, std::string_view>, 4> SAMPLE_TYPES = {
+        {{"alloc_objects", "count"}, {"alloc_space", "bytes"}, {"inuse_objects", "count"}, {"inuse_space", "bytes"}}};
+    for (const auto &[type, unit] : SAMPLE_TYPES) {
+        ProtoWriter value_type;
+        value_type.WriteVarint(VALUE_TYPE_TYPE, builder.GetStringId(type));
+        value_type.WriteVarint(VALUE_TYPE_UNIT, builder.GetStringId(unit));
+        profile.WriteMessage(PROFILE_SAMPLE_TYPE, value_type);
+    }
+
+    PandaVector<uint64_t> location_ids;
+    PandaVector<uint64_t> values;
+    for (const auto &site : sites_) {
+        uint64_t alloc_count = site.alloc_count.load(std::memory_order_relaxed);
+        if (!site.ready.load(std::memory_order_acquire) || alloc_count == 0) {
+            continue;
+        }
+        location_ids.clear();
+        if (site.depth == 0) {
+            location_ids.push_back(builder.GetLocationId(nullptr, 0));
+        }
+        for (size_t i = 0; i < site.depth; i++) {
+            location_ids.push_back(builder.GetLocationId(site.frames[i].method, site.frames[i].bytecode_offset));
+        }
+        auto [alloc_objects, alloc_space] =
+            UnsampleValues(alloc_count, site.alloc_bytes.load(std::memory_order_relaxed), sampling_interval_);
+        auto [inuse_objects, inuse_space] =
+            UnsampleValues(site.live_count.load(std::memory_order_relaxed),
+                           site.live_bytes.load(std::memory_order_relaxed), sampling_interval_);
+        values = {alloc_objects, alloc_space, inuse_objects, inuse_space};
+
+        ProtoWriter sample;
+        sample.WritePackedVarints(SAMPLE_LOCATION_ID, location_ids);
+        sample.WritePackedVarints(SAMPLE_VALUE, values);
+        profile.WriteMessage(PROFILE_SAMPLE, sample);
+    }
+
+    ProtoWriter period_type;
+    period_type.WriteVarint(VALUE_TYPE_TYPE, builder.GetStringId("space"));
+    period_type.WriteVarint(VALUE_TYPE_UNIT, builder.GetStringId("bytes"));
+    profile.WriteMessage(PROFILE_PERIOD_TYPE, period_type);
+    profile.WriteVarint(PROFILE_PERIOD, sampling_interval_);
+    profile.WriteVarint(PROFILE_TIME_NANOS, time::GetCurrentTimeInNanos(true));
+    profile.WriteVarint(PROFILE_DEFAULT_SAMPLE_TYPE, builder.GetStringId("inuse_space"));
+    builder.WriteStringTable();
+
+    const auto &buffer = profile.GetBuffer();
+    out.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+
+bool HeapSampler::DumpProfile(std::string_view file_name)
+{
+    std::ofstream out(std::string(file_name), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG(ERROR, RUNTIME) << "Cannot open file " << file_name << " to dump the heap sampling profile";
+        return false;
+    }
+    DumpProfile(out);
+    if (out.fail()) {
+        LOG(ERROR, RUNTIME) << "Failed to dump the heap sampling profile to " << file_name;
+        return false;
+    }
+    LOG(INFO, RUNTIME) << "Heap sampling profile is dumped to " << file_name;
+    return true;
+}
+
+}  // namespace panda::mem
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_RUNTIME_MEM_HEAP_SAMPLER_H_
+#define PANDA_RUNTIME_MEM_HEAP_SAMPLER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "libpandabase/macros.h"
+#include "libpandabase/mem/mem.h"
+#include "libpandabase/os/mutex.h"
+#include "runtime/include/managed_thread.h"
+#include "runtime/include/mem/panda_containers.h"
+
+namespace panda {
+class Method;
+class ObjectHeader;
+}  // namespace panda
+
+namespace panda::mem {
+
+/**
+ * Sampling heap profiler.
+ * Allocations are sampled as a Poisson process: each thread takes a sample after a random number of allocated bytes
+ * with the mean equal to the sampling interval. Call stacks of the samples are aggregated by allocation site
+ * in a fixed-size lock-free table. Sampled objects are tracked until the GC sweeps them, so the profile contains
+ * both total and live (in use) allocations. The profile is written in the pprof protobuf format.
+ */
+class HeapSampler {
+public:
+    explicit HeapSampler(size_t sampling_interval);
+    ~HeapSampler() = default;
+
+    /**
+     * \brief Account an allocated object and sample it if the thread's sampling interval is over
+     * @param thread - thread which allocated the object
+     * @param object - allocated object
+     * @param size - size of the object in bytes
+     */
+    void OnAllocation(ManagedThread *thread, ObjectHeader *object, size_t size)
+    {
+        size_t bytes_until_sample = thread->GetBytesUntilHeapSample();
+        if (LIKELY(bytes_until_sample > size)) {
+            thread->SetBytesUntilHeapSample(bytes_until_sample - size);
+            return;
+        }
+        SampleAllocation(thread, object, size);
+    }
+
+    /**
+     * \brief Remove dead objects from the tracked samples, update addresses of the forwarded ones
+     * @param gc_object_visitor - visitor which returns status of the object
+     */
+    void Sweep(const GCObjectVisitor &gc_object_visitor);
+
+    /**
+     * \brief Update addresses of the forwarded sampled objects
+     */
+    void UpdateMoved();
+
+    /**
+     * \brief Write the profile in the pprof protobuf format
+     * @param out - output stream, should be opened in binary mode
+     */
+    void DumpProfile(std::ostream &out);
+
+    /**
+     * \brief Write the profile in the pprof protobuf format to the file
+     * @param file_name - name of the output file
+     * @return true if the profile was written successfully
+     */
+    bool DumpProfile(std::string_view file_name);
+
+    size_t GetSamplingInterval() const
+    {
+        return sampling_interval_;
+    }
+
+    size_t GetLiveSamplesCount()
+    {
+        os::memory::LockHolder lock(live_samples_lock_);
+        return live_samples_.size();
+    }
+
+    NO_COPY_SEMANTIC(HeapSampler);
+    NO_MOVE_SEMANTIC(HeapSampler);
+
+private:
+    static constexpr size_t MAX_STACK_DEPTH = 32;
+    static constexpr size_t SITES_COUNT = 4096;
+    static constexpr size_t UNKNOWN_SITE = 0;
+
+    struct StackFrame {
+        const Method *method;
+        uint32_t bytecode_offset;
+    };
+
+    struct AllocationSite {
+        std::atomic_uint64_t hash {0};
+        std::atomic_bool ready {false};
+        size_t depth {0};
+        std::array<StackFrame, MAX_STACK_DEPTH> frames {};
+        std::atomic_uint64_t alloc_count {0};
+        std::atomic_uint64_t alloc_bytes {0};
+        std::atomic_uint64_t live_count {0};
+        std::atomic_uint64_t live_bytes {0};
+    };
+
+    struct LiveSample {
+        ObjectHeader *object;
+        size_t site;
+        size_t size;
+    };
+
+    void SampleAllocation(ManagedThread *thread, ObjectHeader *object, size_t size);
+    size_t GetNextSampleInterval();
+    size_t FindOrInsertSite(const StackFrame *frames, size_t depth);
+    void ReleaseSample(const LiveSample &sample);
+
+    size_t sampling_interval_;
+    std::atomic_uint64_t random_state_;
+    PandaVector<AllocationSite> sites_;
+    os::memory::Mutex live_samples_lock_;
+    PandaVector<LiveSample> live_samples_ GUARDED_BY(live_samples_lock_);
+};
+
+}  // namespace panda::mem
+
+#endif  // PANDA_RUNTIME_MEM_HEAP_SAMPLER_H_
@@ -30,9 +30,9 @@ void MemStats<T>::RecordAllocateObject(size_t size, SpaceType type_mem)
     ASSERT(IsHeapSpace(type_mem));
     RecordAllocate(size, type_mem);
     if (type_mem == SpaceType::SPACE_TYPE_HUMONGOUS_OBJECT) {
-        humongous_objects_allocated_.fetch_add(1, std::memory_order_acq_rel);
+        object_counters_.Add(HUMONGOUS_OBJECTS_ALLOCATED, 1);
     } else {
-        objects_allocated_.fetch_add(1, std::memory_order_acq_rel);
+        object_counters_.Add(OBJECTS_ALLOCATED, 1);
     }
 }
 
@@ -43,9 +43,8 @@ void MemStats<T>::RecordMovedObjects(size_t total_object_num, size_t size, Space
     RecordMoved(size, type_mem);
     // We can't move SPACE_TYPE_HUMONGOUS_OBJECT
     ASSERT(type_mem != SpaceType::SPACE_TYPE_HUMONGOUS_OBJECT);
-    uint64_t old_val = objects_allocated_.fetch_sub(total_object_num, std::memory_order_acq_rel);
-    (void)old_val;
-    ASSERT(old_val >= total_object_num);
+    ASSERT(object_counters_.Get(OBJECTS_ALLOCATED) >= total_object_num);
+    object_counters_.Sub(OBJECTS_ALLOCATED, total_object_num);
 }
 
 template <typename T>
@@ -54,9 +53,9 @@ void MemStats<T>::RecordFreeObject(size_t object_size, SpaceType type_mem)
     ASSERT(IsHeapSpace(type_mem));
     RecordFree(object_size, type_mem);
     if (type_mem == SpaceType::SPACE_TYPE_HUMONGOUS_OBJECT) {
-        humongous_objects_freed_.fetch_add(1, std::memory_order_acq_rel);
+        object_counters_.Add(HUMONGOUS_OBJECTS_FREED, 1);
     } else {
-        objects_freed_.fetch_add(1, std::memory_order_acq_rel);
+        object_counters_.Add(OBJECTS_FREED, 1);
     }
 }
 
@@ -66,9 +65,9 @@ void MemStats<T>::RecordFreeObjects(size_t total_object_num, size_t total_object
     ASSERT(IsHeapSpace(type_mem));
     RecordFree(total_object_size, type_mem);
     if (type_mem == SpaceType::SPACE_TYPE_HUMONGOUS_OBJECT) {
-        humongous_objects_freed_.fetch_add(total_object_num, std::memory_order_acq_rel);
+        object_counters_.Add(HUMONGOUS_OBJECTS_FREED, total_object_num);
     } else {
-        objects_freed_.fetch_add(total_object_num, std::memory_order_acq_rel);
+        object_counters_.Add(OBJECTS_FREED, total_object_num);
     }
 }
 
@@ -95,13 +94,13 @@ PandaString MemStats<T>::GetStatistics(HeapManager *heap_manager)
 template <typename T>
 [[nodiscard]] uint64_t MemStats<T>::GetTotalObjectsAllocated() const
 {
-    return objects_allocated_.load(std::memory_order_acquire);
+    return object_counters_.Get(OBJECTS_ALLOCATED);
 }
 
 template <typename T>
 [[nodiscard]] uint64_t MemStats<T>::GetTotalObjectsFreed() const
 {
-    return objects_freed_.load(std::memory_order_acquire);
+    return object_counters_.Get(OBJECTS_FREED);
 }
 
 template <typename T>
@@ -119,13 +118,13 @@ template <typename T>
 template <typename T>
 [[nodiscard]] uint64_t MemStats<T>::GetTotalHumongousObjectsAllocated() const
 {
-    return humongous_objects_allocated_.load(std::memory_order_acquire);
+    return object_counters_.Get(HUMONGOUS_OBJECTS_ALLOCATED);
 }
 
 template <typename T>
 [[nodiscard]] uint64_t MemStats<T>::GetTotalHumongousObjectsFreed() const
 {
-    return humongous_objects_freed_.load(std::memory_order_acquire);
+    return object_counters_.Get(HUMONGOUS_OBJECTS_FREED);
 }
 
 template <typename T>
@@ -22,6 +22,7 @@
 
 #include "libpandabase/macros.h"
 #include "libpandabase/mem/base_mem_stats.h"
+#include "libpandabase/mem/sharded_counters.h"
 #include "libpandabase/os/mutex.h"
 #include "runtime/include/mem/panda_string.h"
 #include "runtime/mem/gc/gc_phase.h"
@@ -122,12 +123,16 @@ private:
     duration sum_pause_ = duration(0);
     uint64_t pause_count_ = 0;
 
-    // make groups of different parts of the VM (JIT, interpreter, etc)
-    std::atomic_uint64_t objects_allocated_ = 0;
-    std::atomic_uint64_t objects_freed_ = 0;
+    enum ObjectCounter : size_t {
+        OBJECTS_ALLOCATED,
+        OBJECTS_FREED,
+        HUMONGOUS_OBJECTS_ALLOCATED,
+        HUMONGOUS_OBJECTS_FREED,
+        OBJECT_COUNTERS_NUM
+    };
 
-    std::atomic_uint64_t humongous_objects_allocated_ = 0;
-    std::atomic_uint64_t humongous_objects_freed_ = 0;
+    // make groups of different parts of the VM (JIT, interpreter, etc)
+    ShardedCounters<OBJECT_COUNTERS_NUM> object_counters_;
 };
 
 }  // namespace panda::mem
@@ -43,6 +43,9 @@ static HeapManager *CreateHeapManager(InternalAllocatorPtr internal_allocator,
     }
     heap_manager->SetIsFinalizableFunc(options.is_object_finalizeble_func);
     heap_manager->SetRegisterFinalizeReferenceFunc(options.register_finalize_reference_func);
+    if (options.heap_sampling_interval != 0) {
+        heap_manager->EnableHeapSampling(options.heap_sampling_interval);
+    }
 
     return heap_manager;
 }
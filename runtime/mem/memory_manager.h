@@ -73,6 +73,7 @@ public:
         bool is_single_thread;
         bool is_use_tlab_for_allocations;
         bool is_start_as_zygote;
+        size_t heap_sampling_interval;
     };
 
     static MemoryManager *Create(LanguageContext ctx, InternalAllocatorPtr internal_allocator, GCType gc_type,
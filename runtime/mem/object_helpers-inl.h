@@ -123,6 +123,18 @@ void GCStaticObjectHelpers::TraverseObject(ObjectHeader *object, BaseClass *base
 {
     ASSERT(!base_cls->IsDynamicClass());
     auto *cls = static_cast<Class *>(base_cls);
+    if (UNLIKELY(cls->IsStringClass())) {
+        // Strings have no fields, but ropes refer to their parts
+        if (static_cast<coretypes::String *>(object)->IsRope()) {
+            for (uint32_t offset : {coretypes::String::GetRopeLeftOffset(), coretypes::String::GetRopeRightOffset()}) {
+                auto *part = object->GetFieldObject<true>(offset);
+                if (part != nullptr) {
+                    field_visitor(object, part, offset, true);
+                }
+            }
+        }
+        return;
+    }
     while (cls != nullptr) {
         // Iterate over instance fields
         uint32_t ref_num = cls->GetRefFieldsNum<false>();
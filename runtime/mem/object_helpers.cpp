@@ -84,7 +84,8 @@ void DumpObject([[maybe_unused]] ObjectHeader *object_header,
         *o_stream << "Dump object: " << std::hex << object_header << std::endl;
         if (cls->GetName() == "java.lang.String") {
             auto *str_object = static_cast<panda::coretypes::String *>(object_header);
-            if (str_object->GetLength() > 0 && !str_object->IsUtf16()) {
+            // Characters of ropes are not printed as flattening allocates
+            if (str_object->GetLength() > 0 && !str_object->IsUtf16() && !str_object->IsRope()) {
                 *o_stream << "length = " << std::dec << str_object->GetLength() << std::endl;
                 constexpr size_t BUFF_SIZE = 256;
                 std::array<char, BUFF_SIZE> buff {0};
@@ -92,6 +92,10 @@ PandaString ConvertToString(const std::string &str)
 PandaString ConvertToString(coretypes::String *s)
 {
     ASSERT(s != nullptr);
+    s = coretypes::String::Flatten(s);
+    if (s == nullptr) {
+        return "";
+    }
     if (s->IsUtf16()) {
         // Should convert utf-16 to utf-8, because uint16_t likely greater than MAX_CHAR, will convert fail
         size_t len = utf::Utf16ToMUtf8Size(s->GetDataUtf16(), s->GetUtf16Length()) - 1;
@@ -310,6 +310,8 @@ Method::Proto Method::GetProto() const
 
 uint32_t Method::GetNumericalAnnotation(AnnotationField field_id) const
 {
+    // Annotations are read repeatedly, the table of method offsets lets the accessor skip to them directly
+    panda_file_->GetMethodOffsets(file_id_);
     panda_file::MethodDataAccessor mda(*panda_file_, file_id_);
     return mda.GetNumericalAnnotation(field_id);
 }
@@ -318,6 +320,7 @@ panda_file::File::StringData Method::GetStringDataAnnotation(AnnotationField fie
 {
     ASSERT(field_id >= AnnotationField::STRING_DATA_BEGIN);
     ASSERT(field_id <= AnnotationField::STRING_DATA_END);
+    panda_file_->GetMethodOffsets(file_id_);
     panda_file::MethodDataAccessor mda(*panda_file_, file_id_);
     uint32_t str_offset = mda.GetNumericalAnnotation(field_id);
     if (str_offset == 0) {
@@ -335,8 +338,7 @@ uint32_t Method::FindCatchBlock(Class *cls, uint32_t pc) const
     VMHandle<ObjectHeader> exception(thread, thread->GetException());
     thread->ClearException();
 
-    panda_file::MethodDataAccessor mda(*panda_file_, file_id_);
-    panda_file::CodeDataAccessor cda(*panda_file_, mda.GetCodeId().value());
+    panda_file::CodeDataAccessor cda(*panda_file_, code_id_);
 
     uint32_t pc_offset = panda_file::INVALID_OFFSET;
 
@@ -485,6 +487,9 @@ private:
 
 int32_t Method::GetLineNumFromBytecodeOffset(uint32_t bc_offset) const
 {
+    // Stack traces and the heap sampler look up lines repeatedly, the table of method offsets lets the accessor
+    // skip to the debug info directly
+    panda_file_->GetMethodOffsets(file_id_);
     panda_file::MethodDataAccessor mda(*panda_file_, file_id_);
     auto debug_info_id = mda.GetDebugInfoId();
     if (!debug_info_id) {
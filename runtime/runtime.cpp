@@ -35,7 +35,9 @@
 #include "libpandabase/utils/utf.h"
 #include "libpandafile/file-inl.h"
 #include "libpandafile/literal_data_accessor-inl.h"
+#include "libpandafile/panda_cache.h"
 #include "libpandafile/proto_data_accessor-inl.h"
+#include "runtime/class_preloader.h"
 #include "runtime/core/core_language_context.h"
 #include "runtime/dprofiler/dprofiler.h"
 #include "runtime/entrypoints/entrypoints.h"
@@ -60,6 +62,7 @@
 #include "runtime/tooling/debugger.h"
 #include "runtime/tooling/pt_lang_ext_private.h"
 #include "runtime/include/file_manager.h"
+#include "runtime/snapshot.h"
 #include "trace/trace.h"
 #include "verification/cache/file_entity_cache.h"
 #include "verification/cache/results_cache.h"
@@ -230,7 +233,9 @@ bool Runtime::Create(const RuntimeOptions &options, const std::vector<LanguageCo
     trace::ScopedTrace scoped_trace("Runtime::Create");
 
     panda::mem::MemConfig::Initialize(options.GetHeapSizeLimit(), options.GetInternalMemorySizeLimit(),
-                                      options.GetCompilerMemorySizeLimit(), options.GetCodeCacheSizeLimit());
+                                      options.GetCompilerMemorySizeLimit(), options.GetCodeCacheSizeLimit(),
+                                      options.IsHeapHugePagesEnabled(), options.GetFreePoolsResidentSize(),
+                                      options.GetFreePoolIdleTimeMs());
     PoolManager::Initialize();
 
     mem::InternalAllocatorPtr internal_allocator =
@@ -312,6 +317,8 @@ bool Runtime::Destroy()
 
     instance->GetPandaVM()->UninitializeThreads();
 
+    instance->DumpHeapSamplingProfile();
+
     verifier::JobQueue::Stop(instance->GetVerificationOptions().Mode.OnlyVerify);
 
     instance->GetNotificationManager()->VmDeathEvent();
@@ -555,6 +562,7 @@ bool Runtime::CreatePandaVM(std::string_view runtime_type)
         // because EcmaVM patches bytecode in-place
         open_mode = panda_file::File::READ_WRITE;
     }
+    panda_file::SetExtractionCacheDir(options_.GetPandaFilesExtractionCache());
     bool load_boot_panda_files_is_failed = options_.ShouldLoadBootPandaFiles() && !LoadBootPandaFiles(open_mode);
     if (load_boot_panda_files_is_failed) {
         LOG(ERROR, RUNTIME) << "Failed to load boot panda files";
@@ -687,10 +695,7 @@ Expected<Method *, Runtime::Error> Runtime::ResolveEntryPoint(std::string_view e
     auto method_name_bytes = utf::CStringAsMutf8(method_name.c_str());
 
     Class *cls = nullptr;
-    ClassLinkerContext *context = app_context_.ctx;
-    if (context == nullptr) {
-        context = class_linker_->GetExtension(GetLanguageContext(options_.GetRuntimeType()))->GetBootContext();
-    }
+    ClassLinkerContext *context = GetAppOrBootContext();
 
     ManagedThread *thread = ManagedThread::GetCurrent();
     if (MTManagedThread::ThreadIsMTManagedThread(thread)) {
@@ -735,6 +740,29 @@ PandaString Runtime::GetFinalStatistics()
     return panda_vm_->GetGCStats()->GetFinalStatistics(panda_vm_->GetHeapManager());
 }
 
+PandaString Runtime::GetPandaCacheStatistics()
+{
+    PandaOStringStream statistics;
+    auto print = [&statistics](const char *name, size_t size, panda_file::PandaCache::Statistics stat) {
+        uint64_t lookups = stat.hits + stat.misses;
+        statistics << "  " << name << ": " << stat.hits << " hits of " << lookups << " lookups";
+        if (lookups != 0) {
+            constexpr double PERCENT = 100.0;
+            statistics << " (" << PERCENT * static_cast<double>(stat.hits) / static_cast<double>(lookups) << "%)";
+        }
+        statistics << ", " << size << " entries\n";
+    };
+    class_linker_->EnumeratePandaFiles([&statistics, &print](const panda_file::File &pf) {
+        const panda_file::PandaCache *cache = pf.GetPandaCache();
+        statistics << "Panda cache of " << pf.GetFilename() << ":\n";
+        print("methods", cache->GetMethodCacheSize(), cache->GetMethodStatistics());
+        print("fields", cache->GetFieldCacheSize(), cache->GetFieldStatistics());
+        print("classes", cache->GetClassCacheSize(), cache->GetClassStatistics());
+        return true;
+    });
+    return statistics.str();
+}
+
 void Runtime::NotifyAboutLoadedModules()
 {
     PandaVector<const panda_file::File *> pfs;
@@ -859,8 +887,69 @@ Expected<int, Runtime::Error> Runtime::ExecutePandaFile(std::string_view filenam
     return Execute(entry_point, args);
 }
 
+ClassLinkerContext *Runtime::GetAppOrBootContext()
+{
+    if (app_context_.ctx != nullptr) {
+        return app_context_.ctx;
+    }
+    return class_linker_->GetExtension(GetLanguageContext(options_.GetRuntimeType()))->GetBootContext();
+}
+
+void Runtime::PreloadClasses()
+{
+    PandaVector<PandaString> descriptors;
+    if (!ClassPreloader::ReadClassList(options_.GetPreloadClasses(), &descriptors)) {
+        return;
+    }
+
+    ClassPreloader preloader(class_linker_, GetAppOrBootContext());
+    preloader.Preload(descriptors, options_.GetPreloadClassesThreads());
+}
+
+void Runtime::RestoreSnapshot()
+{
+    RuntimeSnapshot snapshot;
+    if (!snapshot.Read(options_.GetSnapshotFile(), class_linker_)) {
+        return;
+    }
+
+    snapshot.PrefetchPages();
+    snapshot.PreloadClasses(class_linker_, GetAppOrBootContext(), options_.GetPreloadClassesThreads());
+
+    StringTable *string_table = panda_vm_->GetStringTable();
+    LanguageContext ctx = GetLanguageContext(options_.GetRuntimeType());
+    ManagedThread *thread = ManagedThread::GetCurrent();
+    if (MTManagedThread::ThreadIsMTManagedThread(thread)) {
+        ScopedManagedCodeThread s(static_cast<MTManagedThread *>(thread));
+        snapshot.InternStrings(string_table, ctx);
+    } else {
+        snapshot.InternStrings(string_table, ctx);
+    }
+}
+
+void Runtime::WriteSnapshot()
+{
+    RuntimeSnapshot snapshot;
+    // Boot classes go first, application classes depend on them
+    snapshot.AddClasses(class_linker_->GetExtension(GetLanguageContext(options_.GetRuntimeType()))->GetBootContext());
+    if (app_context_.ctx != nullptr) {
+        snapshot.AddClasses(app_context_.ctx);
+    }
+    snapshot.AddInternalStrings(panda_vm_->GetStringTable());
+    snapshot.AddResidentPages(class_linker_);
+    snapshot.Write(options_.GetSnapshotFile());
+}
+
 Expected<int, Runtime::Error> Runtime::Execute(std::string_view entry_point, const std::vector<std::string> &args)
 {
+    if (options_.IsSnapshotDeserializeEnabled()) {
+        RestoreSnapshot();
+    }
+
+    if (!options_.GetPreloadClasses().empty()) {
+        PreloadClasses();
+    }
+
     auto resolve_res = ResolveEntryPoint(entry_point);
     if (!resolve_res) {
         return Unexpected(resolve_res.Error());
@@ -870,7 +959,13 @@ Expected<int, Runtime::Error> Runtime::Execute(std::string_view entry_point, con
 
     Method *method = resolve_res.Value();
 
-    return panda_vm_->InvokeEntrypoint(method, args);
+    auto result = panda_vm_->InvokeEntrypoint(method, args);
+
+    if (options_.IsSnapshotSerializeEnabled()) {
+        WriteSnapshot();
+    }
+
+    return result;
 }
 
 void Runtime::RegisterAppInfo(const PandaVector<PandaString> &code_paths, const PandaString &profile_output_filename)
@@ -1159,6 +1254,21 @@ void Runtime::DumpForSigQuit(std::ostream &os)
     os << "-> Dump memory management\n";
     os << GetMemoryStatistics();
     os << "\n";
+
+    // dump heap sampling profile
+    if (DumpHeapSamplingProfile()) {
+        os << "-> Dump heap sampling profile to " << options_.GetHeapSamplingProfile() << "\n";
+        os << "\n";
+    }
+}
+
+bool Runtime::DumpHeapSamplingProfile()
+{
+    auto *heap_manager = panda_vm_->GetHeapManager();
+    if (heap_manager == nullptr || heap_manager->GetHeapSampler() == nullptr) {
+        return false;
+    }
+    return heap_manager->GetHeapSampler()->DumpProfile(options_.GetHeapSamplingProfile());
 }
 
 void Runtime::PreZygoteFork()
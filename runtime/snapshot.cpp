@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/snapshot.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "libpandabase/os/file.h"
+#include "libpandabase/os/mem.h"
+#include "libpandabase/utils/logger.h"
+#include "runtime/class_linker_context.h"
+#include "runtime/class_preloader.h"
+#include "runtime/include/class.h"
+#include "runtime/include/class_linker.h"
+#include "runtime/string_table.h"
+#include "securec.h"
+#include "trace/trace.h"
+
+namespace panda {
+
+template <class T>
+static void WriteValue(std::ofstream &out, const T &value)
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <class T>
+static bool ReadValue(Span<const uint8_t> *data, T *value)
+{
+    if (data->size() < sizeof(T)) {
+        return false;
+    }
+    (void)memcpy_s(value, sizeof(T), data->data(), sizeof(T));
+    *data = data->SubSpan(sizeof(T));
+    return true;
+}
+
+void RuntimeSnapshot::AddEntity(PandaVector<Entity> *entities, const panda_file::File &pf,
+                                panda_file::File::EntityId id)
+{
+    if (std::find(files_.begin(), files_.end(), &pf) == files_.end()) {
+        files_.push_back(&pf);
+    }
+    entities->push_back({&pf, id});
+}
+
+void RuntimeSnapshot::AddClasses(ClassLinkerContext *context)
+{
+    context->EnumerateClasses([this](Class *klass) {
+        // Arrays, primitive and synthetic classes are not defined in panda files, they are created on demand
+        const panda_file::File *pf = klass->GetPandaFile();
+        if (pf != nullptr) {
+            AddEntity(&classes_, *pf, klass->GetFileId());
+        }
+        return true;
+    });
+}
+
+void RuntimeSnapshot::AddInternalStrings(StringTable *string_table)
+{
+    string_table->VisitInternalStringIds(
+        [this](const panda_file::File &pf, panda_file::File::EntityId id) { AddEntity(&strings_, pf, id); });
+}
+
+void RuntimeSnapshot::AddResidentPages(ClassLinker *class_linker)
+{
+    class_linker->EnumeratePandaFiles([this](const panda_file::File &pf) {
+        for (uint32_t offset : pf.GetResidentPages()) {
+            AddEntity(&pages_, pf, panda_file::File::EntityId(offset));
+        }
+        return true;
+    });
+}
+
+bool RuntimeSnapshot::Write(std::string_view file_name) const
+{
+    trace::ScopedTrace scoped_trace("Write runtime snapshot");
+    std::ofstream out(std::string(file_name), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG(ERROR, RUNTIME) << "Cannot open snapshot file " << file_name;
+        return false;
+    }
+
+    Header header {MAGIC, VERSION, static_cast<uint32_t>(files_.size()), static_cast<uint32_t>(classes_.size()),
+                   static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(pages_.size())};
+    WriteValue(out, header);
+    for (const panda_file::File *pf : files_) {
+        const std::string &pf_name = pf->GetFilename();
+        WriteValue(out, pf->GetHeader()->checksum);
+        WriteValue(out, static_cast<uint32_t>(pf_name.size()));
+        out.write(pf_name.data(), static_cast<std::streamsize>(pf_name.size()));
+    }
+    auto write_records = [this, &out](const PandaVector<Entity> &entities) {
+        for (const auto &entity : entities) {
+            auto file_index = std::find(files_.begin(), files_.end(), entity.pf) - files_.begin();
+            WriteValue(out, Record {static_cast<uint32_t>(file_index), entity.id.GetOffset()});
+        }
+    };
+    write_records(classes_);
+    write_records(strings_);
+    write_records(pages_);
+
+    if (!out) {
+        LOG(ERROR, RUNTIME) << "Cannot write snapshot file " << file_name;
+        return false;
+    }
+    LOG(INFO, RUNTIME) << "Snapshot with " << classes_.size() << " classes, " << strings_.size() << " strings and "
+                       << pages_.size() << " pages is written to " << file_name;
+    return true;
+}
+
+bool RuntimeSnapshot::Read(std::string_view file_name, ClassLinker *class_linker)
+{
+    trace::ScopedTrace scoped_trace("Read runtime snapshot");
+    auto file = os::file::Open(file_name, os::file::Mode::READONLY);
+    if (!file.IsValid()) {
+        LOG(DEBUG, RUNTIME) << "Cannot open snapshot file " << file_name;
+        return false;
+    }
+    os::file::FileHolder file_holder(file);
+    auto file_size = file.GetFileSize();
+    if (!file_size || file_size.Value() < sizeof(Header)) {
+        LOG(ERROR, RUNTIME) << "Invalid snapshot file " << file_name;
+        return false;
+    }
+    os::mem::ConstBytePtr ptr =
+        os::mem::MapFile(file, os::mem::MMAP_PROT_READ, os::mem::MMAP_FLAG_PRIVATE, file_size.Value()).ToConst();
+    if (ptr.Get() == nullptr) {
+        PLOG(ERROR, RUNTIME) << "Cannot map snapshot file " << file_name;
+        return false;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    Span<const uint8_t> data(reinterpret_cast<const uint8_t *>(ptr.Get()), file_size.Value());
+    Header header {};
+    ReadValue(&data, &header);
+    if (header.magic != MAGIC || header.version != VERSION) {
+        LOG(ERROR, RUNTIME) << "Invalid snapshot file " << file_name;
+        return false;
+    }
+
+    PandaVector<const panda_file::File *> files;
+    for (uint32_t i = 0; i < header.files_count; i++) {
+        uint32_t checksum = 0;
+        uint32_t name_size = 0;
+        if (!ReadValue(&data, &checksum) || !ReadValue(&data, &name_size) || data.size() < name_size) {
+            LOG(ERROR, RUNTIME) << "Invalid snapshot file " << file_name;
+            return false;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::string_view pf_name(reinterpret_cast<const char *>(data.data()), name_size);
+        data = data.SubSpan(name_size);
+
+        const panda_file::File *found_pf = nullptr;
+        class_linker->EnumeratePandaFiles([pf_name, checksum, &found_pf](const panda_file::File &pf) {
+            if (pf.GetFilename() == pf_name && pf.GetHeader()->checksum == checksum) {
+                found_pf = &pf;
+                return false;
+            }
+            return true;
+        });
+        if (found_pf == nullptr) {
+            LOG(INFO, RUNTIME) << "Snapshot records of " << pf_name
+                               << " are ignored, the file is changed or not loaded";
+        }
+        files.push_back(found_pf);
+    }
+
+    if (!ReadRecords(&data, header.classes_count, files, &classes_) ||
+        !ReadRecords(&data, header.strings_count, files, &strings_) ||
+        !ReadRecords(&data, header.pages_count, files, &pages_)) {
+        LOG(ERROR, RUNTIME) << "Invalid snapshot file " << file_name;
+        classes_.clear();
+        strings_.clear();
+        pages_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RuntimeSnapshot::ReadRecords(Span<const uint8_t> *data, uint32_t count,
+                                  const PandaVector<const panda_file::File *> &files, PandaVector<Entity> *entities)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        Record record {};
+        if (!ReadValue(data, &record) || record.file_index >= files.size()) {
+            return false;
+        }
+        const panda_file::File *pf = files[record.file_index];
+        if (pf == nullptr) {
+            continue;
+        }
+        if (record.offset >= pf->GetHeader()->file_size) {
+            return false;
+        }
+        entities->push_back({pf, panda_file::File::EntityId(record.offset)});
+    }
+    return true;
+}
+
+void RuntimeSnapshot::PrefetchPages() const
+{
+    trace::ScopedTrace scoped_trace("Prefetch snapshot pages");
+    // Pages of a file are written together and in order
+    std::vector<uint32_t> offsets;
+    for (size_t i = 0; i < pages_.size(); i++) {
+        offsets.push_back(pages_[i].id.GetOffset());
+        if (i + 1 == pages_.size() || pages_[i + 1].pf != pages_[i].pf) {
+            pages_[i].pf->PrefetchPages(offsets);
+            offsets.clear();
+        }
+    }
+}
+
+size_t RuntimeSnapshot::PreloadClasses(ClassLinker *class_linker, ClassLinkerContext *context,
+                                       size_t threads_count) const
+{
+    PandaVector<const uint8_t *> descriptors;
+    descriptors.reserve(classes_.size());
+    for (const auto &entity : classes_) {
+        descriptors.push_back(entity.pf->GetStringData(entity.id).data);
+    }
+    ClassPreloader preloader(class_linker, context);
+    return preloader.Preload(descriptors, threads_count);
+}
+
+size_t RuntimeSnapshot::InternStrings(StringTable *string_table, LanguageContext ctx) const
+{
+    trace::ScopedTrace scoped_trace("Intern snapshot strings");
+    size_t interned_strings = 0;
+    for (const auto &entity : strings_) {
+        if (string_table->GetOrInternInternalString(*entity.pf, entity.id, ctx) != nullptr) {
+            interned_strings++;
+        }
+    }
+    return interned_strings;
+}
+
+}  // namespace panda
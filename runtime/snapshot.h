@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PANDA_RUNTIME_SNAPSHOT_H_
+#define PANDA_RUNTIME_SNAPSHOT_H_
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "libpandabase/macros.h"
+#include "libpandafile/file.h"
+#include "runtime/include/language_context.h"
+#include "runtime/include/mem/panda_containers.h"
+
+namespace panda {
+
+class ClassLinker;
+class ClassLinkerContext;
+class StringTable;
+
+/**
+ * Startup snapshot of the runtime.
+ * It records the classes loaded, the panda file strings interned and the panda file pages touched during a run,
+ * so the next run can read these pages ahead, load the classes in parallel and intern the strings before
+ * the entry point starts.
+ * Classes and strings are stored as offsets in panda files, so the snapshot doesn't depend on addresses.
+ * Panda files are identified by name and checksum, records of a changed or missing file are ignored.
+ */
+class RuntimeSnapshot {
+public:
+    RuntimeSnapshot() = default;
+    ~RuntimeSnapshot() = default;
+    NO_COPY_SEMANTIC(RuntimeSnapshot);
+    NO_MOVE_SEMANTIC(RuntimeSnapshot);
+
+    /**
+     * \brief Record classes loaded in the context
+     */
+    void AddClasses(ClassLinkerContext *context);
+
+    /**
+     * \brief Record strings from panda files interned in the string table
+     */
+    void AddInternalStrings(StringTable *string_table);
+
+    /**
+     * \brief Record pages of the panda files resident in memory, they approximate the pages touched by the run
+     */
+    void AddResidentPages(ClassLinker *class_linker);
+
+    /**
+     * \brief Write the snapshot to the file
+     * @return true if the snapshot was written successfully
+     */
+    bool Write(std::string_view file_name) const;
+
+    /**
+     * \brief Read the snapshot from the file and resolve its records in the panda files loaded by the class linker
+     * @return false if the file cannot be read or it is not a valid snapshot
+     */
+    bool Read(std::string_view file_name, ClassLinker *class_linker);
+
+    /**
+     * \brief Start reading the recorded pages of the panda files ahead
+     */
+    void PrefetchPages() const;
+
+    /**
+     * \brief Load and link the recorded classes in parallel, see ClassPreloader
+     * @return number of loaded classes
+     */
+    size_t PreloadClasses(ClassLinker *class_linker, ClassLinkerContext *context, size_t threads_count) const;
+
+    /**
+     * \brief Intern the recorded strings, must be called from a managed thread in the managed code
+     * @return number of interned strings
+     */
+    size_t InternStrings(StringTable *string_table, LanguageContext ctx) const;
+
+    size_t GetClassesCount() const
+    {
+        return classes_.size();
+    }
+
+    size_t GetStringsCount() const
+    {
+        return strings_.size();
+    }
+
+    size_t GetPagesCount() const
+    {
+        return pages_.size();
+    }
+
+private:
+    static constexpr std::array<char, 8> MAGIC = {'P', 'A', 'N', 'D', 'A', 'S', 'N', 'P'};
+    static constexpr uint32_t VERSION = 2;
+
+    struct Header {
+        std::array<char, MAGIC.size()> magic;
+        uint32_t version;
+        uint32_t files_count;
+        uint32_t classes_count;
+        uint32_t strings_count;
+        uint32_t pages_count;
+    };
+
+    struct Record {
+        uint32_t file_index;
+        uint32_t offset;
+    };
+
+    struct Entity {
+        const panda_file::File *pf;
+        panda_file::File::EntityId id;
+    };
+
+    void AddEntity(PandaVector<Entity> *entities, const panda_file::File &pf, panda_file::File::EntityId id);
+    static bool ReadRecords(Span<const uint8_t> *data, uint32_t count,
+                            const PandaVector<const panda_file::File *> &files, PandaVector<Entity> *entities);
+
+    PandaVector<const panda_file::File *> files_;
+    PandaVector<Entity> classes_;
+    PandaVector<Entity> strings_;
+    // Offsets of the pages are stored as entity ids
+    PandaVector<Entity> pages_;
+};
+
+}  // namespace panda
+
+#endif  // PANDA_RUNTIME_SNAPSHOT_H_
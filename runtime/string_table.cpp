@@ -15,11 +15,167 @@
 
 #include "runtime/string_table.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "runtime/include/runtime.h"
 #include "runtime/mem/object_helpers.h"
+#include "runtime/thread_pool.h"
 
 namespace panda {
 
+class StringTableSweepTask {
+public:
+    StringTableSweepTask() = default;
+    explicit StringTableSweepTask(StringTableSweeper *sweeper) : sweeper_(sweeper) {}
+    ~StringTableSweepTask() = default;
+    DEFAULT_COPY_SEMANTIC(StringTableSweepTask);
+    DEFAULT_MOVE_SEMANTIC(StringTableSweepTask);
+
+    bool IsEmpty() const
+    {
+        return sweeper_ == nullptr;
+    }
+
+    StringTableSweeper *GetSweeper() const
+    {
+        return sweeper_;
+    }
+
+private:
+    StringTableSweeper *sweeper_ {nullptr};
+};
+
+class StringTableSweepQueue : public TaskQueueInterface<StringTableSweepTask> {
+public:
+    explicit StringTableSweepQueue(mem::InternalAllocatorPtr allocator) : queue_(allocator->Adapter()) {}
+    ~StringTableSweepQueue() override = default;
+    NO_COPY_SEMANTIC(StringTableSweepQueue);
+    NO_MOVE_SEMANTIC(StringTableSweepQueue);
+
+    StringTableSweepTask GetTask() override
+    {
+        if (queue_.empty()) {
+            return StringTableSweepTask();
+        }
+        auto task = queue_.front();
+        queue_.pop_front();
+        return task;
+    }
+
+    // NOLINTNEXTLINE(google-default-arguments)
+    void AddTask(StringTableSweepTask task, [[maybe_unused]] size_t priority = 0) override
+    {
+        queue_.push_back(task);
+    }
+
+    void Finalize() override
+    {
+        queue_.clear();
+    }
+
+protected:
+    size_t GetQueueSize() override
+    {
+        return queue_.size();
+    }
+
+private:
+    PandaDeque<StringTableSweepTask> queue_;
+};
+
+/**
+ * Worker of the string table sweeper. Sweeping runs while the mutators are suspended and touches only
+ * the string headers and the GC data, so the worker isn't attached to the runtime
+ */
+class StringTableSweepProcessor : public ProcessorInterface<StringTableSweepTask, void *> {
+public:
+    explicit StringTableSweepProcessor([[maybe_unused]] void *args) {}
+    ~StringTableSweepProcessor() override = default;
+    NO_COPY_SEMANTIC(StringTableSweepProcessor);
+    NO_MOVE_SEMANTIC(StringTableSweepProcessor);
+
+    bool Init() override
+    {
+        return true;
+    }
+
+    bool Process(StringTableSweepTask task) override;
+
+    bool Destroy() override
+    {
+        return true;
+    }
+};
+
+/**
+ * Runs the work on the calling thread and the pool of workers at the same time.
+ * The work itself distributes the shards between the threads which run it
+ */
+class StringTableSweeper {
+public:
+    StringTableSweeper(mem::InternalAllocatorPtr allocator, size_t threads_count)
+        : threads_count_(threads_count),
+          queue_(allocator),
+          thread_pool_(allocator, &queue_, nullptr, threads_count, "StringTableSweep")
+    {
+    }
+    ~StringTableSweeper() = default;
+    NO_COPY_SEMANTIC(StringTableSweeper);
+    NO_MOVE_SEMANTIC(StringTableSweeper);
+
+    /**
+     * \brief Run the work on the calling thread and all the workers, return when every thread finishes it
+     */
+    void Run(const std::function<void()> &work)
+    {
+        {
+            os::memory::LockHolder lock(pending_lock_);
+            work_ = &work;
+            pending_tasks_ = threads_count_;
+        }
+        for (size_t i = 0; i < threads_count_; i++) {
+            thread_pool_.PutTask(StringTableSweepTask(this));
+        }
+        work();
+        os::memory::LockHolder lock(pending_lock_);
+        while (pending_tasks_ != 0) {
+            pending_cond_var_.Wait(&pending_lock_);
+        }
+        work_ = nullptr;
+    }
+
+    void RunTask()
+    {
+        const std::function<void()> *work = nullptr;
+        {
+            os::memory::LockHolder lock(pending_lock_);
+            work = work_;
+        }
+        (*work)();
+        os::memory::LockHolder lock(pending_lock_);
+        ASSERT(pending_tasks_ > 0);
+        if (--pending_tasks_ == 0) {
+            pending_cond_var_.Signal();
+        }
+    }
+
+private:
+    size_t threads_count_;
+    StringTableSweepQueue queue_;
+    ThreadPool<StringTableSweepTask, StringTableSweepProcessor, void *> thread_pool_;
+    os::memory::Mutex pending_lock_;
+    os::memory::ConditionVariable pending_cond_var_;
+    const std::function<void()> *work_ GUARDED_BY(pending_lock_) {nullptr};
+    size_t pending_tasks_ GUARDED_BY(pending_lock_) {0};
+};
+
+bool StringTableSweepProcessor::Process(StringTableSweepTask task)
+{
+    task.GetSweeper()->RunTask();
+    return true;
+}
+
 coretypes::String *StringTable::GetOrInternString(const uint8_t *mutf8_data, uint32_t utf16_length, LanguageContext ctx)
 {
     bool can_be_compressed = coretypes::String::CanBeCompressedMUtf8(mutf8_data);
@@ -42,6 +198,11 @@ coretypes::String *StringTable::GetOrInternString(const uint16_t *utf16_data, ui
 
 coretypes::String *StringTable::GetOrInternString(coretypes::String *string, LanguageContext ctx)
 {
+    // Interned strings are flat, so lookups under the locks of the tables don't flatten strings
+    string = coretypes::String::Flatten(string);
+    if (string == nullptr) {
+        return nullptr;
+    }
     auto *str = internal_table_.GetString(string, ctx);
     if (str == nullptr) {
         str = table_.GetOrInternString(string, ctx);
@@ -65,6 +226,11 @@ void StringTable::Sweep(const GCObjectVisitor &gc_object_visitor)
     table_.Sweep(gc_object_visitor);
 }
 
+void StringTable::SweepNew(const GCObjectVisitor &gc_object_visitor)
+{
+    table_.SweepNew(gc_object_visitor);
+}
+
 bool StringTable::UpdateMoved()
 {
     return table_.UpdateMoved();
@@ -79,8 +245,9 @@ coretypes::String *StringTable::Table::GetString(const uint8_t *utf8_data, uint3
                                                  bool can_be_compressed, [[maybe_unused]] LanguageContext ctx)
 {
     uint32_t hash_code = coretypes::String::ComputeHashcodeMutf8(utf8_data, utf16_length, can_be_compressed);
-    os::memory::ReadLockHolder holder(table_lock_);
-    for (auto it = table_.find(hash_code); it != table_.end(); it++) {
+    auto &shard = GetShard(hash_code);
+    os::memory::ReadLockHolder holder(shard.lock);
+    for (auto it = shard.table.find(hash_code); it != shard.table.end(); it++) {
         auto found_string = it->second;
         if (coretypes::String::StringsAreEqualMUtf8(found_string, utf8_data, utf16_length, can_be_compressed)) {
             return found_string;
@@ -93,8 +260,9 @@ coretypes::String *StringTable::Table::GetString(const uint16_t *utf16_data, uin
                                                  [[maybe_unused]] LanguageContext ctx)
 {
     uint32_t hash_code = coretypes::String::ComputeHashcodeUtf16(const_cast<uint16_t *>(utf16_data), utf16_length);
-    os::memory::ReadLockHolder holder(table_lock_);
-    for (auto it = table_.find(hash_code); it != table_.end(); it++) {
+    auto &shard = GetShard(hash_code);
+    os::memory::ReadLockHolder holder(shard.lock);
+    for (auto it = shard.table.find(hash_code); it != shard.table.end(); it++) {
         auto found_string = it->second;
         if (coretypes::String::StringsAreEqualUtf16(found_string, utf16_data, utf16_length)) {
             return found_string;
@@ -106,9 +274,10 @@ coretypes::String *StringTable::Table::GetString(const uint16_t *utf16_data, uin
 coretypes::String *StringTable::Table::GetString([[maybe_unused]] coretypes::String *string,
                                                  [[maybe_unused]] LanguageContext ctx)
 {
-    os::memory::ReadLockHolder holder(table_lock_);
     auto hash = string->GetHashcode();
-    for (auto it = table_.find(hash); it != table_.end(); it++) {
+    auto &shard = GetShard(hash);
+    os::memory::ReadLockHolder holder(shard.lock);
+    for (auto it = shard.table.find(hash); it != shard.table.end(); it++) {
         auto found_string = it->second;
         if (coretypes::String::StringsAreEqual(found_string, string)) {
             return found_string;
@@ -119,25 +288,44 @@ coretypes::String *StringTable::Table::GetString([[maybe_unused]] coretypes::Str
 
 void StringTable::Table::ForceInternString(coretypes::String *string, [[maybe_unused]] LanguageContext ctx)
 {
-    os::memory::WriteLockHolder holder(table_lock_);
-    table_.insert(std::pair<uint32_t, coretypes::String *>(string->GetHashcode(), string));
+    uint32_t hash_code = string->GetHashcode();
+    auto &shard = GetShard(hash_code);
+    os::memory::WriteLockHolder holder(shard.lock);
+    shard.table.insert(std::pair<uint32_t, coretypes::String *>(hash_code, string));
+    RecordNewString(&shard, hash_code, string);
 }
 
 coretypes::String *StringTable::Table::InternString(coretypes::String *string, [[maybe_unused]] LanguageContext ctx)
 {
     uint32_t hash_code = string->GetHashcode();
-    os::memory::WriteLockHolder holder(table_lock_);
+    auto &shard = GetShard(hash_code);
+    os::memory::WriteLockHolder holder(shard.lock);
     // Check string is not present before actually creating and inserting
-    for (auto it = table_.find(hash_code); it != table_.end(); it++) {
+    for (auto it = shard.table.find(hash_code); it != shard.table.end(); it++) {
         auto found_string = it->second;
         if (coretypes::String::StringsAreEqual(found_string, string)) {
             return found_string;
         }
     }
-    table_.insert(std::pair<uint32_t, coretypes::String *>(hash_code, string));
+    shard.table.insert(std::pair<uint32_t, coretypes::String *>(hash_code, string));
+    RecordNewString(&shard, hash_code, string);
     return string;
 }
 
+void StringTable::Table::RecordNewString(Shard *shard, uint32_t hash_code, coretypes::String *string)
+{
+    if (!record_new_strings_ || shard->new_strings_overflow) {
+        return;
+    }
+    // Sweeping the whole shard is not much slower when a large part of it is new
+    if (shard->new_strings.size() >= std::max(shard->table.size() / 2U, MIN_NEW_STRINGS_LIMIT)) {
+        shard->new_strings_overflow = true;
+        shard->new_strings.clear();
+        return;
+    }
+    shard->new_strings.emplace_back(hash_code, string);
+}
+
 coretypes::String *StringTable::Table::GetOrInternString(const uint8_t *mutf8_data, uint32_t utf16_length,
                                                          bool can_be_compressed, LanguageContext ctx)
 {
@@ -183,53 +371,145 @@ coretypes::String *StringTable::Table::GetOrInternString(coretypes::String *stri
 
 bool StringTable::Table::UpdateMoved()
 {
-    os::memory::WriteLockHolder holder(table_lock_);
     LOG(DEBUG, GC) << "=== StringTable Update moved. BEGIN ===";
-    LOG(DEBUG, GC) << "Iterate over: " << table_.size() << " elements in string table";
-    bool updated = false;
-    for (auto it = table_.begin(), end = table_.end(); it != end;) {
-        auto *object = it->second;
-        if (object->IsForwarded()) {
-            ObjectHeader *fwd_string = panda::mem::GetForwardAddress(object);
-            it->second = static_cast<coretypes::String *>(fwd_string);
-            LOG(DEBUG, GC) << "StringTable: forward " << std::hex << object << " -> " << fwd_string;
-            updated = true;
+    std::atomic<bool> updated {false};
+    ProcessShards([&updated](Shard *shard) {
+        for (auto &[hash_code, object] : shard->table) {
+            if (object->IsForwarded()) {
+                ObjectHeader *fwd_string = panda::mem::GetForwardAddress(object);
+                LOG(DEBUG, GC) << "StringTable: forward " << std::hex << object << " -> " << fwd_string;
+                object = static_cast<coretypes::String *>(fwd_string);
+                updated.store(true, std::memory_order_relaxed);
+            }
         }
-        ++it;
-    }
+    });
     LOG(DEBUG, GC) << "=== StringTable Update moved. END ===";
-    return updated;
+    return updated.load(std::memory_order_relaxed);
 }
 
-void StringTable::Table::Sweep(const GCObjectVisitor &gc_object_visitor)
+/**
+ * Update the entry of the table if the string is moved
+ * @return false if the string is dead and the entry should be removed
+ */
+static bool SweepString(coretypes::String **entry, const GCObjectVisitor &gc_object_visitor)
 {
-    os::memory::WriteLockHolder holder(table_lock_);
-    LOG(DEBUG, GC) << "=== StringTable Sweep. BEGIN ===";
-    LOG(DEBUG, GC) << "StringTable iterate over: " << table_.size() << " elements in string table";
-    for (auto it = table_.begin(), end = table_.end(); it != end;) {
-        auto *object = it->second;
-        if (object->IsForwarded()) {
-            ASSERT(gc_object_visitor(object) != ObjectStatus::DEAD_OBJECT);
-            ObjectHeader *fwd_string = panda::mem::GetForwardAddress(object);
-            it->second = static_cast<coretypes::String *>(fwd_string);
+    auto *object = *entry;
+    if (object->IsForwarded()) {
+        ASSERT(gc_object_visitor(object) != ObjectStatus::DEAD_OBJECT);
+        ObjectHeader *fwd_string = panda::mem::GetForwardAddress(object);
+        *entry = static_cast<coretypes::String *>(fwd_string);
+        LOG(DEBUG, GC) << "StringTable: forward " << std::hex << object << " -> " << fwd_string;
+        return true;
+    }
+    if (gc_object_visitor(object) == ObjectStatus::DEAD_OBJECT) {
+        LOG(DEBUG, GC) << "StringTable: delete string " << std::hex << object << ", val = " << ConvertToString(object);
+        return false;
+    }
+    return true;
+}
+
+/* static */
+void StringTable::Table::SweepShard(Shard *shard, const GCObjectVisitor &gc_object_visitor)
+{
+    for (auto it = shard->table.begin(), end = shard->table.end(); it != end;) {
+        if (SweepString(&it->second, gc_object_visitor)) {
             ++it;
-            LOG(DEBUG, GC) << "StringTable: forward " << std::hex << object << " -> " << fwd_string;
-        } else if (gc_object_visitor(object) == ObjectStatus::DEAD_OBJECT) {
-            LOG(DEBUG, GC) << "StringTable: delete string " << std::hex << object
-                           << ", val = " << ConvertToString(object);
-            table_.erase(it++);
         } else {
-            ++it;
+            shard->table.erase(it++);
+        }
+    }
+}
+
+StringTable::Table::~Table()
+{
+    if (sweeper_ != nullptr) {
+        Runtime::GetCurrent()->GetInternalAllocator()->Delete(sweeper_);
+    }
+}
+
+StringTableSweeper *StringTable::Table::GetSweeper()
+{
+    if (sweeper_ != nullptr) {
+        return sweeper_;
+    }
+    if (Runtime::GetOptions().GetGcStringTableThreads() == 0 || Size() < MIN_PARALLEL_SWEEP_SIZE) {
+        return nullptr;
+    }
+    mem::InternalAllocatorPtr allocator = Runtime::GetCurrent()->GetInternalAllocator();
+    sweeper_ = allocator->New<StringTableSweeper>(allocator, Runtime::GetOptions().GetGcStringTableThreads());
+    return sweeper_;
+}
+
+void StringTable::Table::ProcessShards(const std::function<void(Shard *)> &processor)
+{
+    // Shards are taken one by one, so a thread which gets a large shard doesn't delay the others
+    std::atomic<size_t> next_shard {0};
+    std::function<void()> work = [this, &next_shard, &processor]() {
+        for (size_t i = next_shard.fetch_add(1); i < SHARDS_NUM; i = next_shard.fetch_add(1)) {
+            os::memory::WriteLockHolder holder(shards_[i].lock);
+            processor(&shards_[i]);
         }
+    };
+    StringTableSweeper *sweeper = GetSweeper();
+    if (sweeper != nullptr) {
+        sweeper->Run(work);
+    } else {
+        work();
     }
-    LOG(DEBUG, GC) << "StringTable size after sweep = " << table_.size();
+}
+
+void StringTable::Table::Sweep(const GCObjectVisitor &gc_object_visitor)
+{
+    LOG(DEBUG, GC) << "=== StringTable Sweep. BEGIN ===";
+    // Mutators are blocked only by the shards being swept
+    ProcessShards([&gc_object_visitor](Shard *shard) { SweepShard(shard, gc_object_visitor); });
+    LOG(DEBUG, GC) << "StringTable size after sweep = " << Size();
     LOG(DEBUG, GC) << "=== StringTable Sweep. END ===";
 }
 
+void StringTable::Table::SweepNew(const GCObjectVisitor &gc_object_visitor)
+{
+    LOG(DEBUG, GC) << "=== StringTable SweepNew. BEGIN ===";
+    for (auto &shard : shards_) {
+        os::memory::WriteLockHolder holder(shard.lock);
+        if (shard.new_strings_overflow) {
+            SweepShard(&shard, gc_object_visitor);
+        } else {
+            // A recorded string may be already removed from the table, then it isn't found
+            for (const auto &[hash_code, string] : shard.new_strings) {
+                auto [it, end] = shard.table.equal_range(hash_code);
+                while (it != end && it->second != string) {
+                    ++it;
+                }
+                if (it != end && !SweepString(&it->second, gc_object_visitor)) {
+                    shard.table.erase(it);
+                }
+            }
+        }
+        shard.new_strings.clear();
+        shard.new_strings_overflow = false;
+    }
+    LOG(DEBUG, GC) << "=== StringTable SweepNew. END ===";
+}
+
 size_t StringTable::Table::Size()
 {
-    os::memory::ReadLockHolder holder(table_lock_);
-    return table_.size();
+    size_t size = 0;
+    for (auto &shard : shards_) {
+        os::memory::ReadLockHolder holder(shard.lock);
+        size += shard.table.size();
+    }
+    return size;
+}
+
+void StringTable::Table::VisitStrings(const StringVisitor &visitor)
+{
+    for (auto &shard : shards_) {
+        os::memory::ReadLockHolder holder(shard.lock);
+        for (const auto &[hash_code, string] : shard.table) {
+            visitor(string);
+        }
+    }
 }
 
 coretypes::String *StringTable::InternalTable::GetOrInternString(const uint8_t *mutf8_data, uint32_t utf16_length,
@@ -266,8 +546,13 @@ coretypes::String *StringTable::InternalTable::GetOrInternString(const panda_fil
     if (result != nullptr) {
         return result;
     }
-    result = coretypes::String::CreateFromMUtf8(data.data, data.utf16_length, data.is_ascii, ctx,
-                                                Runtime::GetCurrent()->GetPandaVM(), false);
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    if (IsFileRegistered(pf)) {
+        // The file lives as long as the class linker, so the string may refer to the file data instead of a copy
+        result = coretypes::String::CreateFromExternalMUtf8(data.data, data.utf16_length, data.is_ascii, ctx, vm);
+    } else {
+        result = coretypes::String::CreateFromMUtf8(data.data, data.utf16_length, data.is_ascii, ctx, vm, false);
+    }
     result = InternStringNonMovable(result, ctx);
 
     // Update cache.
@@ -283,6 +568,23 @@ coretypes::String *StringTable::InternalTable::GetOrInternString(const panda_fil
     return result;
 }
 
+bool StringTable::InternalTable::IsFileRegistered(const panda_file::File &pf)
+{
+    {
+        os::memory::ReadLockHolder lock(maps_lock_);
+        if (registered_files_.count(&pf) != 0) {
+            return true;
+        }
+    }
+    // Files are never removed from the class linker, so only the registered ones are remembered
+    if (!Runtime::GetCurrent()->GetClassLinker()->IsPandaFileRegistered(&pf)) {
+        return false;
+    }
+    os::memory::WriteLockHolder lock(maps_lock_);
+    registered_files_.insert(&pf);
+    return true;
+}
+
 coretypes::String *StringTable::InternalTable::GetStringFast(const panda_file::File &pf, panda_file::File::EntityId id)
 {
     os::memory::ReadLockHolder lock(maps_lock_);
@@ -296,6 +598,16 @@ coretypes::String *StringTable::InternalTable::GetStringFast(const panda_file::F
     return nullptr;
 }
 
+void StringTable::InternalTable::VisitStringIds(const StringIdVisitor &visitor)
+{
+    os::memory::ReadLockHolder lock(maps_lock_);
+    for (const auto &[pf, ids] : maps_) {
+        for (const auto &id : ids) {
+            visitor(*pf, id.first);
+        }
+    }
+}
+
 void StringTable::InternalTable::VisitRoots(const StringVisitor &visitor, mem::VisitGCRootFlags flags)
 {
     ASSERT(BitCount(flags & (mem::VisitGCRootFlags::ACCESS_ROOT_ALL | mem::VisitGCRootFlags::ACCESS_ROOT_ONLY_NEW)) ==
@@ -305,20 +617,17 @@ void StringTable::InternalTable::VisitRoots(const StringVisitor &visitor, mem::V
                              mem::VisitGCRootFlags::END_RECORDING_NEW_ROOT)) <= 1);
     // need to set flags before we iterate, cause concurrent allocation should be in proper table
     if ((flags & mem::VisitGCRootFlags::START_RECORDING_NEW_ROOT) != 0) {
-        os::memory::WriteLockHolder holder(table_lock_);
+        os::memory::LockHolder holder(new_string_lock_);
         record_new_string_ = true;
     } else if ((flags & mem::VisitGCRootFlags::END_RECORDING_NEW_ROOT) != 0) {
-        os::memory::WriteLockHolder holder(table_lock_);
+        os::memory::LockHolder holder(new_string_lock_);
         record_new_string_ = false;
     }
 
     if ((flags & mem::VisitGCRootFlags::ACCESS_ROOT_ALL) != 0) {
-        os::memory::ReadLockHolder lock(table_lock_);
-        for (const auto &v : table_) {
-            visitor(v.second);
-        }
+        VisitStrings(visitor);
     } else if ((flags & mem::VisitGCRootFlags::ACCESS_ROOT_ONLY_NEW) != 0) {
-        os::memory::ReadLockHolder lock(table_lock_);
+        os::memory::LockHolder holder(new_string_lock_);
         for (const auto str : new_string_table_) {
             visitor(str);
         }
@@ -326,7 +635,7 @@ void StringTable::InternalTable::VisitRoots(const StringVisitor &visitor, mem::V
         LOG(FATAL, RUNTIME) << "Unknown VisitGCRootFlags: " << static_cast<uint32_t>(flags);
     }
     if ((flags & mem::VisitGCRootFlags::END_RECORDING_NEW_ROOT) != 0) {
-        os::memory::WriteLockHolder holder(table_lock_);
+        os::memory::LockHolder holder(new_string_lock_);
         new_string_table_.clear();
     }
 }
@@ -334,7 +643,9 @@ void StringTable::InternalTable::VisitRoots(const StringVisitor &visitor, mem::V
 coretypes::String *StringTable::InternalTable::InternStringNonMovable(coretypes::String *string, LanguageContext ctx)
 {
     auto *result = InternString(string, ctx);
-    os::memory::WriteLockHolder holder(table_lock_);
+    // The string is inserted before the flag is checked, so it is visited either by a concurrent
+    // VisitRoots with ACCESS_ROOT_ALL or as a new root
+    os::memory::LockHolder holder(new_string_lock_);
     if (record_new_string_) {
         new_string_table_.push_back(result);
     }
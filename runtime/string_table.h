@@ -16,10 +16,14 @@
 #ifndef PANDA_RUNTIME_STRING_TABLE_H_
 #define PANDA_RUNTIME_STRING_TABLE_H_
 
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <utility>
 
 #include "libpandabase/mem/mem.h"
 #include "libpandabase/os/mutex.h"
+#include "libpandabase/utils/math_helpers.h"
 #include "runtime/include/coretypes/string.h"
 #include "runtime/include/language_context.h"
 #include "runtime/include/mem/panda_containers.h"
@@ -30,6 +34,8 @@ namespace mem::test {
 class MultithreadedInternStringTableTest;
 }  // namespace mem::test
 
+class StringTableSweeper;
+
 class StringTable {
 public:
     explicit StringTable(mem::InternalAllocatorPtr allocator) : internal_table_(allocator), table_(allocator) {}
@@ -55,18 +61,42 @@ public:
         internal_table_.VisitRoots(visitor, flags);
     }
 
+    using StringIdVisitor = std::function<void(const panda_file::File &, panda_file::File::EntityId)>;
+
+    /**
+     * \brief Visit ids of the interned strings from panda files
+     * @param visitor - visitor which gets a panda file and an id of the string in it
+     */
+    void VisitInternalStringIds(const StringIdVisitor &visitor)
+    {
+        internal_table_.VisitStringIds(visitor);
+    }
+
     virtual void Sweep(const GCObjectVisitor &gc_object_visitor);
 
+    /**
+     * \brief Sweep only the strings interned since the previous call
+     * The visitor must consider the strings interned before alive, e.g. they aren't in the young space being collected
+     */
+    void SweepNew(const GCObjectVisitor &gc_object_visitor);
+
     bool UpdateMoved();
 
     size_t Size();
 
 protected:
+    /**
+     * Table of interned strings split into shards by the hash of the string.
+     * Each shard has its own lock, so lookups and insertions of strings from different shards don't contend,
+     * and sweeping and updating of moved strings block only the shard being processed
+     */
     class Table {
     public:
-        explicit Table(mem::InternalAllocatorPtr allocator) : table_(allocator->Adapter()) {}
+        explicit Table(mem::InternalAllocatorPtr allocator) : Table(allocator, std::make_index_sequence<SHARDS_NUM>())
+        {
+        }
         Table() = default;
-        virtual ~Table() = default;
+        virtual ~Table();
 
         virtual coretypes::String *GetOrInternString(const uint8_t *mutf8_data, uint32_t utf16_length,
                                                      bool can_be_compressed, LanguageContext ctx);
@@ -74,6 +104,7 @@ protected:
                                                      LanguageContext ctx);
         coretypes::String *GetOrInternString(coretypes::String *string, LanguageContext ctx);
         virtual void Sweep(const GCObjectVisitor &gc_object_visitor);
+        void SweepNew(const GCObjectVisitor &gc_object_visitor);
 
         bool UpdateMoved();
 
@@ -87,12 +118,68 @@ protected:
         coretypes::String *InternString(coretypes::String *string, LanguageContext ctx);
         void ForceInternString(coretypes::String *string, LanguageContext ctx);
 
+        static constexpr size_t SHARDS_NUM = 16;
+
     protected:
-        // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
-        PandaUnorderedMultiMap<uint32_t, coretypes::String *> table_ GUARDED_BY(table_lock_) {};
-        os::memory::RWLock table_lock_;  // NOLINT(misc-non-private-member-variables-in-classes)
-        
+        /**
+         * \brief Visit all strings of the table, shards are locked one by one
+         */
+        void VisitStrings(const StringVisitor &visitor);
+
+        // Strings of the internal table are roots, they are never swept
+        bool record_new_strings_ {true};
+
     private:
+        struct Shard {
+            Shard() = default;
+            explicit Shard(mem::InternalAllocatorPtr allocator)
+                : table(allocator->Adapter()), new_strings(allocator->Adapter())
+            {
+            }
+            ~Shard() = default;
+            NO_COPY_SEMANTIC(Shard);
+            NO_MOVE_SEMANTIC(Shard);
+
+            PandaUnorderedMultiMap<uint32_t, coretypes::String *> table GUARDED_BY(lock) {};
+            // Strings inserted since the last SweepNew. When there are too many of them, recording stops
+            // and SweepNew sweeps the whole shard
+            PandaVector<std::pair<uint32_t, coretypes::String *>> new_strings GUARDED_BY(lock) {};
+            bool new_strings_overflow GUARDED_BY(lock) {false};
+            os::memory::RWLock lock;
+        };
+
+        static constexpr size_t MIN_NEW_STRINGS_LIMIT = 256;
+        // Waking up the sweep workers doesn't pay off for smaller tables
+        static constexpr size_t MIN_PARALLEL_SWEEP_SIZE = 1U << 16U;
+
+        void RecordNewString(Shard *shard, uint32_t hash_code, coretypes::String *string);
+        static void SweepShard(Shard *shard, const GCObjectVisitor &gc_object_visitor);
+
+        /**
+         * \brief Process all shards under their write locks
+         * Large tables are processed by the GC thread together with the sweep workers, each shard by one thread
+         */
+        void ProcessShards(const std::function<void(Shard *)> &processor);
+        StringTableSweeper *GetSweeper();
+
+        template <size_t... INDICES>
+        Table(mem::InternalAllocatorPtr allocator, [[maybe_unused]] std::index_sequence<INDICES...> indices)
+            : shards_ {{((void)INDICES, Shard(allocator))...}}
+        {
+        }
+
+        Shard &GetShard(uint32_t hash_code)
+        {
+            // Buckets of the shard maps are chosen by the hash modulo a prime number, so the same low bits
+            // of the hashes in a shard don't make the collisions more likely
+            return shards_[hash_code & (SHARDS_NUM - 1)];
+        }
+
+        static_assert(helpers::math::IsPowerOfTwo(SHARDS_NUM));
+        std::array<Shard, SHARDS_NUM> shards_;
+        // Created on the first sweep of a large table
+        StringTableSweeper *sweeper_ {nullptr};
+
         NO_COPY_SEMANTIC(Table);
         NO_MOVE_SEMANTIC(Table);
 
@@ -102,10 +189,14 @@ protected:
 
     class InternalTable : public Table {
     public:
-        InternalTable() = default;
+        InternalTable()
+        {
+            record_new_strings_ = false;
+        }
         explicit InternalTable(mem::InternalAllocatorPtr allocator)
             : Table(allocator), new_string_table_(allocator->Adapter())
         {
+            record_new_strings_ = false;
         }
         ~InternalTable() override = default;
 
@@ -123,12 +214,20 @@ protected:
         void VisitRoots(const StringVisitor &visitor,
                         mem::VisitGCRootFlags flags = mem::VisitGCRootFlags::ACCESS_ROOT_ALL);
 
+        void VisitStringIds(const StringIdVisitor &visitor);
+
     protected:
         coretypes::String *InternStringNonMovable(coretypes::String *string, LanguageContext ctx);
 
+        /**
+         * \brief Check that the file is registered in the class linker, so its data outlives the interned strings
+         */
+        bool IsFileRegistered(const panda_file::File &pf);
+
     private:
-        bool record_new_string_ {false};
-        PandaVector<coretypes::String *> new_string_table_ GUARDED_BY(table_lock_) {};
+        bool record_new_string_ GUARDED_BY(new_string_lock_) {false};
+        PandaVector<coretypes::String *> new_string_table_ GUARDED_BY(new_string_lock_) {};
+        os::memory::Mutex new_string_lock_;
         class EntityIdEqual {
         public:
             uint32_t operator()(const panda_file::File::EntityId &id) const
@@ -139,6 +238,7 @@ protected:
         PandaUnorderedMap<const panda_file::File *,
                           PandaUnorderedMap<panda_file::File::EntityId, coretypes::String *, EntityIdEqual>>
             maps_ GUARDED_BY(maps_lock_);
+        PandaUnorderedSet<const panda_file::File *> registered_files_ GUARDED_BY(maps_lock_);
 
         os::memory::RWLock maps_lock_;
 
@@ -14,7 +14,7 @@
 require 'delegate'
 
 def array_type?(type)
-  type[-1] == '['
+  type.end_with?('[]')
 end
 
 def get_object_type(type)
@@ -20,9 +20,12 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <functional>
+#include <string>
 #include <tuple>
 #include <unordered_set>
 
@@ -242,6 +245,19 @@ protected:
     void AllocateFreeDifferentSizesTest(size_t elements_count = MAX_ALLOC_SIZE - MIN_ALLOC_SIZE + 1,
                                         size_t pools_count = 1);
 
+    /**
+     * \brief Check that allocator reuses fragmented memory, the average times of the operations are recorded
+     * as properties of the test
+     * @tparam MIN_ALLOC_SIZE - minimum possible size for one allocation
+     * @tparam MAX_ALLOC_SIZE - maximum possible size for one allocation
+     * @param pools_count - count of pools needed by allocation
+     *
+     * Fill pools with elements of random sizes, free every second element and allocate the freed sizes again
+     * in descending order. Each such allocation must succeed because there is a hole big enough for it.
+     */
+    template <size_t MIN_ALLOC_SIZE, size_t MAX_ALLOC_SIZE>
+    void FragmentationTest(size_t pools_count = 1);
+
     /**
      * \brief Try to allocate too big object, must not allocate memory
      * @tparam MAX_ALLOC_SIZE - maximum possible size for allocation by this allocator
@@ -691,6 +707,67 @@ inline void AllocatorTest<Allocator>::AllocateFreeDifferentSizesTest(size_t elem
     delete mem_stats;
 }
 
+template <class Allocator>
+template <size_t MIN_ALLOC_SIZE, size_t MAX_ALLOC_SIZE>
+inline void AllocatorTest<Allocator>::FragmentationTest(size_t pools_count)
+{
+    mem::MemStatsType *mem_stats = new mem::MemStatsType();
+    Allocator allocator(mem_stats);
+    for (size_t i = 0; i < pools_count; i++) {
+        AddMemoryPoolToAllocator(allocator);
+    }
+    std::vector<std::pair<void *, size_t>> allocated_elements;
+    auto alloc_start = std::chrono::steady_clock::now();
+    while (true) {
+        size_t size = RandFromRange(MIN_ALLOC_SIZE, MAX_ALLOC_SIZE);
+        void *mem = allocator.Alloc(size);
+        if (mem == nullptr) {
+            break;
+        }
+        allocated_elements.emplace_back(mem, size);
+    }
+    auto alloc_time = std::chrono::steady_clock::now() - alloc_start;
+    ASSERT_TRUE(allocated_elements.size() > 1U) << "seed: " << seed_;
+
+    // Make holes between used elements, so that freed blocks can't be coalesced with each other
+    std::sort(allocated_elements.begin(), allocated_elements.end(),
+              [](const auto &lhs, const auto &rhs) { return ToUintPtr(lhs.first) < ToUintPtr(rhs.first); });
+    std::vector<size_t> freed_sizes;
+    auto free_start = std::chrono::steady_clock::now();
+    for (size_t i = 1; i < allocated_elements.size(); i += 2U) {
+        allocator.Free(allocated_elements[i].first);
+        freed_sizes.push_back(allocated_elements[i].second);
+        allocated_elements[i].first = nullptr;
+    }
+    auto free_time = std::chrono::steady_clock::now() - free_start;
+
+    std::sort(freed_sizes.begin(), freed_sizes.end(), std::greater<>());
+    std::vector<void *> reallocated_elements;
+    auto realloc_start = std::chrono::steady_clock::now();
+    for (size_t size : freed_sizes) {
+        void *mem = allocator.Alloc(size);
+        ASSERT_TRUE(mem != nullptr) << "Didn't allocate " << size << " bytes in fragmented memory, seed: " << seed_;
+        reallocated_elements.push_back(mem);
+    }
+    auto realloc_time = std::chrono::steady_clock::now() - realloc_start;
+
+    auto record_time = [](const std::string &name, std::chrono::steady_clock::duration time, size_t count) {
+        auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+        RecordProperty(name + "_ns_per_op", std::to_string(time_ns / static_cast<int64_t>(std::max<size_t>(count, 1))));
+    };
+    record_time("alloc", alloc_time, allocated_elements.size());
+    record_time("free", free_time, freed_sizes.size());
+    record_time("fragmented_alloc", realloc_time, reallocated_elements.size());
+
+    for (auto &element : allocated_elements) {
+        allocator.Free(element.first);
+    }
+    for (void *mem : reallocated_elements) {
+        allocator.Free(mem);
+    }
+    delete mem_stats;
+}
+
 template <class Allocator>
 template <size_t MAX_ALLOC_SIZE>
 inline void AllocatorTest<Allocator>::AllocateTooBigObjectTest()
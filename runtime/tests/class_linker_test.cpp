@@ -16,8 +16,11 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <numeric>
 #include <ostream>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -25,12 +28,16 @@
 #include "assembly-parser.h"
 #include "libpandabase/utils/utf.h"
 #include "libpandafile/modifiers.h"
+#include "runtime/class_preloader.h"
 #include "runtime/include/class-inl.h"
 #include "runtime/include/class_linker-inl.h"
 #include "runtime/include/class_linker.h"
 #include "runtime/include/coretypes/tagged_value.h"
+#include "runtime/include/imtable_builder.h"
+#include "runtime/include/itable.h"
 #include "runtime/include/object_header.h"
 #include "runtime/include/runtime.h"
+#include "runtime/include/thread_scopes.h"
 #include "runtime/core/core_class_linker_extension.h"
 #include "runtime/tests/class_linker_test_extension.h"
 
@@ -179,6 +186,118 @@ TEST_F(ClassLinkerTest, TestEnumerateClasses)
     EXPECT_EQ(loaded_classes, classes);
 }
 
+TEST_F(ClassLinkerTest, ConcurrentFindLoadedClass)
+{
+    static constexpr size_t CLASSES_NUM = 500;
+    static constexpr size_t READERS_NUM = 4;
+
+    std::string source;
+    std::vector<PandaString> descriptors(CLASSES_NUM);
+    for (size_t i = 0; i < CLASSES_NUM; i++) {
+        std::string name = "R" + std::to_string(i);
+        source += ".record " + name + " {}\n";
+        ClassHelper::GetDescriptor(utf::CStringAsMutf8(name.c_str()), &descriptors[i]);
+    }
+
+    pandasm::Parser p;
+    auto res = p.Parse(source);
+    auto pf = pandasm::AsmEmitter::Emit(res.Value());
+
+    auto class_linker = CreateClassLinker(thread_);
+    ASSERT_NE(class_linker, nullptr);
+
+    class_linker->AddPandaFile(std::move(pf));
+
+    auto *ext = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY);
+    auto *context = ext->GetBootContext();
+    size_t num_loaded_classes = context->NumLoadedClasses();
+
+    // Readers look classes up without locks while they are being loaded
+    std::atomic_bool loaded {false};
+    std::atomic_size_t mismatches {0};
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < READERS_NUM; r++) {
+        readers.emplace_back([&]() {
+            do {
+                for (const auto &descriptor : descriptors) {
+                    auto *mutf8_descriptor = utf::CStringAsMutf8(descriptor.c_str());
+                    Class *klass = context->FindClass(mutf8_descriptor);
+                    if (klass != nullptr && !utf::IsEqual(klass->GetDescriptor(), mutf8_descriptor)) {
+                        mismatches++;
+                    }
+                }
+            } while (!loaded.load());
+        });
+    }
+
+    std::vector<Class *> classes;
+    for (const auto &descriptor : descriptors) {
+        classes.push_back(ext->GetClass(utf::CStringAsMutf8(descriptor.c_str())));
+        // Readers must be joined before the test returns, so a failure is only recorded here
+        EXPECT_NE(classes.back(), nullptr);
+    }
+    loaded = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(std::count(classes.begin(), classes.end(), nullptr), 0);
+
+    EXPECT_EQ(mismatches.load(), 0U);
+    EXPECT_EQ(context->NumLoadedClasses(), num_loaded_classes + CLASSES_NUM);
+    for (size_t i = 0; i < CLASSES_NUM; i++) {
+        EXPECT_EQ(context->FindClass(utf::CStringAsMutf8(descriptors[i].c_str())), classes[i]);
+    }
+
+    context->RemoveClass(classes[0]);
+    EXPECT_EQ(context->FindClass(utf::CStringAsMutf8(descriptors[0].c_str())), nullptr);
+    EXPECT_EQ(context->FindClass(utf::CStringAsMutf8(descriptors[1].c_str())), classes[1]);
+    EXPECT_EQ(context->NumLoadedClasses(), num_loaded_classes + CLASSES_NUM - 1);
+    EXPECT_EQ(context->InsertClass(classes[0]), nullptr);
+    EXPECT_EQ(context->FindClass(utf::CStringAsMutf8(descriptors[0].c_str())), classes[0]);
+}
+
+TEST_F(ClassLinkerTest, PreloadClasses)
+{
+    static constexpr size_t CLASSES_NUM = 100;
+    static constexpr size_t THREADS_NUM = 4;
+
+    std::string source;
+    PandaVector<PandaString> descriptors(CLASSES_NUM);
+    for (size_t i = 0; i < CLASSES_NUM; i++) {
+        std::string name = "R" + std::to_string(i);
+        source += ".record " + name + " {}\n";
+        ClassHelper::GetDescriptor(utf::CStringAsMutf8(name.c_str()), &descriptors[i]);
+    }
+
+    pandasm::Parser p;
+    auto res = p.Parse(source);
+    auto pf = pandasm::AsmEmitter::Emit(res.Value());
+
+    auto class_linker = CreateClassLinker(thread_);
+    ASSERT_NE(class_linker, nullptr);
+
+    class_linker->AddPandaFile(std::move(pf));
+
+    auto *ext = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY);
+    auto *context = ext->GetBootContext();
+    PandaVector<PandaString> preload_descriptors(descriptors);
+    preload_descriptors.emplace_back("LUnknownClass;");
+
+    size_t loaded_classes = 0;
+    {
+        ScopedNativeCodeThread s(thread_);
+        ClassPreloader preloader(class_linker.get(), context);
+        loaded_classes = preloader.Preload(preload_descriptors, THREADS_NUM);
+    }
+
+    EXPECT_EQ(loaded_classes, CLASSES_NUM);
+    for (const auto &descriptor : descriptors) {
+        Class *klass = context->FindClass(utf::CStringAsMutf8(descriptor.c_str()));
+        ASSERT_NE(klass, nullptr);
+        EXPECT_FALSE(klass->IsInitialized());
+    }
+}
+
 static void TestPrimitiveClassRoot(const ClassLinkerExtension &class_linker_ext, ClassRoot class_root,
                                    panda_file::Type::TypeId type_id)
 {
@@ -807,4 +926,165 @@ TEST_F(ClassLinkerTest, LoadContext)
     }
 }
 
+// The core language has no interfaces, so interfaces and the itable of a class are created directly. Methods are not
+// backed by a panda file, IMT slots are chosen by their file offsets only.
+static Span<Method> CreateMethods(ClassLinker *class_linker, Class *klass, const std::vector<uint32_t> &offsets,
+                                  uint32_t access_flags)
+{
+    auto allocator = class_linker->GetAllocator();
+    Span<Method> methods(static_cast<Method *>(allocator->Alloc(sizeof(Method) * offsets.size())), offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        new (&methods[i]) Method(klass, nullptr, panda_file::File::EntityId(offsets[i]), panda_file::File::EntityId(),
+                                 access_flags, 1, nullptr);
+    }
+    klass->SetMethods(methods, methods.size(), 0);
+    return methods;
+}
+
+static Class *CreateInterface(ClassLinker *class_linker, const char *name, const std::vector<uint32_t> &offsets)
+{
+    auto *ext = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY);
+    auto *iface =
+        ext->CreateClass(utf::CStringAsMutf8(name), 0, 0, ClassHelper::ComputeClassSize(0, 0, 0, 0, 0, 0, 0, 0));
+    iface->SetAccessFlags(ACC_PUBLIC | ACC_INTERFACE | ACC_ABSTRACT);
+    CreateMethods(class_linker, iface, offsets, ACC_PUBLIC | ACC_ABSTRACT);
+    return iface;
+}
+
+/**
+ * Create a class implementing the interfaces, implementations[i][j] is the index of the method of the class which
+ * implements the method j of the interface i
+ */
+static Class *CreateImplementation(ClassLinker *class_linker, const std::vector<Class *> &ifaces,
+                                   const std::vector<std::vector<size_t>> &implementations, size_t methods_num)
+{
+    auto *ext = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY);
+    auto allocator = class_linker->GetAllocator();
+    size_t ifm_num = 0;
+    for (auto *iface : ifaces) {
+        ifm_num += iface->GetVirtualMethods().size();
+    }
+    size_t imt_size = std::min(ifm_num, Class::IMTABLE_SIZE);
+    auto *klass = ext->CreateClass(utf::CStringAsMutf8("LImplementation;"), 0, imt_size,
+                                   ClassHelper::ComputeClassSize(0, imt_size, 0, 0, 0, 0, 0, 0));
+    klass->SetAccessFlags(ACC_PUBLIC);
+    std::vector<uint32_t> offsets(methods_num);
+    std::iota(offsets.begin(), offsets.end(), 1U);
+    auto methods = CreateMethods(class_linker, klass, offsets, ACC_PUBLIC);
+
+    Span<ITable::Entry> entries(allocator->AllocArray<ITable::Entry>(ifaces.size()), ifaces.size());
+    for (size_t i = 0; i < ifaces.size(); i++) {
+        size_t num = ifaces[i]->GetVirtualMethods().size();
+        Span<Method *> imp_methods(allocator->AllocArray<Method *>(num), num);
+        for (size_t j = 0; j < num; j++) {
+            imp_methods[j] = &methods[implementations[i][j]];
+        }
+        new (&entries[i]) ITable::Entry();
+        entries[i].SetInterface(ifaces[i]);
+        entries[i].SetMethods(imp_methods);
+    }
+    klass->SetITable(ITable(entries));
+    IMTableBuilder builder;
+    builder.UpdateClass(klass);
+    return klass;
+}
+
+static size_t CountIMTConflictSlots(Class *klass)
+{
+    auto imt = klass->GetIMT();
+    return std::count_if(imt.begin(), imt.end(), [](Method *slot) { return Class::IsIMTConflictSlot(slot); });
+}
+
+static void ExpectResolvedInterfaceMethods(Class *klass)
+{
+    auto itable = klass->GetITable();
+    for (size_t i = 0; i < itable.Size(); i++) {
+        auto itf_methods = itable[i].GetInterface()->GetVirtualMethods();
+        for (size_t j = 0; j < itf_methods.size(); j++) {
+            EXPECT_EQ(klass->ResolveVirtualMethod(&itf_methods[j]), itable[i].GetMethods()[j]) << i << " " << j;
+        }
+    }
+}
+
+TEST_F(ClassLinkerTest, IMTSharedSlots)
+{
+    auto class_linker = CreateClassLinker(thread_);
+    ASSERT_NE(class_linker, nullptr);
+
+    // The IMT has 6 slots, each of the first 3 slots is shared by one method of each interface
+    Class *iface0 = CreateInterface(class_linker.get(), "LI0;", {6U, 7U, 8U});
+    Class *iface1 = CreateInterface(class_linker.get(), "LI1;", {12U, 13U, 14U});
+    // The methods of the slot 1 have the same implementation, the methods of the slots 0 and 2 have different ones
+    Class *klass = CreateImplementation(class_linker.get(), {iface0, iface1}, {{0, 1, 2}, {3, 1, 4}}, 5U);
+    ASSERT_EQ(klass->GetIMTSize(), 6U);
+
+    auto imt = klass->GetIMT();
+    auto methods = klass->GetMethods();
+    ASSERT_TRUE(Class::IsIMTConflictSlot(imt[0]));
+    EXPECT_EQ(imt[1], &methods[1]);
+    ASSERT_TRUE(Class::IsIMTConflictSlot(imt[2]));
+    for (size_t i = 3; i < imt.size(); i++) {
+        EXPECT_EQ(imt[i], nullptr);
+    }
+    auto *table = Class::GetIMTConflictTable(imt[0]);
+    EXPECT_EQ(table[0].interface_method, &iface0->GetVirtualMethods()[0]);
+    EXPECT_EQ(table[0].implementation, &methods[0]);
+    EXPECT_EQ(table[1].interface_method, &iface1->GetVirtualMethods()[0]);
+    EXPECT_EQ(table[1].implementation, &methods[3]);
+    EXPECT_EQ(table[2].interface_method, nullptr);
+    ExpectResolvedInterfaceMethods(klass);
+
+    class_linker->FreeClass(klass);
+    class_linker->FreeClass(iface1);
+    class_linker->FreeClass(iface0);
+}
+
+TEST_F(ClassLinkerTest, IMTManyInterfaceMethods)
+{
+    static constexpr size_t METHODS_NUM = 100;
+    auto class_linker = CreateClassLinker(thread_);
+    ASSERT_NE(class_linker, nullptr);
+
+    // Methods of both interfaces fill all slots and share them, each method has its own implementation
+    std::vector<uint32_t> offsets(METHODS_NUM);
+    std::iota(offsets.begin(), offsets.end(), 100U);
+    Class *iface0 = CreateInterface(class_linker.get(), "LI0;", offsets);
+    std::iota(offsets.begin(), offsets.end(), 1000U);
+    Class *iface1 = CreateInterface(class_linker.get(), "LI1;", offsets);
+    std::vector<std::vector<size_t>> implementations(2U, std::vector<size_t>(METHODS_NUM));
+    std::iota(implementations[0].begin(), implementations[0].end(), 0U);
+    std::iota(implementations[1].begin(), implementations[1].end(), METHODS_NUM);
+    Class *klass = CreateImplementation(class_linker.get(), {iface0, iface1}, implementations, 2U * METHODS_NUM);
+
+    ASSERT_EQ(klass->GetIMTSize(), Class::IMTABLE_SIZE);
+    EXPECT_EQ(CountIMTConflictSlots(klass), Class::IMTABLE_SIZE);
+    ExpectResolvedInterfaceMethods(klass);
+
+    class_linker->FreeClass(klass);
+    class_linker->FreeClass(iface1);
+    class_linker->FreeClass(iface0);
+}
+
+// Runtime::Destroy checks that all memory of the internal allocator is freed, so conflict tables which are not freed
+// with the classes fail the test
+TEST_F(ClassLinkerTest, IMTConflictTablesFreedOnUnload)
+{
+    auto class_linker = CreateClassLinker(thread_);
+    ASSERT_NE(class_linker, nullptr);
+
+    Class *iface = CreateInterface(class_linker.get(), "LI0;", {1U, 2U, 3U, 4U});
+    // The IMT of the class implementing both interfaces has 8 slots, the methods of the interfaces share 4 of them
+    Class *iface_copy = CreateInterface(class_linker.get(), "LI1;", {9U, 10U, 11U, 12U});
+    Class *klass = CreateImplementation(class_linker.get(), {iface}, {{0, 1, 2, 3}}, 4U);
+    Class *klass_conflicts =
+        CreateImplementation(class_linker.get(), {iface, iface_copy}, {{0, 1, 2, 3}, {4, 5, 6, 7}}, 8U);
+    EXPECT_EQ(CountIMTConflictSlots(klass), 0U);
+    EXPECT_EQ(CountIMTConflictSlots(klass_conflicts), 4U);
+
+    class_linker->FreeClass(klass_conflicts);
+    class_linker->FreeClass(klass);
+    class_linker->FreeClass(iface_copy);
+    class_linker->FreeClass(iface);
+}
+
 }  // namespace panda::test
@@ -14,15 +14,25 @@
  */
 
 #include <sys/mman.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "libpandabase/mem/mem.h"
 #include "libpandabase/os/mem.h"
 #include "libpandabase/utils/asan_interface.h"
 #include "libpandabase/utils/logger.h"
 #include "libpandabase/utils/math_helpers.h"
+#include "runtime/handle_scope-inl.h"
+#include "runtime/include/class_linker.h"
+#include "runtime/include/coretypes/array-inl.h"
+#include "runtime/include/coretypes/string.h"
+#include "runtime/include/gc_task.h"
+#include "runtime/include/panda_vm.h"
 #include "runtime/include/runtime.h"
 #include "runtime/mem/alloc_config.h"
 #include "runtime/mem/freelist_allocator-inl.h"
+#include "runtime/mem/vm_handle.h"
 #include "runtime/tests/allocator_test_base.h"
 
 namespace panda::mem {
@@ -131,6 +141,14 @@ TEST_F(FreeListAllocatorTest, AllocateRandomFreeTest)
     AllocateFreeDifferentSizesTest<ALLOC_SIZE, 2 * ALLOC_SIZE>(512);
 }
 
+TEST_F(FreeListAllocatorTest, FragmentationTest)
+{
+    static constexpr size_t MIN_ALLOC_SIZE = FREELIST_ALLOCATOR_MIN_SIZE;
+    static constexpr size_t MAX_ALLOC_SIZE = 64_KB;
+    static constexpr size_t POOLS_COUNT = 2;
+    FragmentationTest<MIN_ALLOC_SIZE, MAX_ALLOC_SIZE>(POOLS_COUNT);
+}
+
 TEST_F(FreeListAllocatorTest, AllocateTooBigObjTest)
 {
     AllocateTooBigObjectTest<MAX_ALLOC_SIZE + 1>();
@@ -324,6 +342,60 @@ TEST_F(FreeListAllocatorTest, AllocateTheWholePoolFreeAndAllocateAgainTest)
     delete mem_stats;
 }
 
+TEST_F(FreeListAllocatorTest, CompactionTest)
+{
+    static constexpr size_t alloc_size = 1_KB;
+    // Keep only one of LIVE_ELEMENTS_PERIOD elements to have enough free memory for the max allocation
+    static constexpr size_t LIVE_ELEMENTS_PERIOD = 3;
+    mem::MemStatsType *mem_stats = new mem::MemStatsType();
+    NonObjectFreeListAllocator allocator(mem_stats);
+    AddMemoryPoolToAllocator(allocator);
+    std::vector<void *> memory_elements;
+    while (true) {
+        void *mem = allocator.Alloc(alloc_size);
+        if (mem == nullptr) {
+            break;
+        }
+        memory_elements.push_back(mem);
+    }
+    std::unordered_map<void *, size_t> live_elements;
+    for (size_t i = 0; i < memory_elements.size(); i++) {
+        if (i % LIVE_ELEMENTS_PERIOD == 0) {
+            *static_cast<size_t *>(memory_elements[i]) = i;
+            live_elements.emplace(memory_elements[i], i);
+        } else {
+            allocator.Free(memory_elements[i]);
+        }
+    }
+    ASSERT_GT(allocator.GetFragmentation(), 0.0);
+    ASSERT_EQ(allocator.Alloc(MAX_ALLOC_SIZE), nullptr);
+
+    std::unordered_map<void *, void *> new_addresses;
+    allocator.CalculateCompactedAddresses([&new_addresses](ObjectHeader *object, ObjectHeader *new_address) {
+        ASSERT_LT(ToUintPtr(new_address), ToUintPtr(object));
+        new_addresses.emplace(object, new_address);
+    });
+    ASSERT_FALSE(new_addresses.empty());
+    size_t moved_count = 0;
+    allocator.Compact([&new_addresses, &moved_count]([[maybe_unused]] ObjectHeader *object) {
+        ASSERT_NE(new_addresses.size(), moved_count);
+        moved_count++;
+    });
+    ASSERT_EQ(moved_count, new_addresses.size());
+    ASSERT_EQ(allocator.GetFragmentation(), 0.0);
+
+    for (auto [mem, index] : live_elements) {
+        auto it = new_addresses.find(mem);
+        void *new_mem = it == new_addresses.end() ? mem : it->second;
+        ASSERT_EQ(*static_cast<size_t *>(new_mem), index);
+        ASSERT_TRUE(allocator.IsLive(static_cast<ObjectHeader *>(new_mem)));
+    }
+    void *mem = allocator.Alloc(MAX_ALLOC_SIZE);
+    ASSERT_TRUE(mem != nullptr);
+    allocator.Free(mem);
+    delete mem_stats;
+}
+
 TEST_F(FreeListAllocatorTest, MTAllocFreeTest)
 {
     static constexpr size_t MIN_ELEMENTS_COUNT = 500;
@@ -396,4 +468,117 @@ TEST_F(FreeListAllocatorTest, MTAllocCollectTest)
     }
 }
 
+class FreeListAllocatorGenGCTest : public testing::Test {
+public:
+    FreeListAllocatorGenGCTest()
+    {
+        RuntimeOptions options;
+        options.SetShouldLoadBootPandaFiles(false);
+        options.SetShouldInitializeIntrinsics(false);
+        options.SetUseTlabForAllocations(false);
+        options.SetGcType("gen-gc");
+        options.SetRunGcInPlace(true);
+        // Compact the tenured space on every full GC and verify the whole heap before and after each GC
+        options.SetGcTenuredCompaction(true);
+        options.SetGcTenuredCompactionThreshold(0);
+        options.SetPreGcHeapVerifyEnabled(true);
+        options.SetPostGcHeapVerifyEnabled(true);
+        options.SetFailOnHeapVerification(true);
+        Runtime::Create(options);
+        thread_ = panda::MTManagedThread::GetCurrent();
+        thread_->ManagedCodeBegin();
+    }
+
+    ~FreeListAllocatorGenGCTest() override
+    {
+        thread_->ManagedCodeEnd();
+        Runtime::Destroy();
+    }
+
+protected:
+    static coretypes::String *CreateIndexString(size_t index)
+    {
+        std::string data = std::to_string(index);
+        LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+        return coretypes::String::CreateFromMUtf8(utf::CStringAsMutf8(data.c_str()), data.size(), ctx,
+                                                  Runtime::GetCurrent()->GetPandaVM());
+    }
+
+    static bool IsIndexString(ObjectHeader *object, size_t index)
+    {
+        std::string data = std::to_string(index);
+        return object != nullptr && coretypes::String::StringsAreEqualMUtf8(static_cast<coretypes::String *>(object),
+                                                                            utf::CStringAsMutf8(data.c_str()),
+                                                                            data.size(), true);
+    }
+
+    panda::MTManagedThread *thread_ {nullptr};
+};
+
+TEST_F(FreeListAllocatorGenGCTest, CompactionKeepsHeapValidTest)
+{
+    static constexpr uint32_t ARRAYS_COUNT = 128;
+    // Arrays larger than the young allocations are allocated in the tenured space by FreeListAllocator
+    static constexpr uint32_t LARGE_ARRAY_LENGTH = 2048;
+    LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+    Class *array_class =
+        Runtime::GetCurrent()->GetClassLinker()->GetExtension(ctx)->GetClassRoot(ClassRoot::ARRAY_STRING);
+    PandaVM *vm = thread_->GetVM();
+    auto *object_allocator = vm->GetHeapManager()->GetObjectAllocator().AsObjectAllocator();
+
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<coretypes::Array> holder(thread_, coretypes::Array::Create(array_class, ARRAYS_COUNT));
+    ASSERT_NE(holder.GetPtr(), nullptr);
+    for (uint32_t i = 0; i < ARRAYS_COUNT; i++) {
+        VMHandle<coretypes::String> string(thread_, CreateIndexString(i));
+        auto *array = coretypes::Array::Create(array_class, LARGE_ARRAY_LENGTH);
+        ASSERT_NE(array, nullptr);
+        ASSERT_FALSE(object_allocator->IsAddressInYoungSpace(ToUintPtr(array)));
+        // The string is in the last card of the array, not in the one of its header
+        array->Set<ObjectHeader *>(LARGE_ARRAY_LENGTH - 1U, string.GetPtr());
+        holder->Set<ObjectHeader *>(i, array);
+    }
+    // Dead arrays between the live ones fragment the tenured space
+    std::vector<uintptr_t> old_addresses(ARRAYS_COUNT, 0U);
+    for (uint32_t i = 0; i < ARRAYS_COUNT; i++) {
+        if (i % 2U == 0) {
+            old_addresses[i] = ToUintPtr(holder->Get<ObjectHeader *>(i));
+        } else {
+            holder->Set<ObjectHeader *>(i, nullptr);
+        }
+    }
+    vm->GetGC()->WaitForGCInManaged(GCTask(GCTaskCause::EXPLICIT_CAUSE));
+
+    size_t moved_count = 0;
+    size_t granularity = CrossingMapSingleton::GetCrossingMapGranularity();
+    for (uint32_t i = 0; i < ARRAYS_COUNT; i += 2U) {
+        auto *array = static_cast<coretypes::Array *>(holder->Get<ObjectHeader *>(i));
+        moved_count += ToUintPtr(array) != old_addresses[i] ? 1U : 0U;
+        ASSERT_TRUE(IsIndexString(array->Get<ObjectHeader *>(LARGE_ARRAY_LENGTH - 1U), i));
+        // CrossingMap must point to the array from the range of its header, as card table iteration uses it
+        uintptr_t range_start = AlignDown(ToUintPtr(array), granularity);
+        bool found = false;
+        object_allocator->IterateOverObjectsInRange(MemRange(range_start, range_start + granularity - 1U),
+                                                    [array, &found](ObjectHeader *object) {
+                                                        found = found || object == array;
+                                                    });
+        ASSERT_TRUE(found) << "Moved array " << i << " is not found through CrossingMap";
+    }
+    ASSERT_GT(moved_count, 0U);
+
+    // Young GC finds the references from the moved arrays to the young space through the card table
+    for (uint32_t i = 0; i < ARRAYS_COUNT; i += 2U) {
+        VMHandle<coretypes::String> string(thread_, CreateIndexString(ARRAYS_COUNT + i));
+        auto *array = static_cast<coretypes::Array *>(holder->Get<ObjectHeader *>(i));
+        array->Set<ObjectHeader *>(LARGE_ARRAY_LENGTH - 1U, string.GetPtr());
+    }
+    vm->GetGC()->WaitForGCInManaged(GCTask(GCTaskCause::YOUNG_GC_CAUSE));
+    for (uint32_t i = 0; i < ARRAYS_COUNT; i += 2U) {
+        auto *array = static_cast<coretypes::Array *>(holder->Get<ObjectHeader *>(i));
+        ObjectHeader *string = array->Get<ObjectHeader *>(LARGE_ARRAY_LENGTH - 1U);
+        ASSERT_FALSE(object_allocator->IsAddressInYoungSpace(ToUintPtr(string)));
+        ASSERT_TRUE(IsIndexString(string, ARRAYS_COUNT + i));
+    }
+}
+
 }  // namespace panda::mem
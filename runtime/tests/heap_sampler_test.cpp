@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "runtime/include/coretypes/string.h"
+#include "runtime/include/gc_task.h"
+#include "runtime/include/panda_vm.h"
+#include "runtime/include/runtime.h"
+#include "runtime/handle_base-inl.h"
+#include "runtime/handle_scope-inl.h"
+#include "runtime/mem/heap_manager.h"
+#include "runtime/mem/heap_sampler.h"
+#include "runtime/mem/vm_handle.h"
+
+namespace panda::mem::test {
+
+class HeapSamplerTest : public testing::Test {
+public:
+    static constexpr size_t SAMPLING_INTERVAL = 64;
+    // Exceeds the largest possible sampling interval, so such an allocation is always sampled
+    static constexpr size_t BIG_STRING_LENGTH = 64 * SAMPLING_INTERVAL;
+
+    void SetupRuntime(const std::string &gc_type)
+    {
+        RuntimeOptions options;
+        options.SetShouldLoadBootPandaFiles(false);
+        options.SetShouldInitializeIntrinsics(false);
+        options.SetUseTlabForAllocations(false);
+        options.SetGcType(gc_type);
+        options.SetRunGcInPlace(true);
+        options.SetHeapSamplingInterval(SAMPLING_INTERVAL);
+        options.SetHeapSamplingProfile("heap_sampler_test.pprof");
+        bool success = Runtime::Create(options);
+        ASSERT_TRUE(success) << "Cannot create Runtime";
+        thread_ = panda::MTManagedThread::GetCurrent();
+        thread_->ManagedCodeBegin();
+    }
+
+    void TearDown() override
+    {
+        thread_->ManagedCodeEnd();
+        bool success = Runtime::Destroy();
+        ASSERT_TRUE(success) << "Cannot destroy Runtime";
+    }
+
+    coretypes::String *AllocString(size_t length)
+    {
+        std::string data(length, 'x');
+        LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+        return coretypes::String::CreateFromMUtf8(reinterpret_cast<const uint8_t *>(data.c_str()), data.size(), ctx,
+                                                  thread_->GetVM());
+    }
+
+    HeapSampler *GetHeapSampler()
+    {
+        return thread_->GetVM()->GetHeapManager()->GetHeapSampler();
+    }
+
+    void RunGC()
+    {
+        thread_->GetVM()->GetGC()->WaitForGCInManaged(GCTask(GCTaskCause::EXPLICIT_CAUSE));
+    }
+
+    void DeadSamplesSweepTest();
+    void LiveSamplesSurviveGCTest();
+
+protected:
+    panda::MTManagedThread *thread_ {nullptr};
+};
+
+void HeapSamplerTest::DeadSamplesSweepTest()
+{
+    static constexpr size_t STRINGS_COUNT = 1000;
+    static constexpr size_t STRING_LENGTH = 100;
+    HeapSampler *sampler = GetHeapSampler();
+    ASSERT_NE(sampler, nullptr);
+    size_t live_samples_before = sampler->GetLiveSamplesCount();
+    for (size_t i = 0; i < STRINGS_COUNT; i++) {
+        ASSERT_NE(AllocString(STRING_LENGTH), nullptr);
+    }
+    ASSERT_GT(sampler->GetLiveSamplesCount(), live_samples_before);
+    RunGC();
+    ASSERT_LE(sampler->GetLiveSamplesCount(), live_samples_before);
+}
+
+void HeapSamplerTest::LiveSamplesSurviveGCTest()
+{
+    HeapSampler *sampler = GetHeapSampler();
+    ASSERT_NE(sampler, nullptr);
+    RunGC();
+    size_t live_samples_before = sampler->GetLiveSamplesCount();
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<ObjectHeader> handle(thread_, AllocString(BIG_STRING_LENGTH));
+    ASSERT_EQ(sampler->GetLiveSamplesCount(), live_samples_before + 1);
+    RunGC();
+    ASSERT_EQ(sampler->GetLiveSamplesCount(), live_samples_before + 1);
+
+    std::stringstream profile;
+    sampler->DumpProfile(profile);
+    ASSERT_FALSE(profile.str().empty());
+}
+
+TEST_F(HeapSamplerTest, StwGCDeadSamplesSweep)
+{
+    SetupRuntime("stw");
+    DeadSamplesSweepTest();
+}
+
+TEST_F(HeapSamplerTest, GenGCDeadSamplesSweep)
+{
+    SetupRuntime("gen-gc");
+    DeadSamplesSweepTest();
+}
+
+TEST_F(HeapSamplerTest, StwGCLiveSamplesSurviveGC)
+{
+    SetupRuntime("stw");
+    LiveSamplesSurviveGCTest();
+}
+
+TEST_F(HeapSamplerTest, GenGCLiveSamplesSurviveGC)
+{
+    SetupRuntime("gen-gc");
+    LiveSamplesSurviveGCTest();
+}
+
+}  // namespace panda::mem::test
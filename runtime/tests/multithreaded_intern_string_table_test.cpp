@@ -22,6 +22,8 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <string>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -30,6 +32,7 @@ namespace panda::mem::test {
 
 static constexpr uint32_t TEST_THREADS = 8;
 static constexpr uint32_t TEST_ITERS = 100;
+static constexpr uint32_t TEST_STRINGS = 4096;
 
 class MultithreadedInternStringTableTest : public testing::Test {
 public:
@@ -109,14 +112,7 @@ public:
             ASSERT_EQ(table_->Size(), 1);
             string_ = nullptr;
 
-            {
-                os::memory::WriteLockHolder holder(table_->table_.table_lock_);
-                table_->table_.table_.clear();
-            }
-            {
-                os::memory::WriteLockHolder holder(table_->internal_table_.table_lock_);
-                table_->internal_table_.table_.clear();
-            }
+            ClearInternedStrings();
 
             post_cv_.notify_all();
             counter_post_ = 0;
@@ -125,6 +121,17 @@ public:
         }
     }
 
+    void ClearInternedStrings()
+    {
+        std::array<StringTable::Table *, 2U> tables = {&table_->table_, &table_->internal_table_};
+        for (auto *table : tables) {
+            for (auto &shard : table->shards_) {
+                os::memory::WriteLockHolder holder(shard.lock);
+                shard.table.clear();
+            }
+        }
+    }
+
 protected:
     panda::MTManagedThread *thread_ {nullptr};
 
@@ -169,4 +176,46 @@ TEST_F(MultithreadedInternStringTableTest, CheckInternReturnsSameString)
     }
 }
 
+void InternDistinctStrings(MultithreadedInternStringTableTest *test, uint32_t thread_index,
+                           std::vector<std::atomic<coretypes::String *>> *strings)
+{
+    auto *this_thread =
+        panda::MTManagedThread::Create(panda::Runtime::GetCurrent(), panda::Runtime::GetCurrent()->GetPandaVM());
+    this_thread->ManagedCodeBegin();
+    LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+    auto *table = test->GetTable();
+    // Threads start from different strings, so they intern strings of different shards at the same time
+    for (uint32_t i = 0; i < TEST_STRINGS; i++) {
+        uint32_t index = (i + thread_index * TEST_STRINGS / TEST_THREADS) % TEST_STRINGS;
+        std::string data = "string " + std::to_string(index);
+        auto *interned_str = table->GetOrInternString(utf::CStringAsMutf8(data.c_str()), data.size(), ctx);
+        coretypes::String *expected = nullptr;
+        if (!(*strings)[index].compare_exchange_strong(expected, interned_str)) {
+            ASSERT_EQ(expected, interned_str);
+        }
+    }
+    this_thread->ManagedCodeEnd();
+    this_thread->Destroy();
+}
+
+TEST_F(MultithreadedInternStringTableTest, InternDistinctStringsScaling)
+{
+    for (uint32_t threads_num = 1; threads_num <= TEST_THREADS; threads_num *= 2U) {
+        ClearInternedStrings();
+        std::vector<std::atomic<coretypes::String *>> strings(TEST_STRINGS);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < threads_num; i++) {
+            threads.emplace_back(InternDistinctStrings, this, i, &strings);
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        ASSERT_EQ(table_->Size(), TEST_STRINGS);
+        RecordProperty("intern_us_" + std::to_string(threads_num) + "_threads",
+                       std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    }
+}
+
 }  // namespace panda::mem::test
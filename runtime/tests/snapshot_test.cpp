@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assembly-emitter.h"
+#include "assembly-parser.h"
+#include "libpandabase/utils/utf.h"
+#include "runtime/core/core_class_linker_extension.h"
+#include "runtime/include/class_linker.h"
+#include "runtime/include/runtime.h"
+#include "runtime/include/thread_scopes.h"
+#include "runtime/snapshot.h"
+#include "runtime/string_table.h"
+
+namespace panda::test {
+
+class SnapshotTest : public testing::Test {
+public:
+    SnapshotTest()
+    {
+        RuntimeOptions options;
+        options.SetShouldLoadBootPandaFiles(false);
+        options.SetShouldInitializeIntrinsics(false);
+        options.SetGcType("epsilon");
+        options.SetHeapSizeLimit(64_MB);
+        Runtime::Create(options);
+        thread_ = panda::MTManagedThread::GetCurrent();
+        thread_->ManagedCodeBegin();
+    }
+
+    ~SnapshotTest() override
+    {
+        std::remove(SNAPSHOT_FILE);
+        thread_->ManagedCodeEnd();
+        Runtime::Destroy();
+    }
+
+protected:
+    static constexpr const char *SNAPSHOT_FILE = "snapshot_test.snp";
+    static constexpr size_t CLASSES_NUM = 16;
+    static constexpr const char *STRING = "snapshot string";
+
+    static std::unique_ptr<const panda_file::File> EmitPandaFile(uint32_t *string_id)
+    {
+        std::string source;
+        for (size_t i = 0; i < CLASSES_NUM; i++) {
+            source += ".record R" + std::to_string(i) + " {}\n";
+        }
+        source += ".function void main() {\n    lda.str \"" + std::string(STRING) + "\"\n    return.void\n}\n";
+
+        pandasm::Parser p;
+        auto res = p.Parse(source);
+        pandasm::AsmEmitter::PandaFileToPandaAsmMaps maps;
+        auto pf = pandasm::AsmEmitter::Emit(res.Value(), &maps);
+        for (const auto &[id, str] : maps.strings) {
+            if (str == STRING) {
+                *string_id = id;
+            }
+        }
+        return pf;
+    }
+
+    std::unique_ptr<ClassLinker> CreateClassLinker()
+    {
+        std::vector<std::unique_ptr<ClassLinkerExtension>> extensions;
+        extensions.push_back(std::make_unique<CoreClassLinkerExtension>());
+
+        auto allocator = thread_->GetVM()->GetHeapManager()->GetInternalAllocator();
+        auto class_linker = std::make_unique<ClassLinker>(allocator, std::move(extensions));
+        if (!class_linker->Initialize()) {
+            return nullptr;
+        }
+        return class_linker;
+    }
+
+    panda::MTManagedThread *thread_ {nullptr};
+};
+
+TEST_F(SnapshotTest, WriteAndRead)
+{
+    LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+    size_t pages_count = 0;
+    {
+        uint32_t string_id = 0;
+        auto pf = EmitPandaFile(&string_id);
+        const panda_file::File *pf_ptr = pf.get();
+        auto class_linker = CreateClassLinker();
+        ASSERT_NE(class_linker, nullptr);
+        class_linker->AddPandaFile(std::move(pf));
+        auto *context = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY)->GetBootContext();
+
+        for (size_t i = 0; i < CLASSES_NUM; i++) {
+            std::string descriptor = "LR" + std::to_string(i) + ";";
+            ASSERT_NE(class_linker->GetClass(utf::CStringAsMutf8(descriptor.c_str()), true, context), nullptr);
+        }
+        StringTable table;
+        ASSERT_NE(table.GetOrInternInternalString(*pf_ptr, panda_file::File::EntityId(string_id), ctx), nullptr);
+
+        RuntimeSnapshot snapshot;
+        snapshot.AddClasses(context);
+        snapshot.AddInternalStrings(&table);
+        snapshot.AddResidentPages(class_linker.get());
+        ASSERT_EQ(snapshot.GetClassesCount(), CLASSES_NUM);
+        ASSERT_EQ(snapshot.GetStringsCount(), 1U);
+#ifdef PANDA_TARGET_UNIX
+        // The header of the file is read at least
+        ASSERT_GT(snapshot.GetPagesCount(), 0U);
+#endif
+        pages_count = snapshot.GetPagesCount();
+        ASSERT_TRUE(snapshot.Write(SNAPSHOT_FILE));
+    }
+
+    // The same panda file in a fresh class linker, as on the next run
+    uint32_t string_id = 0;
+    auto class_linker = CreateClassLinker();
+    ASSERT_NE(class_linker, nullptr);
+    class_linker->AddPandaFile(EmitPandaFile(&string_id));
+    auto *context = class_linker->GetExtension(panda_file::SourceLang::PANDA_ASSEMBLY)->GetBootContext();
+
+    RuntimeSnapshot snapshot;
+    ASSERT_TRUE(snapshot.Read(SNAPSHOT_FILE, class_linker.get()));
+    EXPECT_EQ(snapshot.GetClassesCount(), CLASSES_NUM);
+    EXPECT_EQ(snapshot.GetStringsCount(), 1U);
+    EXPECT_EQ(snapshot.GetPagesCount(), pages_count);
+    snapshot.PrefetchPages();
+
+    StringTable table;
+    EXPECT_EQ(snapshot.InternStrings(&table, ctx), 1U);
+    EXPECT_EQ(table.Size(), 1U);
+
+    size_t loaded_classes = 0;
+    {
+        ScopedNativeCodeThread s(thread_);
+        loaded_classes = snapshot.PreloadClasses(class_linker.get(), context, 2);
+    }
+    EXPECT_EQ(loaded_classes, CLASSES_NUM);
+    for (size_t i = 0; i < CLASSES_NUM; i++) {
+        std::string descriptor = "LR" + std::to_string(i) + ";";
+        EXPECT_NE(context->FindClass(utf::CStringAsMutf8(descriptor.c_str())), nullptr);
+    }
+}
+
+TEST_F(SnapshotTest, ReadInvalidFile)
+{
+    auto class_linker = CreateClassLinker();
+    ASSERT_NE(class_linker, nullptr);
+
+    RuntimeSnapshot snapshot;
+    EXPECT_FALSE(snapshot.Read(SNAPSHOT_FILE, class_linker.get()));
+
+    {
+        std::ofstream out(SNAPSHOT_FILE, std::ios::binary | std::ios::trunc);
+        out << "PANDASNP but not a snapshot";
+    }
+    EXPECT_FALSE(snapshot.Read(SNAPSHOT_FILE, class_linker.get()));
+    EXPECT_EQ(snapshot.GetClassesCount(), 0U);
+    EXPECT_EQ(snapshot.GetStringsCount(), 0U);
+}
+
+}  // namespace panda::test
@@ -13,6 +13,10 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <string>
+#include <unordered_set>
+
 #include "gtest/gtest.h"
 #include "runtime/include/coretypes/string.h"
 #include "runtime/include/runtime.h"
@@ -25,15 +29,7 @@ namespace panda::mem::test {
 
 class StringTableTest : public testing::Test {
 public:
-    StringTableTest()
-    {
-        RuntimeOptions options;
-        options.SetShouldLoadBootPandaFiles(false);
-        options.SetShouldInitializeIntrinsics(false);
-
-        options.SetCompilerEnableJit(false);
-        Runtime::Create(options);
-    }
+    StringTableTest() : StringTableTest(nullptr) {}
 
     ~StringTableTest() override
     {
@@ -59,9 +55,28 @@ public:
     }
 
 protected:
+    explicit StringTableTest(const char *gc_type)
+    {
+        RuntimeOptions options;
+        options.SetShouldLoadBootPandaFiles(false);
+        options.SetShouldInitializeIntrinsics(false);
+        if (gc_type != nullptr) {
+            options.SetGcType(gc_type);
+        }
+
+        options.SetCompilerEnableJit(false);
+        Runtime::Create(options);
+    }
+
     panda::MTManagedThread *thread_ {nullptr};
 };
 
+// Strings of a local table aren't roots, so GC must not free them while the test runs
+class StringTableNoGCTest : public StringTableTest {
+public:
+    StringTableNoGCTest() : StringTableTest("epsilon") {}
+};
+
 TEST_F(StringTableTest, EmptyTable)
 {
     auto table = StringTable();
@@ -156,4 +171,80 @@ TEST_F(StringTableTest, SweepObjectInTable)
     ASSERT_GE(table->Size(), table_init_size + 2);
 }
 
+TEST_F(StringTableTest, SweepNewStrings)
+{
+    static constexpr size_t OLD_STRINGS = 20;
+    static constexpr size_t NEW_STRINGS = 10;
+    auto table = StringTable();
+    LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+    std::vector<uint8_t> data {'o', 'l', 'd', 'a', 0x00};
+    for (size_t i = 0; i < OLD_STRINGS; i++) {
+        data[3U] = 'a' + i;
+        table.GetOrInternString(data.data(), utf::MUtf8ToUtf16Size(data.data()), ctx);
+    }
+    size_t visited = 0;
+    auto keep_all = [&visited](ObjectHeader *) {
+        visited++;
+        return ObjectStatus::ALIVE_OBJECT;
+    };
+    table.SweepNew(keep_all);
+    ASSERT_EQ(visited, OLD_STRINGS);
+
+    // Only the strings interned after the previous sweep are visited
+    std::unordered_set<ObjectHeader *> new_strings;
+    data = {'n', 'e', 'w', 'a', 0x00};
+    for (size_t i = 0; i < NEW_STRINGS; i++) {
+        data[3U] = 'a' + i;
+        new_strings.insert(table.GetOrInternString(data.data(), utf::MUtf8ToUtf16Size(data.data()), ctx));
+    }
+    visited = 0;
+    table.SweepNew([&visited, &new_strings](ObjectHeader *object) {
+        visited++;
+        EXPECT_NE(new_strings.count(object), 0U);
+        return ObjectStatus::DEAD_OBJECT;
+    });
+    ASSERT_EQ(visited, NEW_STRINGS);
+    ASSERT_EQ(table.Size(), OLD_STRINGS);
+
+    visited = 0;
+    table.SweepNew(keep_all);
+    ASSERT_EQ(visited, 0U);
+    table.Sweep(keep_all);
+    ASSERT_EQ(visited, OLD_STRINGS);
+}
+
+TEST_F(StringTableNoGCTest, SweepLargeTableInParallel)
+{
+    // Large enough to be swept by the GC thread together with the sweep workers
+    static constexpr size_t STRINGS = 1U << 17U;
+    auto table = StringTable();
+    LanguageContext ctx = Runtime::GetCurrent()->GetLanguageContext(panda_file::SourceLang::PANDA_ASSEMBLY);
+    std::unordered_set<ObjectHeader *> dead_strings;
+    for (size_t i = 0; i < STRINGS; i++) {
+        std::string data = "string" + std::to_string(i);
+        auto *string = table.GetOrInternString(utf::CStringAsMutf8(data.c_str()), data.size(), ctx);
+        if (i % 2U == 0) {
+            dead_strings.insert(string);
+        }
+    }
+    ASSERT_EQ(table.Size(), STRINGS);
+
+    std::atomic<size_t> visited {0};
+    table.Sweep([&visited, &dead_strings](ObjectHeader *object) {
+        visited++;
+        return dead_strings.count(object) != 0 ? ObjectStatus::DEAD_OBJECT : ObjectStatus::ALIVE_OBJECT;
+    });
+    ASSERT_EQ(visited, STRINGS);
+    ASSERT_EQ(table.Size(), STRINGS - dead_strings.size());
+
+    // The workers are reused by the next sweep
+    visited = 0;
+    table.Sweep([&visited, &dead_strings](ObjectHeader *object) {
+        visited++;
+        EXPECT_EQ(dead_strings.count(object), 0U);
+        return ObjectStatus::ALIVE_OBJECT;
+    });
+    ASSERT_EQ(visited, STRINGS - dead_strings.size());
+}
+
 }  // namespace panda::mem::test
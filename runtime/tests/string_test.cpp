@@ -13,7 +13,11 @@
  * limitations under the License.
  */
 
+#include <array>
+#include <atomic>
 #include <ctime>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "libpandabase/utils/span.h"
@@ -22,8 +26,11 @@
 #include "runtime/include/class_linker_extension.h"
 #include "runtime/include/coretypes/array-inl.h"
 #include "runtime/include/coretypes/string-inl.h"
+#include "runtime/include/gc_task.h"
+#include "runtime/include/panda_vm.h"
 #include "runtime/include/runtime.h"
 #include "runtime/include/thread.h"
+#include "runtime/handle_base-inl.h"
 
 namespace panda::coretypes::test {
 
@@ -106,6 +113,24 @@ TEST_F(StringTest, NotEqualStringWithNotCompressedRawUtf8Data)
     ASSERT_FALSE(String::StringsAreEqualMUtf8(first_string, data2.data(), utf16_length));
 }
 
+// Runs of one-byte characters and multi-byte characters are compared without converting the data
+TEST_F(StringTest, CompareNotCompressedStringWithMixedRawUtf8Data)
+{
+    std::vector<uint8_t> data(20U, 'a');
+    data.insert(data.end(), {0xc2, 0xa7, 'b', 0xe4, 0xbd, 0xa0, 0xf0, 0x9f, 0x98, 0x80, 'c', 0});
+    auto utf16_length = static_cast<uint32_t>(utf::MUtf8ToUtf16Size(data.data()));
+    auto *string =
+        String::CreateFromMUtf8(data.data(), utf16_length, GetLanguageContext(), Runtime::GetCurrent()->GetPandaVM());
+    ASSERT_TRUE(string->IsUtf16());
+    ASSERT_TRUE(String::StringsAreEqualMUtf8(string, data.data(), utf16_length));
+    // Change a character in the run, the last byte of each multi-byte character and the last character
+    for (size_t pos : {7U, 21U, 25U, 29U, 30U}) {
+        std::vector<uint8_t> other = data;
+        other[pos]++;
+        ASSERT_FALSE(String::StringsAreEqualMUtf8(string, other.data(), utf16_length)) << pos;
+    }
+}
+
 TEST_F(StringTest, NotEqualStringNotCompressedStringWithCompressedRawData)
 {
     std::vector<uint8_t> data1 {0xc2, 0xa7, 0x33, 0x00};
@@ -211,6 +236,27 @@ TEST_F(StringTest, notCompressedHashCodeUtf8)
     ASSERT_EQ(string_hash_code, raw_hash_code);
 }
 
+TEST_F(StringTest, notCompressedHashCodeMutf8MatchesUtf16)
+{
+    // Long ASCII runs between 2-byte, 3-byte and 4-byte (surrogate pair) sequences and encoded U+0000
+    std::vector<uint8_t> piece {0xc2, 0xa7, 0xe4, 0xbd, 0xa0, 0xf0, 0x9f, 0x98, 0x80, 0xc0, 0x80};
+    std::vector<uint16_t> piece_utf16 {0xa7, 0x4f60, 0xd83d, 0xde00, 0x0};
+    std::vector<uint8_t> data;
+    std::vector<uint16_t> utf16_data;
+    for (size_t i = 0; i < 10; i++) {
+        for (size_t j = 0; j < i * 3; j++) {
+            data.push_back('a' + j % 26);
+            utf16_data.push_back('a' + j % 26);
+        }
+        data.insert(data.end(), piece.begin(), piece.end());
+        utf16_data.insert(utf16_data.end(), piece_utf16.begin(), piece_utf16.end());
+    }
+    data.push_back(0);
+
+    auto raw_hash_code = String::ComputeHashcodeMutf8(data.data(), utf16_data.size());
+    ASSERT_EQ(raw_hash_code, String::ComputeHashcodeUtf16(utf16_data.data(), utf16_data.size()));
+}
+
 TEST_F(StringTest, compressedHashCodeUtf16)
 {
     std::vector<uint16_t> data;
@@ -634,6 +680,207 @@ TEST_F(StringTest, ConcatTest)
     ASSERT_EQ(string61->Compare(string60), 0);
 }
 
+TEST_F(StringTest, ConcatRopes)
+{
+    auto ctx = GetLanguageContext();
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    std::vector<uint8_t> data1 {'r', 'o', 'p', 'e', ' ', 0};
+    std::vector<uint16_t> data2 {'s', 't', 0xab, 'r', 0x4f60, 0};
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<String> piece1(thread_, String::CreateFromMUtf8(data1.data(), data1.size() - 1, ctx, vm));
+    VMHandle<String> piece2(thread_, String::CreateFromUtf16(data2.data(), data2.size() - 1, ctx, vm));
+
+    // Appending makes ropes deeper than the limit, so parts of them are flattened
+    VMHandle<String> str(thread_, String::CreateEmptyString(ctx, vm));
+    std::vector<uint16_t> expected;
+    for (size_t i = 0; i < 3U * String::MAX_ROPE_DEPTH; i++) {
+        bool is_mutf8 = i % 3U != 0;
+        String *piece = is_mutf8 ? piece1.GetPtr() : piece2.GetPtr();
+        str = VMHandle<String>(thread_, String::Concat(str.GetPtr(), piece, ctx, vm));
+        if (is_mutf8) {
+            expected.insert(expected.end(), data1.begin(), data1.end() - 1);
+        } else {
+            expected.insert(expected.end(), data2.begin(), data2.end() - 1);
+        }
+        ASSERT_EQ(str->GetLength(), expected.size());
+        ASSERT_TRUE(str->IsUtf16());
+    }
+    ASSERT_TRUE(str->IsRope());
+    ASSERT_LE(str->GetRopeDepth(), String::MAX_ROPE_DEPTH + 1U);
+
+    // Hashing doesn't flatten the rope
+    ASSERT_EQ(str->GetHashcode(), String::ComputeHashcodeUtf16(expected.data(), expected.size()));
+    ASSERT_FALSE(str->IsFlattenedBy(str->GetRopeLeft()));
+
+    ASSERT_EQ(str->At(1), expected[1]);
+    ASSERT_TRUE(str->IsFlattenedBy(str->GetRopeLeft()));
+    ASSERT_NE(str->GetRopeRight(), nullptr);
+    String *flat = String::Flatten(str.GetPtr());
+    ASSERT_FALSE(flat->IsRope());
+    ASSERT_EQ(String::Flatten(str.GetPtr()), flat);
+    ASSERT_EQ(flat->GetHashcode(), str->GetHashcode());
+    ASSERT_TRUE(String::StringsAreEqualUtf16(str.GetPtr(), expected.data(), expected.size()));
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(str->At(static_cast<int32_t>(i)), expected[i]);
+    }
+    std::vector<uint16_t> copy(expected.size());
+    ASSERT_EQ(str->CopyDataUtf16(copy.data(), copy.size()), expected.size());
+    ASSERT_EQ(copy, expected);
+}
+
+// Ropes don't allocate characters, so doubling a string quickly reaches the maximum length
+TEST_F(StringTest, ConcatExceedsMaxLength)
+{
+    auto ctx = GetLanguageContext();
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    std::vector<uint8_t> data(String::MIN_ROPE_LENGTH, 'a');
+    data.push_back(0);
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<String> str(thread_, String::CreateFromMUtf8(data.data(), data.size() - 1, ctx, vm));
+    uint32_t length = str->GetLength();
+    while (length <= String::MAX_LENGTH - length) {
+        str = VMHandle<String>(thread_, String::Concat(str.GetPtr(), str.GetPtr(), ctx, vm));
+        ASSERT_NE(str.GetPtr(), nullptr);
+        length *= 2U;
+        ASSERT_EQ(str->GetLength(), length);
+    }
+    ASSERT_EQ(String::Concat(str.GetPtr(), str.GetPtr(), ctx, vm), nullptr);
+    thread_->ClearException();
+    ASSERT_EQ(str->GetLength(), length);
+}
+
+// Threads hash, copy and flatten the same rope at the same time, all of them see its characters
+TEST_F(StringTest, ConcurrentRopeFlatten)
+{
+    static constexpr size_t ROUNDS = 20;
+    static constexpr size_t THREADS_NUM = 6;
+    static constexpr size_t PIECES_NUM = 40;
+    auto ctx = GetLanguageContext();
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    std::vector<uint16_t> piece1 {'p', 'i', 'e', 'c', 'e', ' ', 'o', 'n', 'e'};
+    std::vector<uint16_t> piece2 {0x3b1, 0x3b2, 0x3b3};
+    std::vector<uint16_t> expected;
+    for (size_t i = 0; i < PIECES_NUM; i++) {
+        const auto &piece = i % 2U == 0 ? piece1 : piece2;
+        expected.insert(expected.end(), piece.begin(), piece.end());
+    }
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    uint32_t expected_hash = String::CreateFromUtf16(expected.data(), expected.size(), ctx, vm)->GetHashcode();
+
+    std::atomic_size_t mismatches {0};
+    for (size_t round = 0; round < ROUNDS; round++) {
+        VMHandle<String> rope(thread_, String::CreateEmptyString(ctx, vm));
+        for (size_t i = 0; i < PIECES_NUM; i++) {
+            const auto &piece = i % 2U == 0 ? piece1 : piece2;
+            String *str = String::CreateFromUtf16(piece.data(), piece.size(), ctx, vm);
+            rope = VMHandle<String>(thread_, String::Concat(rope.GetPtr(), str, ctx, vm));
+        }
+        ASSERT_TRUE(rope->IsRope());
+
+        std::atomic_size_t started {0};
+        auto worker = [&](size_t index) {
+            auto *thread = MTManagedThread::Create(Runtime::GetCurrent(), vm);
+            // Threads wait for each other in native code, so they don't block GC
+            started++;
+            while (started.load() != THREADS_NUM) {
+            }
+            thread->ManagedCodeBegin();
+            {
+                [[maybe_unused]] HandleScope<ObjectHeader *> worker_scope(thread);
+                VMHandle<String> str(thread, rope.GetPtr());
+                // The hash of a rope is computed from its parts and is not cached before this call
+                if (index % 3U == 0 && str->GetHashcode() != expected_hash) {
+                    mismatches++;
+                }
+                if (index % 3U == 1) {
+                    std::vector<uint16_t> copy(expected.size());
+                    if (str->CopyDataUtf16(copy.data(), copy.size()) != expected.size() || copy != expected) {
+                        mismatches++;
+                    }
+                }
+                if (index % 3U == 2U && !String::StringsAreEqualUtf16(String::Flatten(str.GetPtr()),
+                                                                      expected.data(), expected.size())) {
+                    mismatches++;
+                }
+            }
+            thread->ManagedCodeEnd();
+            thread->Destroy();
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREADS_NUM; i++) {
+            threads.emplace_back(worker, i);
+        }
+        // Flattening allocates, so GC may be triggered while this thread waits for the workers
+        thread_->ManagedCodeEnd();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        thread_->ManagedCodeBegin();
+        EXPECT_TRUE(rope->IsFlattenedBy(rope->GetRopeLeft()));
+    }
+    EXPECT_EQ(mismatches.load(), 0U);
+}
+
+TEST_F(StringTest, RopePartsSurviveGC)
+{
+    auto ctx = GetLanguageContext();
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    std::vector<uint8_t> data1 {'l', 'e', 'f', 't', ' ', 'p', 'a', 'r', 't', 0};
+    std::vector<uint8_t> data2 {'r', 'i', 'g', 'h', 't', ' ', 'p', 'a', 'r', 't', 0};
+    std::vector<uint8_t> data3 {'l', 'e', 'f', 't', ' ', 'p', 'a', 'r', 't', 'r', 'i', 'g', 'h', 't', ' ', 'p', 'a',
+                                'r', 't', 0};
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<String> rope(thread_, String::Concat(String::CreateFromMUtf8(data1.data(), data1.size() - 1, ctx, vm),
+                                                  String::CreateFromMUtf8(data2.data(), data2.size() - 1, ctx, vm),
+                                                  ctx, vm));
+    ASSERT_TRUE(rope->IsRope());
+    ASSERT_FALSE(rope->IsUtf16());
+
+    // Only the rope refers to its parts
+    vm->GetGC()->WaitForGCInManaged(GCTask(GCTaskCause::EXPLICIT_CAUSE));
+    ASSERT_TRUE(String::StringsAreEqualMUtf8(rope.GetPtr(), data3.data(), data3.size() - 1));
+    VMHandle<String> flat(thread_, String::CreateFromMUtf8(data3.data(), data3.size() - 1, ctx, vm));
+    ASSERT_EQ(rope->Compare(flat.GetPtr()), 0);
+    ASSERT_EQ(flat->Compare(rope.GetPtr()), 0);
+}
+
+TEST_F(StringTest, ExternalString)
+{
+    auto ctx = GetLanguageContext();
+    auto *vm = Runtime::GetCurrent()->GetPandaVM();
+    static constexpr std::array<uint8_t, 21> DATA {'e', 'x', 't', 'e', 'r', 'n', 'a', 'l', ' ', 's', 't',
+                                                   'r', 'i', 'n', 'g', ' ', 'd', 'a', 't', 'a', 0};
+    uint32_t length = DATA.size() - 1;
+    [[maybe_unused]] HandleScope<ObjectHeader *> scope(thread_);
+    VMHandle<String> str(thread_, String::CreateFromExternalMUtf8(DATA.data(), length, true, ctx, vm));
+    VMHandle<String> copy(thread_, String::CreateFromMUtf8(DATA.data(), length, ctx, vm));
+    ASSERT_EQ(str->IsExternal(), String::GetCompressedStringsEnabled());
+    if (!str->IsExternal()) {
+        return;
+    }
+    ASSERT_EQ(str->GetDataMUtf8(), DATA.data());
+    ASSERT_EQ(str->GetLength(), length);
+    ASSERT_FALSE(str->IsUtf16());
+    ASSERT_EQ(str->ObjectSize(), String::ComputeSizeExternal());
+    ASSERT_EQ(str->GetHashcode(), copy->GetHashcode());
+    ASSERT_TRUE(String::StringsAreEqual(str.GetPtr(), copy.GetPtr()));
+    ASSERT_EQ(str->Compare(copy.GetPtr()), 0);
+    ASSERT_EQ(str->At(3), 'e');
+
+    // Copies and substrings have their own data
+    String *str_copy = String::CreateFromString(str.GetPtr(), ctx, vm);
+    ASSERT_FALSE(str_copy->IsExternal());
+    ASSERT_TRUE(String::StringsAreEqual(str_copy, copy.GetPtr()));
+    String *sub = String::FastSubString(str.GetPtr(), 9, 6, ctx, vm);
+    ASSERT_FALSE(sub->IsExternal());
+    ASSERT_TRUE(String::StringsAreEqualMUtf8(sub, DATA.data() + 9, 6));
+
+    // Short and non-compressible strings are copied
+    ASSERT_FALSE(String::CreateFromExternalMUtf8(DATA.data(), 4, true, ctx, vm)->IsExternal());
+    std::vector<uint8_t> utf16_data {0xc2, 0xa7, 0xc2, 0xa7, 0xc2, 0xa7, 0xc2, 0xa7, 0xc2, 0xa7, 0xc2, 0xa7, 0};
+    ASSERT_FALSE(String::CreateFromExternalMUtf8(utf16_data.data(), 6, false, ctx, vm)->IsExternal());
+}
+
 TEST_F(StringTest, DoReplaceTest0)
 {
     static constexpr uint32_t string_length = 10;
@@ -69,4 +69,14 @@ bool MethodInfo::Proto::IsEqualBySignatureAndReturnType(const Proto &other) cons
     return true;
 }
 
+uint32_t MethodInfo::Proto::GetShortyHash() const
+{
+    size_t num_args = pda_.GetNumArgs();
+    size_t hash = merge_hashes(num_args, static_cast<size_t>(pda_.GetReturnType().GetId()));
+    for (size_t i = 0; i < num_args; i++) {
+        hash = merge_hashes(hash, static_cast<size_t>(pda_.GetArgType(i).GetId()));
+    }
+    return static_cast<uint32_t>(hash);
+}
+
 }  // namespace panda